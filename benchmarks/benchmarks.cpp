@@ -0,0 +1,611 @@
+#include <QtTest>
+#include "formatutils.h"
+#include "modbusmessages.h"
+#include "modbuslogbuffer.h"
+#include "modbuspcapwriter.h"
+#include "modbustrafficjournal.h"
+#include "modbustrafficfilter.h"
+#include "modbusmultiserver.h"
+#include "waveformutils.h"
+
+///
+/// \brief The Benchmarks class
+///
+class Benchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void dataUnitMap_setData_data();
+    void dataUnitMap_setData();
+    void dataUnitMap_getData_data();
+    void dataUnitMap_getData();
+
+    void multiServer_writeRegister_data();
+    void multiServer_writeRegister();
+    void multiServer_writeRegisters_data();
+    void multiServer_writeRegisters();
+
+    void modbusMessage_create_data();
+    void modbusMessage_create();
+
+    void aduRtu_calculateCRC_data();
+    void aduRtu_calculateCRC();
+
+    void formatValue_data();
+    void formatValue();
+
+    void waveform_generate_data();
+    void waveform_generate();
+
+    void randomGenerator_fill_data();
+    void randomGenerator_fill();
+
+    void logBuffer_append_data();
+    void logBuffer_append();
+
+    void pcapWriter_append_data();
+    void pcapWriter_append();
+
+    void trafficJournal_append();
+    void trafficJournal_query();
+
+    void trafficFilter_accept_data();
+    void trafficFilter_accept();
+
+private:
+    void addLengthRows();
+    void addDisplayModeRows();
+};
+
+///
+/// \brief Benchmarks::addLengthRows
+///
+void Benchmarks::addLengthRows()
+{
+    QTest::addColumn<int>("length");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("125") << 125;
+    QTest::newRow("2000") << 2000;
+    QTest::newRow("65535") << 65535;
+}
+
+///
+/// \brief Benchmarks::addDisplayModeRows
+///
+void Benchmarks::addDisplayModeRows()
+{
+    QTest::addColumn<DataDisplayMode>("mode");
+
+    QTest::newRow("Binary") << DataDisplayMode::Binary;
+    QTest::newRow("Decimal") << DataDisplayMode::Decimal;
+    QTest::newRow("Integer") << DataDisplayMode::Integer;
+    QTest::newRow("Hex") << DataDisplayMode::Hex;
+    QTest::newRow("FloatingPt") << DataDisplayMode::FloatingPt;
+    QTest::newRow("SwappedFP") << DataDisplayMode::SwappedFP;
+    QTest::newRow("DblFloat") << DataDisplayMode::DblFloat;
+    QTest::newRow("SwappedDbl") << DataDisplayMode::SwappedDbl;
+    QTest::newRow("Int32") << DataDisplayMode::Int32;
+    QTest::newRow("SwappedInt32") << DataDisplayMode::SwappedInt32;
+    QTest::newRow("UInt32") << DataDisplayMode::UInt32;
+    QTest::newRow("SwappedUInt32") << DataDisplayMode::SwappedUInt32;
+    QTest::newRow("Int64") << DataDisplayMode::Int64;
+    QTest::newRow("SwappedInt64") << DataDisplayMode::SwappedInt64;
+    QTest::newRow("UInt64") << DataDisplayMode::UInt64;
+    QTest::newRow("SwappedUInt64") << DataDisplayMode::SwappedUInt64;
+}
+
+///
+/// \brief Benchmarks::dataUnitMap_setData_data
+///
+void Benchmarks::dataUnitMap_setData_data()
+{
+    addLengthRows();
+}
+
+///
+/// \brief Benchmarks::dataUnitMap_setData
+///
+void Benchmarks::dataUnitMap_setData()
+{
+    QFETCH(int, length);
+
+    ModbusDataUnitMap unitMap;
+    unitMap.addUnitMap(1, QModbusDataUnit::HoldingRegisters, 0, length);
+
+    const QModbusDataUnit data(QModbusDataUnit::HoldingRegisters, 0, QVector<quint16>(length, 0x1234));
+    QBENCHMARK {
+        unitMap.setData(data);
+    }
+}
+
+///
+/// \brief Benchmarks::dataUnitMap_getData_data
+///
+void Benchmarks::dataUnitMap_getData_data()
+{
+    addLengthRows();
+}
+
+///
+/// \brief Benchmarks::dataUnitMap_getData
+///
+void Benchmarks::dataUnitMap_getData()
+{
+    QFETCH(int, length);
+
+    ModbusDataUnitMap unitMap;
+    unitMap.addUnitMap(1, QModbusDataUnit::HoldingRegisters, 0, length);
+    unitMap.setData(QModbusDataUnit(QModbusDataUnit::HoldingRegisters, 0, QVector<quint16>(length, 0x1234)));
+
+    QBENCHMARK {
+        const auto data = unitMap.getData(QModbusDataUnit::HoldingRegisters, 0, length);
+        Q_UNUSED(data)
+    }
+}
+
+///
+/// \brief Benchmarks::multiServer_writeRegister_data
+///
+void Benchmarks::multiServer_writeRegister_data()
+{
+    addDisplayModeRows();
+}
+
+///
+/// \brief Benchmarks::multiServer_writeRegister
+///
+void Benchmarks::multiServer_writeRegister()
+{
+    QFETCH(DataDisplayMode, mode);
+
+    ModbusMultiServer server;
+    server.addUnitMap(1, 1, QModbusDataUnit::HoldingRegisters, 0, 100);
+
+    QVariant value;
+    switch(mode)
+    {
+        case DataDisplayMode::FloatingPt:
+        case DataDisplayMode::SwappedFP:
+            value = 1234.5f;
+        break;
+
+        case DataDisplayMode::DblFloat:
+        case DataDisplayMode::SwappedDbl:
+            value = 1234.5;
+        break;
+
+        case DataDisplayMode::Int64:
+        case DataDisplayMode::SwappedInt64:
+        case DataDisplayMode::UInt64:
+        case DataDisplayMode::SwappedUInt64:
+            value = Q_INT64_C(0x123456789);
+        break;
+
+        default:
+            value = 0x1234;
+        break;
+    }
+
+    const ModbusWriteParams params = { 10, value, mode, ByteOrder::LittleEndian, true };
+    QBENCHMARK {
+        server.writeRegister(1, QModbusDataUnit::HoldingRegisters, params);
+    }
+}
+
+///
+/// \brief Benchmarks::multiServer_writeRegisters_data
+///
+void Benchmarks::multiServer_writeRegisters_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("125") << 125;
+    QTest::newRow("5000") << 5000;
+}
+
+///
+/// \brief Benchmarks::multiServer_writeRegisters
+///
+void Benchmarks::multiServer_writeRegisters()
+{
+    QFETCH(int, count);
+
+    ModbusMultiServer server;
+    server.addUnitMap(1, 1, QModbusDataUnit::HoldingRegisters, 0, quint16(count));
+
+    QVector<ModbusWriteParams> params(count);
+    for(int i = 0; i < count; i++)
+        params[i] = { quint16(i), i, DataDisplayMode::Decimal, ByteOrder::LittleEndian, true };
+
+    QBENCHMARK {
+        server.writeRegisters(1, QModbusDataUnit::HoldingRegisters, params);
+    }
+}
+
+///
+/// \brief Benchmarks::modbusMessage_create_data
+///
+void Benchmarks::modbusMessage_create_data()
+{
+    QTest::addColumn<int>("functionCode");
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("0x01") << int(QModbusPdu::ReadCoils) << QByteArray::fromHex("00000010");
+    QTest::newRow("0x02") << int(QModbusPdu::ReadDiscreteInputs) << QByteArray::fromHex("00000010");
+    QTest::newRow("0x03") << int(QModbusPdu::ReadHoldingRegisters) << QByteArray::fromHex("0000000A");
+    QTest::newRow("0x04") << int(QModbusPdu::ReadInputRegisters) << QByteArray::fromHex("0000000A");
+    QTest::newRow("0x05") << int(QModbusPdu::WriteSingleCoil) << QByteArray::fromHex("0001FF00");
+    QTest::newRow("0x06") << int(QModbusPdu::WriteSingleRegister) << QByteArray::fromHex("00011234");
+    QTest::newRow("0x07") << int(QModbusPdu::ReadExceptionStatus) << QByteArray();
+    QTest::newRow("0x08") << int(QModbusPdu::Diagnostics) << QByteArray::fromHex("00001234");
+    QTest::newRow("0x0B") << int(QModbusPdu::GetCommEventCounter) << QByteArray();
+    QTest::newRow("0x0C") << int(QModbusPdu::GetCommEventLog) << QByteArray();
+    QTest::newRow("0x0F") << int(QModbusPdu::WriteMultipleCoils) << QByteArray::fromHex("0000000A02FF03");
+    QTest::newRow("0x10") << int(QModbusPdu::WriteMultipleRegisters) << QByteArray::fromHex("000000020400010002");
+    QTest::newRow("0x11") << int(QModbusPdu::ReportServerId) << QByteArray();
+    QTest::newRow("0x14") << int(QModbusPdu::ReadFileRecord) << QByteArray::fromHex("0706000100000002");
+    QTest::newRow("0x15") << int(QModbusPdu::WriteFileRecord) << QByteArray::fromHex("0B0600010000000200010002");
+    QTest::newRow("0x16") << int(QModbusPdu::MaskWriteRegister) << QByteArray::fromHex("000400F20025");
+    QTest::newRow("0x17") << int(QModbusPdu::ReadWriteMultipleRegisters) << QByteArray::fromHex("00000002001000010200FF");
+    QTest::newRow("0x18") << int(QModbusPdu::ReadFifoQueue) << QByteArray::fromHex("04DE");
+}
+
+///
+/// \brief Benchmarks::modbusMessage_create
+///
+void Benchmarks::modbusMessage_create()
+{
+    QFETCH(int, functionCode);
+    QFETCH(QByteArray, data);
+
+    const QModbusRequest req(QModbusPdu::FunctionCode(functionCode), data);
+    const auto timestamp = QDateTime::currentDateTime();
+
+    QBENCHMARK {
+        delete ModbusMessage::create(req, ModbusMessage::Tcp, 1, timestamp, true);
+    }
+}
+
+///
+/// \brief Benchmarks::aduRtu_calculateCRC_data
+///
+void Benchmarks::aduRtu_calculateCRC_data()
+{
+    QTest::addColumn<int>("length");
+
+    QTest::newRow("8") << 8;
+    QTest::newRow("256") << 256;
+}
+
+///
+/// \brief Benchmarks::aduRtu_calculateCRC
+///
+void Benchmarks::aduRtu_calculateCRC()
+{
+    QFETCH(int, length);
+
+    QByteArray data(length, 0);
+    for(int i = 0; i < length; i++)
+        data[i] = char(i * 31);
+
+    quint16 crc = 0;
+    QBENCHMARK {
+        crc ^= QModbusAduRtu::calculateCRC(data.constData(), data.size());
+    }
+    Q_UNUSED(crc)
+}
+
+///
+/// \brief Benchmarks::formatValue_data
+///
+void Benchmarks::formatValue_data()
+{
+    addDisplayModeRows();
+}
+
+///
+/// \brief Benchmarks::formatValue
+///
+void Benchmarks::formatValue()
+{
+    QFETCH(DataDisplayMode, mode);
+
+    const auto pointType = QModbusDataUnit::HoldingRegisters;
+    const auto order = ByteOrder::LittleEndian;
+    const quint16 v1 = 0x4049, v2 = 0x0FDB, v3 = 0x1234, v4 = 0x5678;
+
+    QVariant outValue;
+    QBENCHMARK {
+        switch(mode)
+        {
+            case DataDisplayMode::Binary:
+                formatBinaryValue(pointType, v1, order, outValue);
+            break;
+
+            case DataDisplayMode::Decimal:
+                formatUInt16Value(pointType, v1, order, outValue);
+            break;
+
+            case DataDisplayMode::Integer:
+                formatInt16Value(pointType, v1, order, outValue);
+            break;
+
+            case DataDisplayMode::Hex:
+                formatHexValue(pointType, v1, order, outValue);
+            break;
+
+            case DataDisplayMode::FloatingPt:
+                formatFloatValue(pointType, v1, v2, order, false, outValue);
+            break;
+
+            case DataDisplayMode::SwappedFP:
+                formatFloatValue(pointType, v2, v1, order, false, outValue);
+            break;
+
+            case DataDisplayMode::DblFloat:
+                formatDoubleValue(pointType, v1, v2, v3, v4, order, false, outValue);
+            break;
+
+            case DataDisplayMode::SwappedDbl:
+                formatDoubleValue(pointType, v4, v3, v2, v1, order, false, outValue);
+            break;
+
+            case DataDisplayMode::Int32:
+                formatInt32Value(pointType, v1, v2, order, false, outValue);
+            break;
+
+            case DataDisplayMode::SwappedInt32:
+                formatInt32Value(pointType, v2, v1, order, false, outValue);
+            break;
+
+            case DataDisplayMode::UInt32:
+                formatUInt32Value(pointType, v1, v2, order, false, outValue);
+            break;
+
+            case DataDisplayMode::SwappedUInt32:
+                formatUInt32Value(pointType, v2, v1, order, false, outValue);
+            break;
+
+            case DataDisplayMode::Int64:
+                formatInt64Value(pointType, v1, v2, v3, v4, order, false, outValue);
+            break;
+
+            case DataDisplayMode::SwappedInt64:
+                formatInt64Value(pointType, v4, v3, v2, v1, order, false, outValue);
+            break;
+
+            case DataDisplayMode::UInt64:
+                formatUInt64Value(pointType, v1, v2, v3, v4, order, false, outValue);
+            break;
+
+            case DataDisplayMode::SwappedUInt64:
+                formatUInt64Value(pointType, v4, v3, v2, v1, order, false, outValue);
+            break;
+        }
+    }
+}
+
+///
+/// \brief Benchmarks::waveform_generate_data
+///
+void Benchmarks::waveform_generate_data()
+{
+    QTest::addColumn<SimulationMode>("mode");
+    QTest::addColumn<int>("count");
+
+    const QPair<const char*, SimulationMode> modes[] = {
+        { "Sine", SimulationMode::Sine },
+        { "Square", SimulationMode::Square },
+        { "Triangle", SimulationMode::Triangle },
+        { "Sawtooth", SimulationMode::Sawtooth },
+        { "Exponential", SimulationMode::Exponential }
+    };
+
+    for(auto&& m : modes)
+    {
+        QTest::addRow("%s/125", m.first) << m.second << 125;
+        QTest::addRow("%s/5000", m.first) << m.second << 5000;
+    }
+}
+
+///
+/// \brief Benchmarks::waveform_generate
+///
+void Benchmarks::waveform_generate()
+{
+    QFETCH(SimulationMode, mode);
+    QFETCH(int, count);
+
+    WaveformSimulationParams params;
+    params.Noise = 1.;
+
+    FastRandomGenerator generator(1);
+    QVector<double> phases(count);
+    QVector<double> samples(count);
+
+    double time = 0.;
+    QBENCHMARK {
+        waveformPhases(phases.data(), count, time, 10., params);
+        generateWaveform(mode, params, generator, samples.data(), phases.constData(), count);
+        time += 1000.;
+    }
+}
+
+///
+/// \brief Benchmarks::randomGenerator_fill_data
+///
+void Benchmarks::randomGenerator_fill_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("125") << 125;
+    QTest::newRow("5000") << 5000;
+}
+
+///
+/// \brief Benchmarks::randomGenerator_fill
+///
+void Benchmarks::randomGenerator_fill()
+{
+    QFETCH(int, count);
+
+    FastRandomGenerator generator(1);
+    QVector<double> values(count);
+
+    QBENCHMARK {
+        generator.fillRange(values.data(), count, 0., 65535.);
+    }
+}
+
+///
+/// \brief Benchmarks::logBuffer_append_data
+///
+void Benchmarks::logBuffer_append_data()
+{
+    QTest::addColumn<int>("length");
+
+    QTest::newRow("request") << 0;
+    QTest::newRow("125 registers") << 125;
+}
+
+///
+/// \brief Benchmarks::logBuffer_append
+///
+void Benchmarks::logBuffer_append()
+{
+    QFETCH(int, length);
+
+    // a full buffer, so every append also drops the oldest frames
+    ModbusLogBuffer buffer(1000);
+    const QModbusResponse resp(QModbusPdu::ReadHoldingRegisters, QByteArray(1 + 2 * length, '\x5A'));
+    for(int i = 0; i < buffer.capacity(); i++)
+        buffer.append(resp, ModbusMessage::Tcp, 1, i, false);
+
+    QBENCHMARK {
+        buffer.append(resp, ModbusMessage::Tcp, 1, 0, false);
+    }
+}
+
+///
+/// \brief Benchmarks::pcapWriter_append_data
+///
+void Benchmarks::pcapWriter_append_data()
+{
+    QTest::addColumn<int>("protocol");
+
+    QTest::newRow("tcp") << int(ModbusMessage::Tcp);
+    QTest::newRow("rtu") << int(ModbusMessage::Rtu);
+}
+
+///
+/// \brief Benchmarks::pcapWriter_append
+///
+void Benchmarks::pcapWriter_append()
+{
+    QFETCH(int, protocol);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ModbusPcapWriter writer;
+    PcapCaptureParams params;
+    params.FileName = dir.filePath("capture.pcapng");
+    QVERIFY(writer.start(params));
+
+    // only queueing is measured, the writer thread drains the queue meanwhile
+    const QModbusResponse resp(QModbusPdu::ReadHoldingRegisters, QByteArray(1 + 2 * 125, '\x5A'));
+    QBENCHMARK {
+        writer.append(resp, ModbusMessage::ProtocolType(protocol), 1, 0, false);
+    }
+
+    writer.stop();
+}
+
+///
+/// \brief Benchmarks::trafficJournal_append
+///
+void Benchmarks::trafficJournal_append()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ModbusTrafficJournal journal;
+    TrafficJournalParams params;
+    params.Directory = dir.path();
+    QVERIFY(journal.open(params));
+
+    const QModbusRequest req(QModbusPdu::WriteMultipleRegisters, QByteArray::fromHex("0FA0000A14") + QByteArray(20, '\x5A'));
+    QBENCHMARK {
+        journal.append(req, ModbusMessage::Tcp, 1, 0, true, 0);
+    }
+}
+
+///
+/// \brief Benchmarks::trafficJournal_query
+///
+void Benchmarks::trafficJournal_query()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ModbusTrafficJournal journal;
+    TrafficJournalParams params;
+    params.Directory = dir.path();
+    QVERIFY(journal.open(params));
+
+    // reads flood the journal, one block in a hundred has the writes looked for
+    const QModbusRequest read(QModbusPdu::ReadHoldingRegisters, QByteArray::fromHex("0000007D"));
+    const QModbusRequest write(QModbusPdu::WriteMultipleRegisters, QByteArray::fromHex("0FA0000102002A"));
+    for(int i = 0; i < 100 * ModbusTrafficJournal::IndexInterval; i++)
+        journal.append((i / ModbusTrafficJournal::IndexInterval == 50) ? write : read, ModbusMessage::Tcp, 1, i, true, 0);
+    journal.close();
+
+    TrafficJournalQuery query;
+    query.FunctionCodes = { QModbusPdu::WriteMultipleRegisters };
+    query.FromAddress = 4000;
+    query.ToAddress = 4100;
+
+    QBENCHMARK {
+        const auto count = ModbusTrafficJournal::query(dir.path(), query, [](const TrafficJournalFrame&) { return true; });
+        QCOMPARE(count, ModbusTrafficJournal::IndexInterval);
+    }
+}
+
+///
+/// \brief Benchmarks::trafficFilter_accept_data
+///
+void Benchmarks::trafficFilter_accept_data()
+{
+    QTest::addColumn<QString>("expression");
+
+    QTest::newRow("all frames") << QString();
+    QTest::newRow("function codes") << QString("fc=15,16");
+    QTest::newRow("address range") << QString("fc=3;unit=1;addr=4000-4100");
+    QTest::newRow("sampling") << QString("sample=10");
+}
+
+///
+/// \brief Benchmarks::trafficFilter_accept
+///
+void Benchmarks::trafficFilter_accept()
+{
+    QFETCH(QString, expression);
+
+    ModbusTrafficFilter filter;
+    QVERIFY(filter.compile(expression));
+
+    const QModbusRequest req(QModbusPdu::ReadHoldingRegisters, QByteArray::fromHex("0000007D"));
+    const QModbusResponse resp(QModbusPdu::ReadHoldingRegisters, QByteArray(1 + 2 * 125, '\x5A'));
+    int transactionId = 0;
+    QBENCHMARK {
+        filter.accept(req, 0, 1, transactionId, true);
+        filter.accept(resp, 0, 1, transactionId, false);
+        transactionId++;
+    }
+}
+
+QTEST_GUILESS_MAIN(Benchmarks)
+
+#include "benchmarks.moc"
@@ -0,0 +1,43 @@
+QT += core network serialbus serialport testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+CONFIG -= debug_and_release
+CONFIG -= debug_and_release_target
+
+TARGET = omodsim_benchmarks
+
+SRC = ../omodsim
+
+INCLUDEPATH += $$SRC \
+               $$SRC/modbusmessages \
+
+SOURCES += \
+    benchmarks.cpp \
+    $$SRC/modbusdatacoalescer.cpp \
+    $$SRC/modbusdatadispatcher.cpp \
+    $$SRC/modbusdataunitmap.cpp \
+    $$SRC/modbusepollserver.cpp \
+    $$SRC/modbuslogbuffer.cpp \
+    $$SRC/modbusmessages/modbusmessage.cpp \
+    $$SRC/modbusmultiserver.cpp \
+    $$SRC/modbuspcapwriter.cpp \
+    $$SRC/modbusstatistics.cpp \
+    $$SRC/modbustrafficfilter.cpp \
+    $$SRC/modbustrafficjournal.cpp \
+    $$SRC/modbustrafficlog.cpp \
+
+HEADERS += \
+    $$SRC/modbusdatacoalescer.h \
+    $$SRC/modbusdatadispatcher.h \
+    $$SRC/modbusdataunitmap.h \
+    $$SRC/modbusepollserver.h \
+    $$SRC/modbuslogbuffer.h \
+    $$SRC/modbusmultiserver.h \
+    $$SRC/modbuspcapwriter.h \
+    $$SRC/modbusstatistics.h \
+    $$SRC/modbustrafficfilter.h \
+    $$SRC/modbustrafficjournal.h \
+    $$SRC/modbustrafficlog.h \
+    $$SRC/trafficutils.h \
@@ -11,6 +11,98 @@ CmdLineParser::CmdLineParser()
     QCommandLineOption versionOption(QStringList() << _version, tr("Displays version information."));
     addOption(versionOption);
 
-    QCommandLineOption configOption(QStringList() << _config, tr("Setup test config file."), tr("file path"));
+    QCommandLineOption configOption(QStringList() << _config, tr("Setup test config or scenario (.scn) file."), tr("file path"));
     addOption(configOption);
+
+    QCommandLineOption headlessOption(QStringList() << _headless, tr("Run server without user interface."));
+    addOption(headlessOption);
+
+    QCommandLineOption updateRateOption(QStringList() << _updateRate, tr("Data change notifications per second (0 - on every write)."), tr("rate"));
+    addOption(updateRateOption);
+
+    QCommandLineOption statsOption(QStringList() << _stats, tr("Write request statistics to file on exit (- for standard output)."), tr("file path"));
+    addOption(statsOption);
+
+    QCommandLineOption replayOption(QStringList() << _replay, tr("Replay recorded register values from CSV or binary file in headless mode."), tr("file path"));
+    addOption(replayOption);
+
+    QCommandLineOption replayRateOption(QStringList() << _replayRate, tr("Replay speed relative to the recording (default 1)."), tr("rate"));
+    addOption(replayRateOption);
+
+    QCommandLineOption replayLoopOption(QStringList() << _replayLoop, tr("Restart the replay at the end of the recording."));
+    addOption(replayLoopOption);
+
+    QCommandLineOption clockRateOption(QStringList() << _clockRate, tr("Simulation clock speed relative to the wall clock (default 1)."), tr("rate"));
+    addOption(clockRateOption);
+
+    QCommandLineOption pcapOption(QStringList() << _pcap, tr("Capture traffic to pcapng file in headless mode."), tr("file path"));
+    addOption(pcapOption);
+
+    QCommandLineOption pcapSizeOption(QStringList() << _pcapSize, tr("Start a new capture file after this many megabytes."), tr("size"));
+    addOption(pcapSizeOption);
+
+    QCommandLineOption pcapTimeOption(QStringList() << _pcapTime, tr("Start a new capture file after this many seconds."), tr("seconds"));
+    addOption(pcapTimeOption);
+
+    QCommandLineOption journalOption(QStringList() << _journal, tr("Keep traffic history in journal directory in headless mode."), tr("directory"));
+    addOption(journalOption);
+
+    QCommandLineOption journalSizeOption(QStringList() << _journalSize, tr("Start a new journal segment after this many megabytes (default 64)."), tr("size"));
+    addOption(journalSizeOption);
+
+    QCommandLineOption logFilterOption(QStringList() << _logFilter, tr("Log only matching frames in headless mode, e.g. \"fc=15,16;unit=1;addr=4000-4100;sample=10\" or \"exceptions\"."), tr("filter"));
+    addOption(logFilterOption);
+
+    QCommandLineOption queryOption(QStringList() << _query, tr("Print frames from journal directory and exit."), tr("directory"));
+    addOption(queryOption);
+
+    QCommandLineOption fromOption(QStringList() << _from, tr("Query frames logged at or after ISO 8601 date and time."), tr("time"));
+    addOption(fromOption);
+
+    QCommandLineOption toOption(QStringList() << _to, tr("Query frames logged at or before ISO 8601 date and time."), tr("time"));
+    addOption(toOption);
+
+    QCommandLineOption functionOption(QStringList() << _function, tr("Query frames of function codes, e.g. 15,16."), tr("codes"));
+    addOption(functionOption);
+
+    QCommandLineOption unitOption(QStringList() << _unit, tr("Query frames of unit IDs, e.g. 1-3."), tr("ids"));
+    addOption(unitOption);
+
+    QCommandLineOption addressOption(QStringList() << _address, tr("Query frames with zero based start address in range, e.g. 4000-4100."), tr("range"));
+    addOption(addressOption);
+
+#ifdef Q_OS_LINUX
+    QCommandLineOption epollOption(QStringList() << _epoll, tr("Use epoll based Modbus/TCP listener."));
+    addOption(epollOption);
+#endif
+
+    addPositionalArgument("files", tr("Form files to open in headless mode."), "[files...]");
+}
+
+///
+/// \brief CmdLineParser::isHeadless
+/// \param argc
+/// \param argv
+/// \return true for headless mode and journal queries, which run without user interface
+///
+bool CmdLineParser::isHeadless(int argc, char* argv[])
+{
+    // matches the option as well as its --option=value form, like QCommandLineParser does
+    const auto matches = [](const QByteArray& arg, const char* name)
+    {
+        const auto option = QByteArray("--") + name;
+        return arg == option || arg.startsWith(option + '=');
+    };
+
+    for(int i = 1; i < argc; i++)
+    {
+        const QByteArray arg(argv[i]);
+        if(arg == "--")
+            break;
+
+        if(matches(arg, _headless) || matches(arg, _query))
+            return true;
+    }
+
+    return false;
 }
@@ -8,10 +8,32 @@ class CmdLineParser : public QCommandLineParser
 public:
     explicit CmdLineParser();
 
+    static bool isHeadless(int argc, char* argv[]);
+
 public:
-    static constexpr const char* _help =    "help";
-    static constexpr const char* _version = "version";
-    static constexpr const char* _config =  "config";
+    static constexpr const char* _help =     "help";
+    static constexpr const char* _version =  "version";
+    static constexpr const char* _config =   "config";
+    static constexpr const char* _headless = "headless";
+    static constexpr const char* _epoll =    "epoll";
+    static constexpr const char* _updateRate = "update-rate";
+    static constexpr const char* _stats =    "stats";
+    static constexpr const char* _replay =   "replay";
+    static constexpr const char* _replayRate = "replay-rate";
+    static constexpr const char* _replayLoop = "replay-loop";
+    static constexpr const char* _clockRate = "clock-rate";
+    static constexpr const char* _pcap =     "pcap";
+    static constexpr const char* _pcapSize = "pcap-size";
+    static constexpr const char* _pcapTime = "pcap-time";
+    static constexpr const char* _journal =  "journal";
+    static constexpr const char* _journalSize = "journal-size";
+    static constexpr const char* _logFilter = "log-filter";
+    static constexpr const char* _query =    "query";
+    static constexpr const char* _from =     "from";
+    static constexpr const char* _to =       "to";
+    static constexpr const char* _function = "function";
+    static constexpr const char* _unit =     "unit";
+    static constexpr const char* _address =  "address";
 };
 
 #endif // CMDLINEPARSER_H
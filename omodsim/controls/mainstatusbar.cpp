@@ -1,4 +1,7 @@
 #include <QEvent>
+#include <QAction>
+#include <QFileDialog>
+#include <QMessageBox>
 #include <QMdiSubWindow>
 #include "mainstatusbar.h"
 
@@ -37,9 +40,36 @@ QString Parity_toString(QSerialPort::Parity parity)
 /// \brief MainStatusBar::MainStatusBar
 /// \param parent
 ///
-MainStatusBar::MainStatusBar(const ModbusMultiServer& server, QWidget* parent)
+MainStatusBar::MainStatusBar(ModbusMultiServer& server, QWidget* parent)
     : QStatusBar(parent)
+    ,_statistics(server.statistics())
 {
+    _statisticsLabel = new QLabel(this);
+    _statisticsLabel->setFrameShadow(QFrame::Sunken);
+    _statisticsLabel->setFrameShape(QFrame::Panel);
+    _statisticsLabel->setMinimumWidth(80);
+    _statisticsLabel->setContextMenuPolicy(Qt::ActionsContextMenu);
+    addPermanentWidget(_statisticsLabel);
+
+    _saveStatisticsAction = new QAction(this);
+    connect(_saveStatisticsAction, &QAction::triggered, this, &MainStatusBar::on_saveStatistics);
+    _statisticsLabel->addAction(_saveStatisticsAction);
+
+    _resetStatisticsAction = new QAction(this);
+    connect(_resetStatisticsAction, &QAction::triggered, this, [&]
+    {
+        _statistics.reset();
+        _lastRequests = 0;
+        on_statisticsTimeout();
+    });
+    _statisticsLabel->addAction(_resetStatisticsAction);
+
+    updateStatisticsActions();
+    on_statisticsTimeout();
+
+    connect(&_statisticsTimer, &QTimer::timeout, this, &MainStatusBar::on_statisticsTimeout);
+    _statisticsTimer.start(1000);
+
     connect(&server, &ModbusMultiServer::connected, this, [&](const ConnectionDetails& cd)
     {
         auto label = new QLabel(this);
@@ -91,6 +121,9 @@ void MainStatusBar::changeEvent(QEvent* event)
             const auto cd = label->property("ConnectionDetails").value<ConnectionDetails>();
             updateConnectionInfo(label, cd);
         }
+
+        updateStatisticsActions();
+        on_statisticsTimeout();
     }
 
     QStatusBar::changeEvent(event);
@@ -118,3 +151,38 @@ void MainStatusBar::updateConnectionInfo(QLabel* label, const ConnectionDetails&
         break;
     }
 }
+
+///
+/// \brief MainStatusBar::updateStatisticsActions
+///
+void MainStatusBar::updateStatisticsActions()
+{
+    _saveStatisticsAction->setText(tr("Save Statistics..."));
+    _resetStatisticsAction->setText(tr("Reset Statistics"));
+}
+
+///
+/// \brief MainStatusBar::on_statisticsTimeout
+///
+void MainStatusBar::on_statisticsTimeout()
+{
+    const auto requests = _statistics.totalRequests();
+    const auto rate = (requests - _lastRequests) * 1000 / qMax(1, _statisticsTimer.interval());
+    _lastRequests = requests;
+
+    _statisticsLabel->setText(QString(tr("%1 req/s, p99 %2 ms")).arg(QString::number(rate),
+                                                                   QString::number(_statistics.latencyPercentile(99.0) / 1e6, 'f', 3)));
+}
+
+///
+/// \brief MainStatusBar::on_saveStatistics
+///
+void MainStatusBar::on_saveStatistics()
+{
+    const auto filename = QFileDialog::getSaveFileName(this, QString(), QString(), tr("Text files (*.txt);;All files (*)"));
+    if(filename.isEmpty())
+        return;
+
+    if(!_statistics.dump(filename))
+        QMessageBox::warning(this, window()->windowTitle(), QString(tr("Failed to save %1")).arg(filename));
+}
@@ -1,6 +1,7 @@
 #ifndef MAINSTATUSBAR_H
 #define MAINSTATUSBAR_H
 
+#include <QTimer>
 #include <QLabel>
 #include <QStatusBar>
 #include "modbusmultiserver.h"
@@ -12,17 +13,29 @@ class MainStatusBar : public QStatusBar
 {
     Q_OBJECT
 public:
-    explicit MainStatusBar(const ModbusMultiServer& server, QWidget* parent = nullptr);
+    explicit MainStatusBar(ModbusMultiServer& server, QWidget* parent = nullptr);
     ~MainStatusBar();
 
 protected:
     void changeEvent(QEvent* event) override;
 
+private slots:
+    void on_statisticsTimeout();
+    void on_saveStatistics();
+
 private:
     void updateConnectionInfo(QLabel* label, const ConnectionDetails& cd);
+    void updateStatisticsActions();
 
 private:
     QList<QLabel*> _labels;
+
+    ModbusStatistics& _statistics;
+    quint64 _lastRequests = 0;
+    QLabel* _statisticsLabel;
+    QAction* _saveStatisticsAction;
+    QAction* _resetStatisticsAction;
+    QTimer _statisticsTimer;
 };
 
 #endif // MAINSTATUSBAR_H
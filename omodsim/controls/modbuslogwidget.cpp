@@ -9,17 +9,10 @@
 ModbusLogModel::ModbusLogModel(ModbusLogWidget* parent)
     : QAbstractListModel(parent)
     ,_parentWidget(parent)
+    ,_rows(30)
 {
 }
 
-///
-/// \brief ModbusLogModel::~ModbusLogModel
-///
-ModbusLogModel::~ModbusLogModel()
-{
-    deleteItems();
-}
-
 ///
 /// \brief ModbusLogModel::rowCount
 /// \param parent
@@ -27,7 +20,7 @@ ModbusLogModel::~ModbusLogModel()
 ///
 int ModbusLogModel::rowCount(const QModelIndex&) const
 {
-    return _items.size();
+    return _count;
 }
 
 ///
@@ -41,16 +34,17 @@ QVariant ModbusLogModel::data(const QModelIndex& index, int role) const
     if(!index.isValid() || index.row() >= rowCount())
         return QVariant();
 
-    const auto& item = _items.at(index.row());
     switch(role)
     {
         case Qt::DisplayRole:
+        {
+            const QScopedPointer<const ModbusMessage> item(createMessage(index.row()));
+            if(!item) return QVariant();
+
             return QString("<b>%1</b> %2 %3").arg(item->timestamp().toString(Qt::ISODateWithMs),
                                                   (item->isRequest()?  "&larr;" : "&rarr;"),
                                                   item->toString(_parentWidget->dataDisplayMode()));
-
-        case Qt::UserRole:
-            return QVariant::fromValue(item);
+        }
     }
 
     return QVariant();
@@ -62,27 +56,84 @@ QVariant ModbusLogModel::data(const QModelIndex& index, int role) const
 void ModbusLogModel::clear()
 {
     beginResetModel();
-    deleteItems();
+    _first = 0;
+    _count = 0;
+    _startSequence = _log ? _log->endSequence() : 0;
     endResetModel();
+
+    updateRetention();
 }
 
 ///
-/// \brief ModbusLogModel::append
-/// \param data
+/// \brief ModbusLogModel::createMessage
+/// \param row
+/// \return decoded frame, owned by the caller
 ///
-void ModbusLogModel::append(const ModbusMessage* data)
+const ModbusMessage* ModbusLogModel::createMessage(int row) const
 {
-    if(data == nullptr) return;
+    if(!_log || row < 0 || row >= _count)
+        return nullptr;
 
-    while(rowCount() >= _rowLimit)
+    return _log->createMessage(sequence(row));
+}
+
+///
+/// \brief ModbusLogModel::trafficLog
+/// \return
+///
+ModbusTrafficLog* ModbusLogModel::trafficLog() const
+{
+    return _log;
+}
+
+///
+/// \brief ModbusLogModel::setTrafficLog
+/// \param log
+///
+void ModbusLogModel::setTrafficLog(ModbusTrafficLog* log)
+{
+    if(log == _log)
+        return;
+
+    if(_log)
     {
-        delete _items.first();
-        _items.removeFirst();
+        disconnect(_log, nullptr, this, nullptr);
+        _log->removeView(this);
     }
 
-    beginInsertRows(QModelIndex(), rowCount(), rowCount());
-    _items.push_back(data);
-    endInsertRows();
+    _log = log;
+    _startSequence = 0;
+
+    if(_log)
+    {
+        connect(_log, &ModbusTrafficLog::appended, this, &ModbusLogModel::on_appended);
+        connect(_log, &ModbusTrafficLog::capacityChanged, this, &ModbusLogModel::removeExpired);
+        _log->setViewLimit(this, rowLimit());
+    }
+
+    rebuild();
+}
+
+///
+/// \brief ModbusLogModel::deviceFilter
+/// \return
+///
+int ModbusLogModel::deviceFilter() const
+{
+    return _deviceId;
+}
+
+///
+/// \brief ModbusLogModel::setDeviceFilter
+/// \param deviceId - unit identifier of the shown frames, 0 shows all frames
+///
+void ModbusLogModel::setDeviceFilter(int deviceId)
+{
+    if(deviceId == _deviceId)
+        return;
+
+    _deviceId = deviceId;
+    rebuild();
 }
 
 ///
@@ -91,7 +142,7 @@ void ModbusLogModel::append(const ModbusMessage* data)
 ///
 int ModbusLogModel::rowLimit() const
 {
-    return _rowLimit;
+    return _rows.size();
 }
 
 ///
@@ -100,18 +151,115 @@ int ModbusLogModel::rowLimit() const
 ///
 void ModbusLogModel::setRowLimit(int val)
 {
-    _rowLimit = qMax(1, val);
+    val = qBound(1, val, ModbusLogBuffer::MaxCapacity);
+    if(val == _rows.size())
+        return;
+
+    // the shared log drops frames before the rows are rebuilt
+    if(_log)
+        _log->setViewLimit(this, val);
+
+    _rows.resize(val);
+    _rows.squeeze();
+
+    rebuild();
 }
 
 ///
-/// \brief ModbusLogModel::deleteItems
+/// \brief ModbusLogModel::on_appended
+/// \param sequence
 ///
-void ModbusLogModel::deleteItems()
+void ModbusLogModel::on_appended(quint64 sequence)
 {
-    for(auto&& i : _items)
-        delete i;
+    removeExpired();
+
+    if(!matches(_log->record(sequence)))
+        return;
+
+    if(_count == _rows.size())
+    {
+        beginRemoveRows(QModelIndex(), 0, 0);
+        _first = (_first + 1) % _rows.size();
+        _count--;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), _count, _count);
+    _rows[(_first + _count) % _rows.size()] = sequence;
+    _count++;
+    endInsertRows();
 
-    _items.clear();
+    updateRetention();
+}
+
+///
+/// \brief ModbusLogModel::matches
+/// \param record
+/// \return
+///
+bool ModbusLogModel::matches(const ModbusLogRecord& record) const
+{
+    return _deviceId == 0 || record.DeviceId == _deviceId;
+}
+
+///
+/// \brief ModbusLogModel::removeExpired
+///
+void ModbusLogModel::removeExpired()
+{
+    if(!_log)
+        return;
+
+    // frames the shared log has dropped
+    int count = 0;
+    while(count < _count && sequence(count) < _log->firstSequence())
+        count++;
+
+    if(count > 0)
+    {
+        beginRemoveRows(QModelIndex(), 0, count - 1);
+        _first = (_first + count) % _rows.size();
+        _count -= count;
+        endRemoveRows();
+
+        updateRetention();
+    }
+}
+
+///
+/// \brief ModbusLogModel::rebuild
+///
+void ModbusLogModel::rebuild()
+{
+    beginResetModel();
+
+    _first = 0;
+    _count = 0;
+
+    if(_log)
+    {
+        // newest matching frames, walking back from the end of the log
+        const auto first = qMax(_log->firstSequence(), _startSequence);
+        for(auto seq = _log->endSequence(); seq > first && _count < _rows.size(); seq--)
+        {
+            if(matches(_log->record(seq - 1)))
+                _rows[_rows.size() - 1 - _count++] = seq - 1;
+        }
+        _first = _rows.size() - _count;
+    }
+
+    endResetModel();
+
+    updateRetention();
+}
+
+///
+/// \brief ModbusLogModel::updateRetention - the shared log keeps the frames from the oldest row on
+///
+void ModbusLogModel::updateRetention()
+{
+    if(_log)
+        _log->setViewRetention(this, _count > 0 ? sequence(0) : _log->endSequence());
 }
 
 ///
@@ -122,6 +270,8 @@ ModbusLogWidget::ModbusLogWidget(QWidget* parent)
     : QListView(parent)
     , _autoscroll(false)
 {
+    // rows are formatted on paint, so their size must not depend on the contents
+    setUniformItemSizes(true);
     setItemDelegate(new HtmlDelegate(this));
     setModel(new ModbusLogModel(this));
 
@@ -174,42 +324,56 @@ QModelIndex ModbusLogWidget::index(int row)
 }
 
 ///
-/// \brief ModbusLogWidget::addItem
-/// \param pdu
-/// \param protocol
-/// \param deviceId
-/// \param transactionId
-/// \param timestamp
-/// \param request
+/// \brief ModbusLogWidget::createMessage
+/// \param index
+/// \return decoded frame, owned by the caller
+///
+const ModbusMessage* ModbusLogWidget::createMessage(const QModelIndex& index)
+{
+    if(!index.isValid())
+        return nullptr;
+
+    return model() ? ((ModbusLogModel*)model())->createMessage(index.row()) : nullptr;
+}
+
+///
+/// \brief ModbusLogWidget::trafficLog
 /// \return
 ///
-const ModbusMessage* ModbusLogWidget::addItem(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, const QDateTime& timestamp, bool request)
+ModbusTrafficLog* ModbusLogWidget::trafficLog() const
 {
-    const ModbusMessage* msg = nullptr;
-    if(model())
-    {
-        msg = ModbusMessage::create(pdu, protocol, deviceId, timestamp, request);
-        if(protocol == ModbusMessage::Tcp)
-            ((QModbusAduTcp*)msg->adu())->setTransactionId(transactionId);
+    return model() ? ((ModbusLogModel*)model())->trafficLog() : nullptr;
+}
 
-        ((ModbusLogModel*)model())->append(msg);
+///
+/// \brief ModbusLogWidget::setTrafficLog
+/// \param log
+///
+void ModbusLogWidget::setTrafficLog(ModbusTrafficLog* log)
+{
+    if(model()) {
+        ((ModbusLogModel*)model())->setTrafficLog(log);
     }
-    return msg;
 }
 
 ///
-/// \brief ModbusLogWidget::itemAt
-/// \param index
+/// \brief ModbusLogWidget::deviceFilter
 /// \return
 ///
-const ModbusMessage* ModbusLogWidget::itemAt(const QModelIndex& index)
+int ModbusLogWidget::deviceFilter() const
 {
-    if(!index.isValid())
-        return nullptr;
+    return model() ? ((ModbusLogModel*)model())->deviceFilter() : 0;
+}
 
-    return model() ?
-           model()->data(index, Qt::UserRole).value<const ModbusMessage*>() :
-           nullptr;
+///
+/// \brief ModbusLogWidget::setDeviceFilter
+/// \param deviceId - unit identifier of the shown frames, 0 shows all frames
+///
+void ModbusLogWidget::setDeviceFilter(int deviceId)
+{
+    if(model()) {
+        ((ModbusLogModel*)model())->setDeviceFilter(deviceId);
+    }
 }
 
 ///
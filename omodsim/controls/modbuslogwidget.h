@@ -1,14 +1,15 @@
 #ifndef MODBUSLOGWIDGET_H
 #define MODBUSLOGWIDGET_H
 
-#include <QQueue>
 #include <QListView>
-#include "modbusmessage.h"
+#include "modbustrafficlog.h"
 
 class ModbusLogWidget;
 
 ///
-/// \brief The ModbusLogModel class
+/// \brief The ModbusLogModel class - filtered view over the shared traffic log
+///
+/// Rows keep sequence numbers of the matching frames, which are decoded and formatted only when shown.
 ///
 class  ModbusLogModel : public QAbstractListModel
 {
@@ -16,27 +17,46 @@ class  ModbusLogModel : public QAbstractListModel
 
 public:
     explicit ModbusLogModel(ModbusLogWidget* parent);
-    ~ModbusLogModel();
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role) const override;
 
     void clear();
-    void append(const ModbusMessage* data);
     void update(){
-        emit dataChanged(index(0), index(_items.size() - 1));
+        emit dataChanged(index(0), index(_count - 1));
     }
 
+    const ModbusMessage* createMessage(int row) const;
+
+    ModbusTrafficLog* trafficLog() const;
+    void setTrafficLog(ModbusTrafficLog* log);
+
+    int deviceFilter() const;
+    void setDeviceFilter(int deviceId);
+
     int rowLimit() const;
     void setRowLimit(int val);
 
+private slots:
+    void on_appended(quint64 sequence);
+    void removeExpired();
+
 private:
-    void deleteItems();
+    bool matches(const ModbusLogRecord& record) const;
+    quint64 sequence(int row) const {
+        return _rows[(_first + row) % _rows.size()];
+    }
+    void rebuild();
+    void updateRetention();
 
 private:
-    int _rowLimit = 30;
     ModbusLogWidget* _parentWidget;
-    QQueue<const ModbusMessage*> _items;
+    ModbusTrafficLog* _log = nullptr;
+    QVector<quint64> _rows;
+    int _first = 0;
+    int _count = 0;
+    int _deviceId = 0;
+    quint64 _startSequence = 0;
 };
 
 ///
@@ -53,8 +73,13 @@ public:
     int rowCount() const;
     QModelIndex index(int row);
 
-    const ModbusMessage* addItem(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, const QDateTime& timestamp, bool request);
-    const ModbusMessage* itemAt(const QModelIndex& index);
+    const ModbusMessage* createMessage(const QModelIndex& index);
+
+    ModbusTrafficLog* trafficLog() const;
+    void setTrafficLog(ModbusTrafficLog* log);
+
+    int deviceFilter() const;
+    void setDeviceFilter(int deviceId);
 
     DataDisplayMode dataDisplayMode() const;
     void setDataDisplayMode(DataDisplayMode mode);
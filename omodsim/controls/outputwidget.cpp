@@ -187,12 +187,47 @@ void OutputListModel::update()
 void OutputListModel::updateData(const QModbusDataUnit& data)
 {
     _lastData = data;
+    updateRows(0, rowCount() - 1);
+}
+
+///
+/// \brief OutputListModel::updateValues
+/// \param data - changed slice of the displayed range
+///
+void OutputListModel::updateValues(const QModbusDataUnit& data)
+{
+    if(!_lastData.isValid() || data.registerType() != _lastData.registerType())
+        return;
+
+    const int offset = data.startAddress() - _lastData.startAddress();
+    const int first = qMax(0, offset);
+    const int last = qMin<int>(offset + data.valueCount(), _lastData.valueCount()) - 1;
+    if(first > last)
+        return;
+
+    for(int i = first; i <= last; i++)
+        _lastData.setValue(i, data.value(i - offset));
+
+    // 32 and 64-bit values are formatted from the row that starts them
+    updateRows(qMax(0, first - 3), last);
+}
+
+///
+/// \brief OutputListModel::updateRows
+/// \param first
+/// \param last
+///
+void OutputListModel::updateRows(int first, int last)
+{
+    last = qMin(last, rowCount() - 1);
+    if(first > last)
+        return;
 
     const auto mode = _parentWidget->dataDisplayMode();
     const auto pointType = _parentWidget->_displayDefinition.PointType;
     const auto byteOrder = *_parentWidget->byteOrder();
 
-    for(int i = 0; i < rowCount(); i++)
+    for(int i = first; i <= last; i++)
     {
         const auto value = _lastData.value(i);
 
@@ -280,7 +315,7 @@ void OutputListModel::updateData(const QModbusDataUnit& data)
         }
     }
 
-    emit dataChanged(index(0), index(rowCount() - 1), QVector<int>() << Qt::DisplayRole);
+    emit dataChanged(index(first), index(last), QVector<int>() << Qt::DisplayRole);
 }
 
 ///
@@ -333,6 +368,13 @@ OutputWidget::OutputWidget(QWidget *parent) :
                 if(!sel.indexes().isEmpty())
                     showModbusMessage(sel.indexes().first());
             });
+
+    connect(ui->logView->model(),
+            &QAbstractItemModel::rowsInserted,
+            this, [&](const QModelIndex&, int first, int last) {
+                for(int row = first; row <= last; row++)
+                    captureModbusMessage(ui->logView->index(row));
+            });
 }
 
 ///
@@ -379,6 +421,7 @@ void OutputWidget::setup(const DisplayDefinition& dd, const ModbusSimulationMap&
     _displayDefinition = dd;
 
     setLogViewLimit(dd.LogViewLimit);
+    ui->logView->setDeviceFilter(dd.DeviceId);
 
     _listModel->clear();
 
@@ -426,7 +469,8 @@ CaptureMode OutputWidget::captureMode() const
 void OutputWidget::startTextCapture(const QString& file)
 {
     _fileCapture.setFileName(file);
-    _fileCapture.open(QFile::Text | QFile::WriteOnly);
+    if(_fileCapture.open(QFile::Text | QFile::WriteOnly))
+        _captureStream.setDevice(&_fileCapture);
 }
 
 ///
@@ -435,7 +479,11 @@ void OutputWidget::startTextCapture(const QString& file)
 void OutputWidget::stopTextCapture()
 {
     if(_fileCapture.isOpen())
+    {
+        _captureStream.flush();
+        _captureStream.setDevice(nullptr);
         _fileCapture.close();
+    }
 }
 
 ///
@@ -539,6 +587,15 @@ void OutputWidget::setLogViewLimit(int l)
     ui->logView->setRowLimit(l);
 }
 
+///
+/// \brief OutputWidget::setTrafficLog
+/// \param log - traffic shared by all forms, the log view shows the frames of the displayed device
+///
+void OutputWidget::setTrafficLog(ModbusTrafficLog* log)
+{
+    ui->logView->setTrafficLog(log);
+}
+
 ///
 /// \brief OutputWidget::setStatus
 /// \param status
@@ -604,35 +661,20 @@ void OutputWidget::paint(const QRect& rc, QPainter& painter)
 }
 
 ///
-/// \brief OutputWidget::updateTraffic
-/// \param request
-/// \param server
-/// \param transactionId
-/// \param protocol
-///
-void OutputWidget::updateTraffic(const QModbusRequest& request, int server, int transactionId, ModbusMessage::ProtocolType protocol)
-{
-    updateLogView(true, server, transactionId, protocol, request);
-}
-
-///
-/// \brief OutputWidget::updateTraffic
-/// \param response
-/// \param server
-/// \param transactionId
-/// \param protocol
+/// \brief OutputWidget::updateData
 ///
-void OutputWidget::updateTraffic(const QModbusResponse& response, int server, int transactionId, ModbusMessage::ProtocolType protocol)
+void OutputWidget::updateData(const QModbusDataUnit& data)
 {
-    updateLogView(false, server, transactionId, protocol, response);
+    _listModel->updateData(data);
 }
 
 ///
-/// \brief OutputWidget::updateData
+/// \brief OutputWidget::updateValues
+/// \param data
 ///
-void OutputWidget::updateData(const QModbusDataUnit& data)
+void OutputWidget::updateValues(const QModbusDataUnit& data)
 {
-    _listModel->updateData(data);
+    _listModel->updateValues(data);
 }
 
 ///
@@ -840,10 +882,7 @@ void OutputWidget::setInvalidLengthStatus()
 void OutputWidget::captureString(const QString& s)
 {
     if(_fileCapture.isOpen())
-    {
-        QTextStream stream(&_fileCapture);
-        stream << s << "\n";
-    }
+        _captureStream << s << "\n";
 }
 
 ///
@@ -852,23 +891,22 @@ void OutputWidget::captureString(const QString& s)
 ///
 void OutputWidget::showModbusMessage(const QModelIndex& index)
 {
-    const auto msg = ui->logView->itemAt(index);
+    const auto msg = ui->logView->createMessage(index);
     ui->modbusMsg->setModbusMessage(msg);
+    _modbusMessage.reset(msg);
 }
 
 ///
-/// \brief OutputWidget::updateLogView
-/// \param request
-/// \param server
-/// \param transactionId
-/// \param protocol
-/// \param pdu
+/// \brief OutputWidget::captureModbusMessage
+/// \param index
 ///
-void OutputWidget::updateLogView(bool request, int server, int transactionId, ModbusMessage::ProtocolType protocol, const QModbusPdu& pdu)
+void OutputWidget::captureModbusMessage(const QModelIndex& index)
 {
-    auto msg = ui->logView->addItem(pdu, protocol, server, transactionId, QDateTime::currentDateTime(), request);
-    if(captureMode() == CaptureMode::TextCapture && msg != nullptr)
+    if(captureMode() == CaptureMode::TextCapture)
     {
+        const QScopedPointer<const ModbusMessage> msg(ui->logView->createMessage(index));
+        if(!msg) return;
+
         const auto str = QString("%1: %2 %3 %4").arg(
             (msg->isRequest()?  "Tx" : "Rx"),
             msg->timestamp().toString(Qt::ISODateWithMs),
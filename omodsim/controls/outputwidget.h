@@ -2,11 +2,13 @@
 #define OUTPUTWIDGET_H
 
 #include <QFile>
+#include <QTextStream>
 #include <QWidget>
 #include <QListWidgetItem>
 #include <QModbusReply>
 #include "enums.h"
 #include "modbusmessage.h"
+#include "modbustrafficlog.h"
 #include "datasimulator.h"
 #include "displaydefinition.h"
 
@@ -39,9 +41,13 @@ public:
     void clear();
     void update();
     void updateData(const QModbusDataUnit& data);
+    void updateValues(const QModbusDataUnit& data);
 
     QModelIndex find(QModbusDataUnit::RegisterType type, quint16 addr) const;
 
+private:
+    void updateRows(int first, int last);
+
 private:
     struct ItemData
     {
@@ -108,15 +114,16 @@ public:
     int logViewLimit() const;
     void setLogViewLimit(int l);
 
+    void setTrafficLog(ModbusTrafficLog* log);
+
     void setStatus(const QString& status);
     void setNotConnectedStatus();
     void setInvalidLengthStatus();
 
     void paint(const QRect& rc, QPainter& painter);
 
-    void updateTraffic(const QModbusRequest& request, int server, int transactionId, ModbusMessage::ProtocolType protocol);
-    void updateTraffic(const QModbusResponse& response, int server, int transactionId, ModbusMessage::ProtocolType protocol);
     void updateData(const QModbusDataUnit& data);
+    void updateValues(const QModbusDataUnit& data);
 
     AddressDescriptionMap descriptionMap() const;
     void setDescription(QModbusDataUnit::RegisterType type, quint16 addr, const QString& desc);
@@ -136,7 +143,7 @@ private slots:
 private:
     void captureString(const QString& s);
     void showModbusMessage(const QModelIndex& index);
-    void updateLogView(bool request, int deviceId, int transactionId, ModbusMessage::ProtocolType protocol, const QModbusPdu& pdu);
+    void captureModbusMessage(const QModelIndex& index);
 
 private:
     Ui::OutputWidget *ui;
@@ -148,8 +155,10 @@ private:
     ByteOrder _byteOrder;
     DisplayDefinition _displayDefinition;
     QFile _fileCapture;
+    QTextStream _captureStream;
     AddressDescriptionMap _descriptionMap;
     QSharedPointer<OutputListModel> _listModel;
+    QScopedPointer<const ModbusMessage> _modbusMessage;
 };
 
 #endif // OUTPUTWIDGET_H
@@ -24,7 +24,25 @@ ScriptControl::ScriptControl(QWidget *parent)
     }
     ui->helpWidget->setHelp(helpfile);
 
-    connect(&_timer, &QTimer::timeout, this, &ScriptControl::executeScript);
+    connect(&_timer, &SimulationTimer::timeout, this, &ScriptControl::executeScript);
+
+    // Date follows the simulation clock, dates built from explicit values are left as they are
+    auto clock = SimulationClock::instance();
+    QJSEngine::setObjectOwnership(clock, QJSEngine::CppOwnership);
+    const auto date = _jsEngine.evaluate(
+        "(function(clock) {\n"
+        "    const WallDate = Date;\n"
+        "    function SimulationDate(...args) {\n"
+        "        if(!new.target) return new WallDate(clock.currentMSecsSinceEpoch()).toString();\n"
+        "        return args.length ? new WallDate(...args) : new WallDate(clock.currentMSecsSinceEpoch());\n"
+        "    }\n"
+        "    SimulationDate.prototype = WallDate.prototype;\n"
+        "    SimulationDate.now = function() { return clock.currentMSecsSinceEpoch(); };\n"
+        "    SimulationDate.parse = WallDate.parse;\n"
+        "    SimulationDate.UTC = WallDate.UTC;\n"
+        "    return SimulationDate;\n"
+        "})");
+    _jsEngine.globalObject().setProperty("Date", date.call({ _jsEngine.newQObject(clock) }));
     connect(ui->codeEditor, &JSCodeEditor::helpContext, this, &ScriptControl::showHelp);
 }
 
@@ -45,6 +63,15 @@ void ScriptControl::setModbusMultiServer(ModbusMultiServer* server)
     _mbMultiServer = server;
 }
 
+///
+/// \brief ScriptControl::setDeviceId
+/// \param deviceId
+///
+void ScriptControl::setDeviceId(quint8 deviceId)
+{
+    _deviceId = deviceId;
+}
+
 ///
 /// \brief ScriptControl::setByteOrder
 /// \param order
@@ -100,6 +127,21 @@ void ScriptControl::setScript(const QString& text)
     ui->codeEditor->moveCursor(QTextCursor::End);
 }
 
+///
+/// \brief ScriptControl::restoreState
+/// \param state - script and splitter positions as stored in form files
+///
+void ScriptControl::restoreState(const QMap<QString, QVariant>& state)
+{
+    setScript(state["script"].toString());
+
+    const auto vstate = state["vsplitter"].toByteArray();
+    if(!vstate.isEmpty()) ui->verticalSplitter->restoreState(vstate);
+
+    const auto hstate = state["hsplitter"].toByteArray();
+    if(!hstate.isEmpty()) ui->horizontalSplitter->restoreState(hstate);
+}
+
 ///
 /// \brief ScriptControl::searchText
 /// \return
@@ -219,7 +261,7 @@ void ScriptControl::runScript(RunMode mode, int interval)
     _scriptCode = script();
 
     _storage = QSharedPointer<Storage>(new Storage);
-    _server = QSharedPointer<Server>(new Server(_mbMultiServer, _byteOrder, _addressBase));
+    _server = QSharedPointer<Server>(new Server(_mbMultiServer, _deviceId, _byteOrder, _addressBase));
     _script = QSharedPointer<Script>(new Script(interval));
     _console = QSharedPointer<console>(new console(ui->console));
     connect(_script.get(), &Script::stopped, this, &ScriptControl::stopScript, Qt::QueuedConnection);
@@ -364,13 +406,6 @@ QDataStream& operator >>(QDataStream& in, ScriptControl* ctrl)
     QMap<QString, QVariant> m;
     in >> m;
 
-    ctrl->setScript(m["script"].toString());
-
-    const auto vstate = m["vsplitter"].toByteArray();
-    if(!vstate.isEmpty()) ctrl->ui->verticalSplitter->restoreState(vstate);
-
-    const auto hstate = m["hsplitter"].toByteArray();
-    if(!hstate.isEmpty()) ctrl->ui->horizontalSplitter->restoreState(hstate);
-
+    ctrl->restoreState(m);
     return in;
 }
@@ -1,13 +1,13 @@
 #ifndef SCRIPTCONTROL_H
 #define SCRIPTCONTROL_H
 
-#include <QTimer>
 #include <QJSEngine>
 #include <QPlainTextEdit>
 #include "console.h"
 #include "script.h"
 #include "storage.h"
 #include "server.h"
+#include "simulationclock.h"
 
 namespace Ui {
 class ScriptControl;
@@ -30,6 +30,7 @@ public:
     ~ScriptControl();
 
     void setModbusMultiServer(ModbusMultiServer* server);
+    void setDeviceId(quint8 deviceId);
     void setByteOrder(const ByteOrder* order);
     void setAddressBase(AddressBase base);
 
@@ -38,6 +39,7 @@ public:
 
     QString script() const;
     void setScript(const QString& text);
+    void restoreState(const QMap<QString, QVariant>& state);
 
     QString searchText() const;
 
@@ -67,7 +69,7 @@ private slots:
 private:
     Ui::ScriptControl *ui;
 
-    QTimer _timer;
+    SimulationTimer _timer;
     QJSEngine _jsEngine;
     QString _scriptCode;
     QString _searchText;
@@ -77,6 +79,7 @@ private:
     QSharedPointer<Server> _server;
     QSharedPointer<console> _console;
 
+    quint8 _deviceId = 1;
     ByteOrder* _byteOrder = nullptr;
     AddressBase _addressBase = AddressBase::Base1;
     ModbusMultiServer* _mbMultiServer = nullptr;
@@ -48,6 +48,11 @@ void SimulationModeComboBox::setup(QModbusDataUnit::RegisterType type)
             addItem(tr("Random"), QVariant::fromValue(SimulationMode::Random));
             addItem(tr("Increment"), QVariant::fromValue(SimulationMode::Increment));
             addItem(tr("Decrement"), QVariant::fromValue(SimulationMode::Decrement));
+            addItem(tr("Sine"), QVariant::fromValue(SimulationMode::Sine));
+            addItem(tr("Square"), QVariant::fromValue(SimulationMode::Square));
+            addItem(tr("Triangle"), QVariant::fromValue(SimulationMode::Triangle));
+            addItem(tr("Sawtooth"), QVariant::fromValue(SimulationMode::Sawtooth));
+            addItem(tr("Exponential Decay"), QVariant::fromValue(SimulationMode::Exponential));
         break;
 
         default:
@@ -1,15 +1,100 @@
+#include <cmath>
+#include <tuple>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <QDeadlineTimer>
 #include <QRandomGenerator>
+#include "modbusmultiserver.h"
+#include "waveformutils.h"
 #include "datasimulator.h"
 
+///
+/// \brief modeValue
+/// \param type
+/// \param mode
+/// \param value
+/// \return value stored in the slot of the display mode type
+///
+static SimulationValue modeValue(QModbusDataUnit::RegisterType type, DataDisplayMode mode, double value)
+{
+    auto result = SimulationValue();
+    visitValueType(type, mode, [&](auto v) {
+        using T = decltype(v);
+        valueSlot<T>(result) = static_cast<T>(value);
+    });
+    return result;
+}
+
+///
+/// \brief saturate
+/// \param value
+/// \return value clamped to the limits of the type
+///
+template<typename T>
+T saturate(double value)
+{
+    if constexpr(std::is_integral<T>::value)
+    {
+        if(value >= double(std::numeric_limits<T>::max())) return std::numeric_limits<T>::max();
+        if(value <= double(std::numeric_limits<T>::lowest())) return std::numeric_limits<T>::lowest();
+    }
+
+    return static_cast<T>(value);
+}
+
+///
+/// \brief randomLimits
+/// \param range
+/// \return random value limits of the type, 16-bit values include the upper limit
+///
+template<typename T>
+QRange<double> randomLimits(const QRange<double>& range)
+{
+    if(sizeof(T) == sizeof(quint16))
+        return QRange<double>(range.from(), range.to() + 1);
+
+    return range;
+}
+
+template<typename T>
+T incrementValue(T value, T step, const QRange<double>& range)
+{
+    value = value + step;
+    if(value > range.to() || value < range.from()) value = static_cast<T>(range.from());
+    return value;
+}
+
+template<typename T>
+T decrementValue(T value, T step, const QRange<double>& range)
+{
+    value = value - step;
+    if(value > range.to() || value < range.from()) value = static_cast<T>(range.to());
+    return value;
+}
+
 ///
 /// \brief DataSimulator::DataSimulator
 /// \param server
+/// \param parent
 ///
-DataSimulator::DataSimulator(QObject* parent)
+DataSimulator::DataSimulator(ModbusMultiServer& server, QObject* parent)
     : QObject{parent}
-    ,_elapsed(0)
+    ,_server(server)
+    ,_clock(SimulationClock::instance())
 {
-    connect(&_timer, &QTimer::timeout, this, &DataSimulator::on_timeout);
+    qRegisterMetaType<SimulationBatch>("SimulationBatch");
+    qRegisterMetaType<ReplayParams>("ReplayParams");
+
+    // a faster, stopped or stepped clock moves the next due time
+    connect(_clock, &SimulationClock::changed, this, [this]
+    {
+        QMutexLocker locker(&_mutex);
+        _wakeUp.wakeOne();
+    }, Qt::DirectConnection);
+
+    _thread.reset(QThread::create([this]{ run(); }));
+    _thread->start(QThread::HighestPriority);
 }
 
 ///
@@ -18,49 +103,105 @@ DataSimulator::DataSimulator(QObject* parent)
 DataSimulator::~DataSimulator()
 {
     stopSimulations();
+
+    _mutex.lock();
+    _quit = true;
+    _wakeUp.wakeOne();
+    _mutex.unlock();
+
+    _thread->wait();
 }
 
 ///
 /// \brief DataSimulator::startSimulation
+/// \param deviceId
 /// \param mode
+/// \param order
 /// \param type
 /// \param addr
 /// \param params
 ///
-void DataSimulator::startSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, const ModbusSimulationParams& params)
+void DataSimulator::startSimulation(quint8 deviceId, DataDisplayMode mode, ByteOrder order, QModbusDataUnit::RegisterType type, quint16 addr, const ModbusSimulationParams& params)
 {
-    QVariant value;
+    QMutexLocker locker(&_mutex);
+
+    auto t = table(deviceId, type, true);
+    if(!t)
+        return;
+
+    auto idx = t->indexOf(addr);
+    if(idx < 0)
+    {
+        idx = t->insert(addr);
+        _simulationCount++;
+    }
+
+    const SimulationKey key = { deviceId, type, addr };
+    auto& generator = t->Generators[idx];
+    generator.seed(simulationSeed(key));
+
+    // increment and decrement start from the range limit at once, waveforms from their first sample
+    auto value = SimulationValue();
+    bool initialized = true;
     switch (params.Mode)
     {
         case SimulationMode::Increment:
-            value = params.IncrementParams.Range.from();
-            emit dataSimulated(mode, type, addr, value);
+            value = modeValue(type, mode, params.IncrementParams.Range.from());
         break;
 
         case SimulationMode::Decrement:
-            value = params.DecrementParams.Range.to();
-            emit dataSimulated(mode, type, addr, value);
+            value = modeValue(type, mode, params.DecrementParams.Range.to());
         break;
 
         default:
+            initialized = isWaveformMode(params.Mode);
+            if(initialized) waveformSimulation(mode, type, params, 0, 0., generator, &value, 1);
         break;
     }
 
-    _simulationMap[{ type, addr}] = { mode, params, value };
-    resumeSimulations();
+    t->Modes[idx] = mode;
+    t->Orders[idx] = order;
+    t->Params[idx] = params;
+    t->Values[idx] = value;
+    t->Ticks[idx] = 0;
+    t->Generations[idx] = ++_generation;
+    schedule(key, _generation, _clock->elapsed() + qMax(1U, params.Interval));
+
+    _paused = false;
+    _wakeUp.wakeOne();
+    locker.unlock();
 
-    emit simulationStarted(type, addr);
+    if(initialized)
+    {
+        const QVector<SimulationBatch> batches = { { deviceId, type, { addr }, { mode }, { order }, { value } } };
+        commit(batches);
+        emit dataSimulated(batches.first());
+    }
+
+    emit simulationStarted(deviceId, type, addr);
 }
 
 ///
 /// \brief DataSimulator::stopSimulation
+/// \param deviceId
 /// \param type
 /// \param addr
 ///
-void DataSimulator::stopSimulation(QModbusDataUnit::RegisterType type, quint16 addr)
+void DataSimulator::stopSimulation(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr)
 {
-    _simulationMap.remove({ type, addr});
-     emit simulationStopped(type, addr);
+    {
+        QMutexLocker locker(&_mutex);
+
+        auto t = table(deviceId, type);
+        const auto idx = t ? t->indexOf(addr) : -1;
+        if(idx >= 0)
+        {
+            t->remove(idx);
+            _simulationCount--;
+        }
+    }
+
+     emit simulationStopped(deviceId, type, addr);
 }
 
 ///
@@ -68,8 +209,113 @@ void DataSimulator::stopSimulation(QModbusDataUnit::RegisterType type, quint16 a
 ///
 void DataSimulator::stopSimulations()
 {
-    pauseSimulations();
-    _simulationMap.clear();
+    QMutexLocker locker(&_mutex);
+
+    _paused = true;
+    _devices.clear();
+    _rules.clear();
+    _simulationCount = 0;
+    _queue = {};
+}
+
+///
+/// \brief DataSimulator::startRangeSimulation
+/// \param mode
+/// \param order
+/// \param rule
+///
+void DataSimulator::startRangeSimulation(DataDisplayMode mode, ByteOrder order, const ModbusSimulationRule& rule)
+{
+    if(rule.Type < QModbusDataUnit::DiscreteInputs || rule.Type > QModbusDataUnit::HoldingRegisters || rule.Length == 0)
+        return;
+
+    stopRangeSimulation(rule.DeviceId, rule.Type, rule.Address, rule.Length);
+
+    QMutexLocker locker(&_mutex);
+
+    const SimulationKey key = { rule.DeviceId, rule.Type, rule.Address };
+    auto& r = _rules[key];
+    r = { mode, order, rule, 0, ++_generation, FastRandomGenerator(simulationSeed(key)) };
+    schedule(key, _generation, _clock->elapsed() + qMax(1U, rule.Params.Interval), true);
+
+    _paused = false;
+    _wakeUp.wakeOne();
+
+    // increment, decrement and waveforms start at once, like single points do
+    QVector<SimulationBatch> batches;
+    if(rule.Params.Mode == SimulationMode::Increment || rule.Params.Mode == SimulationMode::Decrement || isWaveformMode(rule.Params.Mode))
+    {
+        SimulationBatch batch;
+        batch.DeviceId = rule.DeviceId;
+        batch.Type = rule.Type;
+        simulate(batch, r);
+        batches.push_back(batch);
+    }
+    locker.unlock();
+
+    commit(batches);
+    for(auto&& batch : batches)
+        emit dataSimulated(batch);
+
+    emit rangeSimulationStarted(rule);
+}
+
+///
+/// \brief DataSimulator::stopRangeSimulation
+/// \param deviceId
+/// \param type
+/// \param addr
+/// \param length
+///
+void DataSimulator::stopRangeSimulation(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr, quint16 length)
+{
+    ModbusSimulationRules stopped;
+    {
+        QMutexLocker locker(&_mutex);
+        for(auto it = _rules.begin(); it != _rules.end();)
+        {
+            const auto& rule = it->Rule;
+            if(rule.DeviceId == deviceId && rule.Type == type && rule.Address < addr + length && addr < rule.Address + rule.Length)
+            {
+                stopped.push_back(rule);
+                it = _rules.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for(auto&& rule : stopped)
+        emit rangeSimulationStopped(rule);
+}
+
+///
+/// \brief DataSimulator::setByteOrder
+/// \param deviceId
+/// \param type
+/// \param addr
+/// \param length
+/// \param order - used for the simulations in the range from their next value on
+///
+void DataSimulator::setByteOrder(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr, quint16 length, ByteOrder order)
+{
+    QMutexLocker locker(&_mutex);
+
+    auto t = table(deviceId, type);
+    if(t)
+    {
+        const auto first = std::lower_bound(t->Addresses.cbegin(), t->Addresses.cend(), addr) - t->Addresses.cbegin();
+        const auto last = std::lower_bound(t->Addresses.cbegin(), t->Addresses.cend(), addr + length) - t->Addresses.cbegin();
+        std::fill(t->Orders.begin() + first, t->Orders.begin() + last, order);
+    }
+
+    for(auto&& r : _rules)
+    {
+        if(r.Rule.DeviceId == deviceId && r.Rule.Type == type && r.Rule.Address < addr + length && addr < r.Rule.Address + r.Rule.Length)
+            r.Order = order;
+    }
 }
 
 ///
@@ -77,7 +323,8 @@ void DataSimulator::stopSimulations()
 ///
 void DataSimulator::pauseSimulations()
 {
-    _timer.stop();
+    QMutexLocker locker(&_mutex);
+    _paused = true;
 }
 
 ///
@@ -85,8 +332,9 @@ void DataSimulator::pauseSimulations()
 ///
 void DataSimulator::resumeSimulations()
 {
-    if(!_timer.isActive())
-        _timer.start(_interval);
+    QMutexLocker locker(&_mutex);
+    _paused = false;
+    _wakeUp.wakeOne();
 }
 
 ///
@@ -94,295 +342,907 @@ void DataSimulator::resumeSimulations()
 ///
 void DataSimulator::restartSimulations()
 {
-    pauseSimulations();
-    for(auto&& key : _simulationMap.keys())
+    QMap<quint8, SimulationDevice> devices;
+    QList<SimulationRule> rules;
     {
-        const auto mode = _simulationMap[key].Mode;
-        const auto params = _simulationMap[key].Params;
-        startSimulation(mode, key.first, key.second, params);
+        QMutexLocker locker(&_mutex);
+        _paused = true;
+        devices = _devices;
+        rules = _rules.values();
+    }
+
+    for(auto&& r : rules)
+        startRangeSimulation(r.Mode, r.Order, r.Rule);
+
+    for(auto it = devices.cbegin(); it != devices.cend(); ++it)
+    {
+        for(int i = 0; i < QModbusDataUnit::HoldingRegisters; i++)
+        {
+            const auto type = QModbusDataUnit::RegisterType(QModbusDataUnit::DiscreteInputs + i);
+            const auto& t = it->Tables[i];
+            for(int j = 0; j < t.Addresses.size(); j++)
+                startSimulation(it.key(), t.Modes[j], t.Orders[j], type, t.Addresses[j], t.Params[j]);
+        }
     }
 }
 
 ///
 /// \brief DataSimulator::simulationParams
+/// \param deviceId
 /// \param type
 /// \param addr
 /// \return
 ///
-ModbusSimulationParams DataSimulator::simulationParams(QModbusDataUnit::RegisterType type, quint16 addr) const
+ModbusSimulationParams DataSimulator::simulationParams(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr) const
 {
-    const auto it = _simulationMap.find({type, addr});
-    return (it != _simulationMap.end()) ? it->Params : ModbusSimulationParams();
+    QMutexLocker locker(&_mutex);
+
+    const auto t = table(deviceId, type);
+    const auto idx = t ? t->indexOf(addr) : -1;
+    return (idx >= 0) ? t->Params[idx] : ModbusSimulationParams();
 }
 
 ///
 /// \brief DataSimulator::simulationMap
-/// \return
+/// \param deviceId
+/// \return simulated points of the unit
 ///
-ModbusSimulationMap DataSimulator::simulationMap() const
+ModbusSimulationMap DataSimulator::simulationMap(quint8 deviceId) const
 {
+    QMutexLocker locker(&_mutex);
+
     ModbusSimulationMap map;
-    for(auto&& key : _simulationMap.keys())
-        map[key] = _simulationMap[key].Params;
+    for(int i = 0; i < QModbusDataUnit::HoldingRegisters; i++)
+    {
+        const auto type = QModbusDataUnit::RegisterType(QModbusDataUnit::DiscreteInputs + i);
+        const auto t = table(deviceId, type);
+        for(int j = 0; t && j < t->Addresses.size(); j++)
+            map[{ type, t->Addresses[j] }] = t->Params[j];
+    }
 
     return map;
 }
 
 ///
-/// \brief DataSimulator::on_timeout
+/// \brief DataSimulator::simulationRules
+/// \return
+///
+ModbusSimulationRules DataSimulator::simulationRules() const
+{
+    QMutexLocker locker(&_mutex);
+
+    ModbusSimulationRules rules;
+    for(auto&& r : _rules)
+        rules.push_back(r.Rule);
+
+    return rules;
+}
+
+///
+/// \brief DataSimulator::startReplay
+/// \param params
+/// \param errorString
+/// \return false if the recording can not be read
 ///
-void DataSimulator::on_timeout()
+bool DataSimulator::startReplay(const ReplayParams& params, QString* errorString)
 {
-    _elapsed++;
-    for(auto&& key : _simulationMap.keys())
+    QScopedPointer<ReplayFile> file(ReplayFile::open(params.FileName, errorString));
+    if(!file)
+        return false;
+
+    ReplayFrame frame;
+    if(!file->readFrame(frame))
     {
-        const auto mode = _simulationMap[key].Mode;
-        const auto params = _simulationMap[key].Params;
-        const auto interval = params.Interval;
+        if(errorString) *errorString = tr("No frames to replay");
+        return false;
+    }
 
-        if(_elapsed % interval) continue;
+    stopReplay();
 
-        switch(params.Mode)
-        {
-            case SimulationMode::Random:
-                randomSimulation(mode, key.first, key.second, params.RandomParams);
-            break;
+    // columns in device, table and address order give contiguous batches
+    const auto& columns = file->columns();
+    QVector<int> order(columns.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&columns](int a, int b) {
+        return std::make_tuple(columns[a].DeviceId, columns[a].Type, columns[a].Address) <
+               std::make_tuple(columns[b].DeviceId, columns[b].Type, columns[b].Address);
+    });
 
-            case SimulationMode::Increment:
-                incrementSimulation(mode, key.first, key.second, params.IncrementParams);
-            break;
+    {
+        QMutexLocker locker(&_mutex);
 
-            case SimulationMode::Decrement:
-                decrementSimailation(mode, key.first, key.second, params.DecrementParams);
-            break;
+        _replay.reset(file.take());
+        _replayParams = params;
+        if(_replayParams.Rate <= 0.) _replayParams.Rate = 1.;
 
-            case SimulationMode::Toggle:
-                toggleSimulation(key.first, key.second);
-            break;
+        _replayFrame = frame;
+        _replayValues.fill(std::numeric_limits<double>::quiet_NaN(), columns.size());
+        _replayOrder = order;
+        _replayStart = _clock->elapsed();
+        _replayOrigin = frame.Timestamp;
+        _replayPeriod = 0;
 
-            default:
-            break;
-        }
+        _paused = false;
+        _wakeUp.wakeOne();
     }
+
+    emit replayStarted(params);
+    return true;
 }
 
+///
+/// \brief DataSimulator::stopReplay
+///
+void DataSimulator::stopReplay()
+{
+    ReplayParams params;
+    {
+        QMutexLocker locker(&_mutex);
+        if(!_replay)
+            return;
+
+        _replay.reset();
+        params = _replayParams;
+    }
 
-template<typename T>
-T generateRandom(double from, double to)
+    emit replayStopped(params);
+}
+
+///
+/// \brief DataSimulator::isReplaying
+/// \return
+///
+bool DataSimulator::isReplaying() const
 {
-    return static_cast<T>(from + QRandomGenerator::global()->bounded(to - from));
+    QMutexLocker locker(&_mutex);
+    return !_replay.isNull();
 }
 
-template<typename T>
-T generateRandom(const QRange<double>& range)
+///
+/// \brief DataSimulator::replayParams
+/// \return parameters of the running replay
+///
+ReplayParams DataSimulator::replayParams() const
 {
-    return generateRandom<T>(range.from(), range.to());
+    QMutexLocker locker(&_mutex);
+    return _replayParams;
 }
 
 ///
-/// \brief DataSimulator::randomSimulation
+/// \brief DataSimulator::randomSeed
+/// \param id - form that set the seed
+/// \return seed of the random simulations of the form, 0 if they are not reproducible
+///
+quint64 DataSimulator::randomSeed(int id) const
+{
+    QMutexLocker locker(&_mutex);
+    return _seeds.value(id).Seed;
+}
+
+///
+/// \brief DataSimulator::setRandomSeed
+/// \param id - form that sets the seed
+/// \param deviceId
 /// \param type
 /// \param addr
-/// \param params
+/// \param length
+/// \param seed - 0 seeds every simulation of the range randomly
+///
+void DataSimulator::setRandomSeed(int id, quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr, quint16 length, quint64 seed)
+{
+    QMutexLocker locker(&_mutex);
+
+    const SeedRegion region = { deviceId, type, addr, length, seed };
+    if(seed != 0) _seeds[id] = region;
+    else _seeds.remove(id);
+
+    // running simulations of the range continue with the sequence of the new seed
+    reseed(region);
+}
+
+///
+/// \brief DataSimulator::moveRandomSeed
+/// \param id - form that set the seed
+/// \param deviceId
+/// \param type
+/// \param addr
+/// \param length
+///
+void DataSimulator::moveRandomSeed(int id, quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr, quint16 length)
+{
+    QMutexLocker locker(&_mutex);
+
+    const auto it = _seeds.find(id);
+    if(it == _seeds.end())
+        return;
+
+    const SeedRegion previous = it.value();
+    *it = { deviceId, type, addr, length, previous.Seed };
+
+    // simulations that were seeded by the form already keep running, only the ones it gained start over
+    reseed(*it, &previous);
+}
+
 ///
-void DataSimulator::randomSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, const RandomSimulationParams& params)
+/// \brief DataSimulator::removeRandomSeed
+/// \param id - form that set the seed, its simulations keep their sequences
+///
+void DataSimulator::removeRandomSeed(int id)
 {
-    auto&& value = _simulationMap[{ type, addr}].CurrentValue;
-    switch(type)
+    QMutexLocker locker(&_mutex);
+    _seeds.remove(id);
+}
+
+///
+/// \brief DataSimulator::reseed
+/// \param region - simulations that start over with their seeds, called with the lock held
+/// \param seeded - simulations that are skipped, nullptr if none
+///
+void DataSimulator::reseed(const SeedRegion& region, const SeedRegion* seeded)
+{
+    const auto overlaps = [](const SeedRegion* r, quint8 deviceId, QModbusDataUnit::RegisterType type, int addr, int length)
     {
-        case QModbusDataUnit::Coils:
-        case QModbusDataUnit::DiscreteInputs:
-            value = generateRandom<quint16>(params.Range.from(), params.Range.to() + 1);
-        break;
+        return r && r->DeviceId == deviceId && r->Type == type &&
+               addr < r->Address + r->Length && r->Address < addr + length;
+    };
 
-        case QModbusDataUnit::HoldingRegisters:
-        case QModbusDataUnit::InputRegisters:
-            switch(mode)
-            {
-                case DataDisplayMode::Binary:
-                case DataDisplayMode::Integer:
-                case DataDisplayMode::Decimal:
-                case DataDisplayMode::Hex:
-                    value = generateRandom<quint16>(params.Range.from(), params.Range.to() + 1);
-                break;
-                    
-                case DataDisplayMode::Int32:
-                case DataDisplayMode::SwappedInt32:
-                    value = generateRandom<qint32>(params.Range);
-                break;
-
-                case DataDisplayMode::UInt32:
-                case DataDisplayMode::SwappedUInt32:
-                    value = generateRandom<quint32>(params.Range);
-                break;
-
-                case DataDisplayMode::FloatingPt:
-                case DataDisplayMode::SwappedFP:
-                   value = generateRandom<float>(params.Range);
-                break;
-
-                case DataDisplayMode::DblFloat:
-                case DataDisplayMode::SwappedDbl:
-                   value = generateRandom<double>(params.Range);
-                break;
-
-                case DataDisplayMode::Int64:
-                case DataDisplayMode::SwappedInt64:
-                    value = generateRandom<qint64>(params.Range);
-                    break;
-
-                case DataDisplayMode::UInt64:
-                case DataDisplayMode::SwappedUInt64:
-                    value = generateRandom<quint64>(params.Range);
-                break;
-            }
-        break;
+    auto t = table(region.DeviceId, region.Type);
+    for(int i = 0; t && i < t->Addresses.size(); i++)
+    {
+        const int addr = t->Addresses[i];
+        if(overlaps(&region, region.DeviceId, region.Type, addr, 1) && !overlaps(seeded, region.DeviceId, region.Type, addr, 1))
+            t->Generators[i].seed(simulationSeed({ region.DeviceId, region.Type, t->Addresses[i] }));
+    }
 
-        default:
-        break;
+    for(auto it = _rules.begin(); it != _rules.end(); ++it)
+    {
+        const auto& rule = it->Rule;
+        if(overlaps(&region, rule.DeviceId, rule.Type, rule.Address, rule.Length) &&
+           !overlaps(seeded, rule.DeviceId, rule.Type, rule.Address, rule.Length))
+        {
+            it->Generator.seed(simulationSeed(it.key()));
+        }
+    }
+}
+
+///
+/// \brief DataSimulator::simulationSeed
+/// \param key
+/// \return seed of the simulation at the address, called with the lock held
+///
+quint64 DataSimulator::simulationSeed(const SimulationKey& key) const
+{
+    // the seed of the form that shows the simulation, the first one where forms overlap
+    quint64 seed = 0;
+    for(auto&& region : _seeds)
+    {
+        if(region.DeviceId == key.DeviceId && region.Type == key.Type &&
+           key.Address >= region.Address && key.Address < region.Address + region.Length)
+        {
+            seed = region.Seed;
+            break;
+        }
     }
 
-    if(value.isValid())
-        emit dataSimulated(mode, type, addr, value);
+    if(seed == 0)
+        return QRandomGenerator::global()->generate64();
+
+    // every simulation has its own sequence, independent of the order they were started in
+    return seed ^ ((quint64(key.DeviceId) << 24 | quint64(key.Type) << 16 | key.Address) * 0x9E3779B97F4A7C15ULL);
 }
 
-template<typename T>
-T incrementValue(T value, T step, const QRange<double>& range)
+///
+/// \brief DataSimulator::table
+/// \param deviceId
+/// \param type
+/// \param create - add the table of a unit without simulations
+/// \return simulated points of the register table, called with the lock held
+///
+DataSimulator::SimulationTable* DataSimulator::table(quint8 deviceId, QModbusDataUnit::RegisterType type, bool create)
 {
-    value = value + step;
-    if(value > range.to() || value < range.from()) value = static_cast<T>(range.from());
-    return value;
+    if(type < QModbusDataUnit::DiscreteInputs || type > QModbusDataUnit::HoldingRegisters)
+        return nullptr;
+
+    auto it = _devices.find(deviceId);
+    if(it == _devices.end())
+    {
+        if(!create) return nullptr;
+        it = _devices.insert(deviceId, SimulationDevice());
+    }
+
+    return &it->Tables[type - QModbusDataUnit::DiscreteInputs];
 }
 
 ///
-/// \brief DataSimulator::incrementSimulation
+/// \brief DataSimulator::table
+/// \param deviceId
 /// \param type
+/// \return simulated points of the register table or nullptr, called with the lock held
+///
+const DataSimulator::SimulationTable* DataSimulator::table(quint8 deviceId, QModbusDataUnit::RegisterType type) const
+{
+    if(type < QModbusDataUnit::DiscreteInputs || type > QModbusDataUnit::HoldingRegisters)
+        return nullptr;
+
+    const auto it = _devices.constFind(deviceId);
+    return (it != _devices.constEnd()) ? &it->Tables[type - QModbusDataUnit::DiscreteInputs] : nullptr;
+}
+
+///
+/// \brief DataSimulator::SimulationTable::indexOf
 /// \param addr
-/// \param params
+/// \return index of the point or -1 if the address is not simulated
+///
+int DataSimulator::SimulationTable::indexOf(quint16 addr) const
+{
+    const auto it = std::lower_bound(Addresses.cbegin(), Addresses.cend(), addr);
+    return (it != Addresses.cend() && *it == addr) ? int(it - Addresses.cbegin()) : -1;
+}
+
+///
+/// \brief DataSimulator::SimulationTable::insert
+/// \param addr
+/// \return index of the inserted point
+///
+int DataSimulator::SimulationTable::insert(quint16 addr)
+{
+    const auto idx = int(std::lower_bound(Addresses.cbegin(), Addresses.cend(), addr) - Addresses.cbegin());
+    Addresses.insert(idx, addr);
+    Modes.insert(idx, DataDisplayMode::Decimal);
+    Orders.insert(idx, ByteOrder::LittleEndian);
+    Params.insert(idx, ModbusSimulationParams());
+    Values.insert(idx, SimulationValue());
+    Ticks.insert(idx, 0);
+    Generators.insert(idx, FastRandomGenerator());
+    Generations.insert(idx, 0);
+
+    return idx;
+}
+
+///
+/// \brief DataSimulator::SimulationTable::remove
+/// \param idx
+///
+void DataSimulator::SimulationTable::remove(int idx)
+{
+    Addresses.remove(idx);
+    Modes.remove(idx);
+    Orders.remove(idx);
+    Params.remove(idx);
+    Values.remove(idx);
+    Ticks.remove(idx);
+    Generators.remove(idx);
+    Generations.remove(idx);
+}
+
+///
+/// \brief DataSimulator::SimulationTable::clear
+///
+void DataSimulator::SimulationTable::clear()
+{
+    Addresses.clear();
+    Modes.clear();
+    Orders.clear();
+    Params.clear();
+    Values.clear();
+    Ticks.clear();
+    Generators.clear();
+    Generations.clear();
+}
+
 ///
-void DataSimulator::incrementSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, const IncrementSimulationParams& params)
+/// \brief DataSimulator::schedule
+/// \param key
+/// \param generation
+/// \param due - clock time in milliseconds
+/// \param range - key of a range simulation rule
+///
+void DataSimulator::schedule(const SimulationKey& key, quint32 generation, qint64 due, bool range)
 {
-    auto&& value = _simulationMap[{ type, addr}].CurrentValue;
-    switch(mode)
+    // drop entries of stopped simulations once they outnumber the live ones
+    const auto count = size_t(_simulationCount + _rules.size());
+    if(_queue.size() > 2 * count + 64)
     {
-        case DataDisplayMode::Integer:
-            value = incrementValue<qint16>(value.toInt(), params.Step, params.Range);
-        break;
+        std::vector<ScheduledSimulation> entries;
+        entries.reserve(count);
+        for(; !_queue.empty(); _queue.pop())
+        {
+            if(isScheduled(_queue.top()))
+                entries.push_back(_queue.top());
+        }
+        _queue = decltype(_queue)(std::greater<ScheduledSimulation>(), std::move(entries));
+    }
 
-        case DataDisplayMode::Binary:
-        case DataDisplayMode::Decimal:
-        case DataDisplayMode::Hex:
-            value = incrementValue<quint16>(value.toUInt(), params.Step, params.Range);
-        break;
-            
-        case DataDisplayMode::Int32:
-        case DataDisplayMode::SwappedInt32:
-            value = incrementValue<qint32>(value.toInt(),  params.Step, params.Range);
-        break;
+    _queue.push({ due, key, generation, range });
+}
 
-        case DataDisplayMode::UInt32:
-        case DataDisplayMode::SwappedUInt32:
-            value = incrementValue<quint32>(value.toUInt(),  params.Step, params.Range);
-        break;
+///
+/// \brief DataSimulator::isScheduled
+/// \param entry
+/// \return true if the entry belongs to a running simulation
+///
+bool DataSimulator::isScheduled(const ScheduledSimulation& entry) const
+{
+    if(entry.Range)
+    {
+        const auto it = _rules.constFind(entry.Key);
+        return it != _rules.constEnd() && it->Generation == entry.Generation;
+    }
 
-        case DataDisplayMode::FloatingPt:
-        case DataDisplayMode::SwappedFP:
-            value = incrementValue<float>(value.toFloat(), params.Step, params.Range);
-        break;
+    const auto t = table(entry.Key.DeviceId, entry.Key.Type);
+    const auto idx = t ? t->indexOf(entry.Key.Address) : -1;
+    return idx >= 0 && t->Generations[idx] == entry.Generation;
+}
 
-        case DataDisplayMode::DblFloat:
-        case DataDisplayMode::SwappedDbl:
-            value = incrementValue<double>(value.toDouble(), params.Step, params.Range);
-        break;
+///
+/// \brief DataSimulator::run - worker thread loop
+///
+void DataSimulator::run()
+{
+    QMutexLocker locker(&_mutex);
+    while(!_quit)
+    {
+        const auto due = nextDue();
+        if(_paused || due < 0)
+        {
+            _wakeUp.wait(&_mutex);
+            continue;
+        }
 
-        case DataDisplayMode::Int64:
-        case DataDisplayMode::SwappedInt64:
-            value = incrementValue<qint64>(value.toLongLong(), params.Step, params.Range);
-            break;
+        const auto wait = _clock->remainingTime(due);
+        if(wait < 0)
+        {
+            _wakeUp.wait(&_mutex);
+            continue;
+        }
 
-        case DataDisplayMode::UInt64:
-        case DataDisplayMode::SwappedUInt64:
-            value = incrementValue<quint64>(value.toULongLong(), params.Step, params.Range);
-        break;
+        if(wait > 0)
+        {
+            _wakeUp.wait(&_mutex, QDeadlineTimer(wait, Qt::PreciseTimer));
+            continue;
+        }
+
+        bool replayFinished;
+        const auto batches = simulateDue();
+        const auto replayBatches = replayDue(replayFinished);
+        const auto replayParams = _replayParams;
+        locker.unlock();
+
+        commit(batches);
+        for(auto&& batch : batches)
+            emit dataSimulated(batch);
+
+        commit(replayBatches);
+        for(auto&& batch : replayBatches)
+            emit dataSimulated(batch);
+
+        if(replayFinished)
+            emit replayStopped(replayParams);
+
+        locker.relock();
+    }
+}
+
+///
+/// \brief DataSimulator::nextDue
+/// \return clock time of the next simulation or replay frame, -1 if there is none, called with the lock held
+///
+qint64 DataSimulator::nextDue() const
+{
+    qint64 due = _queue.empty() ? -1 : _queue.top().Due;
+    if(_replay)
+    {
+        const auto frameDue = replayFrameDue(_replayFrame);
+        due = (due < 0) ? frameDue : qMin(due, frameDue);
     }
 
-    if(value.isValid())
-        emit dataSimulated(mode, type, addr, value);
+    return due;
 }
 
-template<typename T>
-T decrementValue(T value, T step, const QRange<double>& range)
+///
+/// \brief DataSimulator::commit
+/// \param batches - every batch is written once, into the registers of its unit
+///
+void DataSimulator::commit(const QVector<SimulationBatch>& batches)
 {
-    value = value - step;
-    if(value > range.to() || value < range.from()) value = static_cast<T>(range.to());
-    return value;
+    for(auto&& batch : batches)
+    {
+        // values are encoded straight into register words, every contiguous run is one write
+        int startAddress = 0;
+        QVector<quint16> values;
+        values.reserve(4 * batch.Addresses.size());
+
+        for(int i = 0; i < batch.Addresses.size(); i++)
+        {
+            const int addr = batch.Addresses[i];
+            if(!values.isEmpty() && addr - startAddress > values.size())
+            {
+                _server.setData(batch.DeviceId, QModbusDataUnit(batch.Type, startAddress, values));
+                values.clear();
+            }
+
+            if(values.isEmpty())
+                startAddress = addr;
+
+            quint16 words[4];
+            const int pos = addr - startAddress;
+            const int count = encodeSimulationValue(batch.Type, batch.Modes[i], batch.Values[i], batch.Orders[i], words);
+            if(values.size() < pos + count)
+                values.resize(pos + count);
+
+            std::copy(words, words + count, values.begin() + pos);
+        }
+
+        if(!values.isEmpty())
+            _server.setData(batch.DeviceId, QModbusDataUnit(batch.Type, startAddress, values));
+    }
 }
 
 ///
-/// \brief DataSimulator::decrementSimailation
-/// \param type
-/// \param addr
-/// \param params
+/// \brief DataSimulator::simulateDue
+/// \return values of all due simulations, called with the lock held
 ///
-void DataSimulator::decrementSimailation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, const DecrementSimulationParams& params)
+QVector<SimulationBatch> DataSimulator::simulateDue()
 {
-    auto&& value = _simulationMap[{ type, addr}].CurrentValue;
-    switch(mode)
+    QVector<SimulationBatch> batches;
+    QMap<QPair<quint8, QModbusDataUnit::RegisterType>, QVector<int>> points;
+
+    // on a virtual clock every tick is simulated, one clock instant per pass
+    const bool realTime = _clock->isRealTime();
+    auto now = _clock->elapsed();
+    if(!realTime && !_queue.empty())
+        now = qMin(now, _queue.top().Due);
+
+    while(!_queue.empty() && _queue.top().Due <= now)
     {
-        case DataDisplayMode::Integer:
-            value = decrementValue<qint16>(value.toInt(), params.Step, params.Range);
-        break;
+        const auto entry = _queue.top();
+        _queue.pop();
+
+        if(!isScheduled(entry))
+            continue;
 
-        case DataDisplayMode::Binary:
-        case DataDisplayMode::Decimal:
-        case DataDisplayMode::Hex:
-            value = decrementValue<quint16>(value.toUInt(), params.Step, params.Range);
+        const auto t = table(entry.Key.DeviceId, entry.Key.Type);
+        const auto idx = entry.Range ? -1 : t->indexOf(entry.Key.Address);
+        const qint64 interval = qMax(1U, entry.Range ? _rules[entry.Key].Rule.Params.Interval : t->Params[idx].Interval);
+
+        // keep the cadence, but do not try to catch up on ticks missed in real time
+        auto due = entry.Due + interval;
+        if(realTime && due <= now) due += ((now - due) / interval + 1) * interval;
+        schedule(entry.Key, entry.Generation, due, entry.Range);
+
+        if(entry.Range)
+        {
+            auto& rule = _rules[entry.Key];
+            rule.Tick++;
+
+            SimulationBatch batch;
+            batch.DeviceId = entry.Key.DeviceId;
+            batch.Type = entry.Key.Type;
+            simulate(batch, rule);
+            batches.push_back(batch);
+        }
+        else
+        {
+            points[{ entry.Key.DeviceId, entry.Key.Type }].push_back(idx);
+        }
+    }
+
+    // single points come after the ranges, so they win where both overlap
+    for(auto it = points.cbegin(); it != points.cend(); ++it)
+    {
+        SimulationBatch batch;
+        batch.DeviceId = it.key().first;
+        batch.Type = it.key().second;
+        simulate(batch, *table(batch.DeviceId, batch.Type), it.value());
+        batches.push_back(batch);
+    }
+
+    return batches;
+}
+
+///
+/// \brief DataSimulator::replayFrameDue
+/// \param frame
+/// \return clock time the frame is due, called with the lock held
+///
+qint64 DataSimulator::replayFrameDue(const ReplayFrame& frame) const
+{
+    return _replayStart + qint64((frame.Timestamp - _replayOrigin) / _replayParams.Rate);
+}
+
+///
+/// \brief DataSimulator::replayDue
+/// \param finished - set when the recording is over
+/// \return values of all due frames merged per device and table, called with the lock held
+///
+QVector<SimulationBatch> DataSimulator::replayDue(bool& finished)
+{
+    finished = false;
+    if(!_replay)
+        return {};
+
+    bool updated = false;
+    const auto now = _clock->elapsed();
+    while(replayFrameDue(_replayFrame) <= now)
+    {
+        for(int i = 0; i < _replayValues.size() && i < _replayFrame.Values.size(); i++)
+        {
+            if(!std::isnan(_replayFrame.Values[i]))
+                _replayValues[i] = _replayFrame.Values[i];
+        }
+        updated = true;
+
+        const auto due = replayFrameDue(_replayFrame);
+        const auto timestamp = _replayFrame.Timestamp;
+        if(_replay->readFrame(_replayFrame))
+        {
+            _replayPeriod = qMax<qint64>(0, _replayFrame.Timestamp - timestamp);
+            continue;
+        }
+
+        _replay->rewind();
+        if(!_replayParams.Loop || !_replay->readFrame(_replayFrame))
+        {
+            finished = true;
+            break;
+        }
+
+        // the next loop starts one frame period after the last frame
+        _replayOrigin = _replayFrame.Timestamp;
+        _replayStart = due + qint64(_replayPeriod / _replayParams.Rate);
+    }
+
+    QVector<SimulationBatch> batches;
+    if(updated)
+    {
+        const auto& columns = _replay->columns();
+        for(auto&& i : _replayOrder)
+        {
+            const auto value = _replayValues[i];
+            if(std::isnan(value))
+                continue;
+
+            const auto& c = columns[i];
+            if(batches.isEmpty() || batches.last().DeviceId != c.DeviceId || batches.last().Type != c.Type)
+            {
+                SimulationBatch b;
+                b.DeviceId = c.DeviceId;
+                b.Type = c.Type;
+                batches.push_back(b);
+            }
+
+            auto& batch = batches.last();
+            batch.Addresses.push_back(c.Address);
+            batch.Modes.push_back(c.Mode);
+            batch.Orders.push_back(_replayParams.Order);
+            batch.Values.push_back(modeValue(c.Type, c.Mode, value));
+        }
+
+        _replayValues.fill(std::numeric_limits<double>::quiet_NaN());
+    }
+
+    if(finished)
+        _replay.reset();
+
+    return batches;
+}
+
+///
+/// \brief DataSimulator::simulate
+/// \param batch
+/// \param rule - every point of the range is computed from the tick count and its phase
+///
+void DataSimulator::simulate(SimulationBatch& batch, SimulationRule& rule)
+{
+    const auto& params = rule.Rule.Params;
+    const auto size = simulationRegisterCount(rule.Rule.Type, rule.Mode);
+    const auto count = rule.Rule.Length / size;
+
+    batch.Addresses.resize(count);
+    batch.Modes.fill(params.Mode == SimulationMode::Toggle ? DataDisplayMode::Binary : rule.Mode, count);
+    batch.Orders.fill(rule.Order, count);
+    batch.Values.resize(count);
+
+    for(int i = 0; i < count; i++)
+        batch.Addresses[i] = rule.Rule.Address + i * size;
+
+    switch(params.Mode)
+    {
+        case SimulationMode::Random:
+            visitValueType(rule.Rule.Type, rule.Mode, [&](auto v) {
+                using T = decltype(v);
+                const auto limits = randomLimits<T>(params.RandomParams.Range);
+
+                QVector<double> samples(count);
+                rule.Generator.fillRange(samples.data(), count, limits.from(), limits.to());
+                for(int i = 0; i < count; i++)
+                    valueSlot<T>(batch.Values[i]) = static_cast<T>(samples[i]);
+            });
         break;
-            
-        case DataDisplayMode::Int32:
-        case DataDisplayMode::SwappedInt32:
-            value = decrementValue<qint32>(value.toInt(),  params.Step, params.Range);
+
+        case SimulationMode::Increment:
+        case SimulationMode::Decrement:
+        {
+            const auto& range = (params.Mode == SimulationMode::Increment) ? params.IncrementParams.Range : params.DecrementParams.Range;
+            const auto step = (params.Mode == SimulationMode::Increment) ? params.IncrementParams.Step : -params.DecrementParams.Step;
+            const auto origin = (params.Mode == SimulationMode::Increment) ? range.from() : range.to();
+
+            // number of values before the simulation wraps around to its origin
+            const auto steps = (step != 0.) ? std::floor((range.to() - range.from()) / std::abs(step)) + 1. : 1.;
+            visitValueType(rule.Rule.Type, rule.Mode, [&](auto v) {
+                using T = decltype(v);
+                for(int i = 0; i < count; i++)
+                {
+                    const auto n = std::fmod(std::floor(rule.Tick + i * rule.Rule.PhaseOffset), steps);
+                    valueSlot<T>(batch.Values[i]) = static_cast<T>(origin + (n < 0 ? n + steps : n) * step);
+                }
+            });
+        }
         break;
 
-        case DataDisplayMode::UInt32:
-        case DataDisplayMode::SwappedUInt32:
-            value = decrementValue<quint32>(value.toUInt(),  params.Step, params.Range);
+        case SimulationMode::Toggle:
+            for(int i = 0; i < count; i++)
+                batch.Values[i].UInt16 = quint16(qint64(std::floor(rule.Tick + i * rule.Rule.PhaseOffset)) & 1);
         break;
 
-        case DataDisplayMode::FloatingPt:
-        case DataDisplayMode::SwappedFP:
-            value = decrementValue<float>(value.toFloat(), params.Step, params.Range);
+        case SimulationMode::Sine:
+        case SimulationMode::Square:
+        case SimulationMode::Triangle:
+        case SimulationMode::Sawtooth:
+        case SimulationMode::Exponential:
+            waveformSimulation(rule.Mode, rule.Rule.Type, params, rule.Tick, rule.Rule.PhaseOffset, rule.Generator, batch.Values.data(), count);
         break;
 
-        case DataDisplayMode::DblFloat:
-        case DataDisplayMode::SwappedDbl:
-            value = decrementValue<double>(value.toDouble(), params.Step, params.Range);
+        default:
+            batch.Addresses.clear();
+            batch.Modes.clear();
+            batch.Orders.clear();
+            batch.Values.clear();
         break;
+    }
+}
+
+///
+/// \brief DataSimulator::simulate
+/// \param batch
+/// \param table
+/// \param points - indexes of the due points
+///
+void DataSimulator::simulate(SimulationBatch& batch, SimulationTable& table, const QVector<int>& points)
+{
+    // the table is sorted by address, so sorted indexes give the batch in address order
+    auto indexes = points;
+    std::sort(indexes.begin(), indexes.end());
+
+    batch.Addresses.reserve(indexes.size());
+    batch.Modes.reserve(indexes.size());
+    batch.Orders.reserve(indexes.size());
+    batch.Values.reserve(indexes.size());
 
-        case DataDisplayMode::Int64:
-        case DataDisplayMode::SwappedInt64:
-            value = decrementValue<qint64>(value.toLongLong(), params.Step, params.Range);
+    for(auto&& idx : indexes)
+    {
+        const auto mode = table.Modes[idx];
+        const auto& params = table.Params[idx];
+        auto& value = table.Values[idx];
+
+        switch(params.Mode)
+        {
+            case SimulationMode::Random:
+                randomSimulation(mode, batch.Type, params.RandomParams, table.Generators[idx], value);
             break;
 
-        case DataDisplayMode::UInt64:
-        case DataDisplayMode::SwappedUInt64:
-            value = decrementValue<quint64>(value.toULongLong(), params.Step, params.Range);
-        break;
+            case SimulationMode::Increment:
+                incrementSimulation(mode, batch.Type, params.IncrementParams, value);
+            break;
+
+            case SimulationMode::Decrement:
+                decrementSimailation(mode, batch.Type, params.DecrementParams, value);
+            break;
+
+            case SimulationMode::Toggle:
+                toggleSimulation(value);
+            break;
+
+            case SimulationMode::Sine:
+            case SimulationMode::Square:
+            case SimulationMode::Triangle:
+            case SimulationMode::Sawtooth:
+            case SimulationMode::Exponential:
+                waveformSimulation(mode, batch.Type, params, ++table.Ticks[idx], 0., table.Generators[idx], &value, 1);
+            break;
+
+            default:
+            continue;
+        }
+
+        batch.Addresses.push_back(table.Addresses[idx]);
+        batch.Modes.push_back(params.Mode == SimulationMode::Toggle ? DataDisplayMode::Binary : mode);
+        batch.Orders.push_back(table.Orders[idx]);
+        batch.Values.push_back(value);
     }
+}
 
-    if(value.isValid())
-        emit dataSimulated(mode, type, addr, value);
+///
+/// \brief DataSimulator::randomSimulation
+/// \param mode
+/// \param type
+/// \param params
+/// \param generator
+/// \param value
+///
+void DataSimulator::randomSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, const RandomSimulationParams& params, FastRandomGenerator& generator, SimulationValue& value)
+{
+    visitValueType(type, mode, [&](auto v) {
+        using T = decltype(v);
+        const auto limits = randomLimits<T>(params.Range);
+        valueSlot<T>(value) = static_cast<T>(limits.from() + generator.bounded(limits.to() - limits.from()));
+    });
+}
+
+///
+/// \brief DataSimulator::incrementSimulation
+/// \param mode
+/// \param type
+/// \param params
+/// \param value
+///
+void DataSimulator::incrementSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, const IncrementSimulationParams& params, SimulationValue& value)
+{
+    visitValueType(type, mode, [&](auto v) {
+        using T = decltype(v);
+        auto& slot = valueSlot<T>(value);
+        slot = incrementValue<T>(slot, static_cast<T>(params.Step), params.Range);
+    });
+}
+
+///
+/// \brief DataSimulator::decrementSimailation
+/// \param mode
+/// \param type
+/// \param params
+/// \param value
+///
+void DataSimulator::decrementSimailation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, const DecrementSimulationParams& params, SimulationValue& value)
+{
+    visitValueType(type, mode, [&](auto v) {
+        using T = decltype(v);
+        auto& slot = valueSlot<T>(value);
+        slot = decrementValue<T>(slot, static_cast<T>(params.Step), params.Range);
+    });
 }
 
 ///
 /// \brief DataSimulator::toggleSimulation
+/// \param value
+///
+void DataSimulator::toggleSimulation(SimulationValue& value)
+{
+    value.UInt16 = !value.UInt16;
+}
+
+///
+/// \brief DataSimulator::waveformSimulation
+/// \param mode
 /// \param type
-/// \param addr
+/// \param params
+/// \param tick - number of intervals since the simulation started
+/// \param phaseOffset - intervals each value is ahead of the previous one
+/// \param generator - noise source
+/// \param values
+/// \param count
 ///
-void DataSimulator::toggleSimulation(QModbusDataUnit::RegisterType type, quint16 addr)
+void DataSimulator::waveformSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, const ModbusSimulationParams& params, quint64 tick, double phaseOffset, FastRandomGenerator& generator, SimulationValue* values, int count)
 {
-    auto&& value = _simulationMap[{ type, addr}].CurrentValue;
-    value = !value.toBool();
+    const double interval = qMax(1U, params.Interval);
+
+    QVector<double> phases(count);
+    QVector<double> samples(count);
+    waveformPhases(phases.data(), count, tick * interval, phaseOffset * interval, params.WaveformParams);
+    generateWaveform(params.Mode, params.WaveformParams, generator, samples.data(), phases.constData(), count);
 
-    emit dataSimulated(DataDisplayMode::Binary, type, addr, value);
+    visitValueType(type, mode, [&](auto v) {
+        using T = decltype(v);
+        for(int i = 0; i < count; i++)
+            valueSlot<T>(values[i]) = saturate<T>(samples[i]);
+    });
 }
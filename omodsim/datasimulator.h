@@ -1,58 +1,222 @@
 #ifndef DATASIMULATOR_H
 #define DATASIMULATOR_H
 
-#include <QTimer>
+#include <queue>
+#include <tuple>
+#include <vector>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
 #include <QModbusDataUnit>
 #include "modbussimulationparams.h"
+#include "simulationvalue.h"
+#include "fastrandomgenerator.h"
+#include "replayfile.h"
+#include "simulationclock.h"
+
+class ModbusMultiServer;
 
 typedef QMap<QPair<QModbusDataUnit::RegisterType, quint16>, ModbusSimulationParams> ModbusSimulationMap;
+typedef QVector<ModbusSimulationRule> ModbusSimulationRules;
+
+///
+/// \brief The SimulationBatch struct - values simulated at the same tick for one register table of a unit, in address order
+///
+struct SimulationBatch
+{
+    quint8 DeviceId = 0;
+    QModbusDataUnit::RegisterType Type = QModbusDataUnit::Invalid;
+    QVector<quint16> Addresses;
+    QVector<DataDisplayMode> Modes;
+    QVector<ByteOrder> Orders;
+    QVector<SimulationValue> Values;
+};
+Q_DECLARE_METATYPE(SimulationBatch)
 
 ///
 /// \brief The DataSimulator class
 ///
+/// Simulations are computed on a dedicated thread and written once into the registers of their unit,
+/// forms see the values through their data subscriptions. The dataSimulated signal is emitted from that thread.
+///
 class DataSimulator : public QObject
 {
     Q_OBJECT
 public:
-    explicit DataSimulator(QObject* parent = nullptr);
+    explicit DataSimulator(ModbusMultiServer& server, QObject* parent = nullptr);
     ~DataSimulator() override;
 
-    void startSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, const ModbusSimulationParams& params);
-    void stopSimulation(QModbusDataUnit::RegisterType type, quint16 addr);
+    void startSimulation(quint8 deviceId, DataDisplayMode mode, ByteOrder order, QModbusDataUnit::RegisterType type, quint16 addr, const ModbusSimulationParams& params);
+    void stopSimulation(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr);
     void stopSimulations();
 
+    void startRangeSimulation(DataDisplayMode mode, ByteOrder order, const ModbusSimulationRule& rule);
+    void stopRangeSimulation(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr, quint16 length);
+
+    void setByteOrder(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr, quint16 length, ByteOrder order);
+
+    bool startReplay(const ReplayParams& params, QString* errorString = nullptr);
+    void stopReplay();
+    bool isReplaying() const;
+    ReplayParams replayParams() const;
+
+    quint64 randomSeed(int id) const;
+    void setRandomSeed(int id, quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr, quint16 length, quint64 seed);
+    void moveRandomSeed(int id, quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr, quint16 length);
+    void removeRandomSeed(int id);
+
     void pauseSimulations();
     void resumeSimulations();
     void restartSimulations();
 
-    ModbusSimulationParams simulationParams(QModbusDataUnit::RegisterType type, quint16 addr) const;
-    ModbusSimulationMap simulationMap() const;
+    ModbusSimulationParams simulationParams(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr) const;
+    ModbusSimulationMap simulationMap(quint8 deviceId) const;
+    ModbusSimulationRules simulationRules() const;
 
 signals:
-    void simulationStarted(QModbusDataUnit::RegisterType type, quint16 addr);
-    void simulationStopped(QModbusDataUnit::RegisterType type, quint16 addr);
-    void dataSimulated(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, QVariant value);
-
-private slots:
-    void on_timeout();
+    void simulationStarted(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr);
+    void simulationStopped(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr);
+    void rangeSimulationStarted(const ModbusSimulationRule& rule);
+    void rangeSimulationStopped(const ModbusSimulationRule& rule);
+    void replayStarted(const ReplayParams& params);
+    void replayStopped(const ReplayParams& params);
+    void dataSimulated(const SimulationBatch& batch);
 
 private:
-    void randomSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, const RandomSimulationParams& params);
-    void incrementSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, const IncrementSimulationParams& params);
-    void decrementSimailation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, const DecrementSimulationParams& params);
-    void toggleSimulation(QModbusDataUnit::RegisterType type, quint16 addr);
+    ///
+    /// \brief The SimulationKey struct
+    ///
+    struct SimulationKey
+    {
+        quint8 DeviceId;
+        QModbusDataUnit::RegisterType Type;
+        quint16 Address;
 
-private:
-    QTimer _timer;
-    quint32 _elapsed;
-    const int _interval = 1000;
+        bool operator<(const SimulationKey& other) const {
+            return std::tie(DeviceId, Type, Address) < std::tie(other.DeviceId, other.Type, other.Address);
+        }
+    };
+
+    ///
+    /// \brief The SimulationTable struct - simulated points of one register table as parallel arrays sorted by address
+    ///
+    struct SimulationTable
+    {
+        QVector<quint16> Addresses;
+        QVector<DataDisplayMode> Modes;
+        QVector<ByteOrder> Orders;
+        QVector<ModbusSimulationParams> Params;
+        QVector<SimulationValue> Values;
+        QVector<quint64> Ticks;
+        QVector<FastRandomGenerator> Generators;
+        QVector<quint32> Generations;
 
-    struct SimulationParams {
+        int indexOf(quint16 addr) const;
+        int insert(quint16 addr);
+        void remove(int idx);
+        void clear();
+    };
+
+    ///
+    /// \brief The SimulationRule struct - range simulation state is the number of ticks done
+    ///
+    struct SimulationRule
+    {
         DataDisplayMode Mode;
-        ModbusSimulationParams Params;
-        QVariant CurrentValue;
+        ByteOrder Order;
+        ModbusSimulationRule Rule;
+        quint64 Tick = 0;
+        quint32 Generation = 0;
+        FastRandomGenerator Generator;
+    };
+
+    ///
+    /// \brief The SimulationDevice struct - simulated points of one unit
+    ///
+    struct SimulationDevice
+    {
+        SimulationTable Tables[QModbusDataUnit::HoldingRegisters];
     };
-    QMap<QPair<QModbusDataUnit::RegisterType, quint16>, SimulationParams> _simulationMap;
+
+    ///
+    /// \brief The SeedRegion struct - random seed of the simulations shown by one form
+    ///
+    struct SeedRegion
+    {
+        quint8 DeviceId;
+        QModbusDataUnit::RegisterType Type;
+        int Address;
+        int Length;
+        quint64 Seed;
+    };
+
+    SimulationTable* table(quint8 deviceId, QModbusDataUnit::RegisterType type, bool create = false);
+    const SimulationTable* table(quint8 deviceId, QModbusDataUnit::RegisterType type) const;
+
+    void run();
+    qint64 nextDue() const;
+    void commit(const QVector<SimulationBatch>& batches);
+
+    qint64 replayFrameDue(const ReplayFrame& frame) const;
+    QVector<SimulationBatch> replayDue(bool& finished);
+
+    void schedule(const SimulationKey& key, quint32 generation, qint64 due, bool range = false);
+    QVector<SimulationBatch> simulateDue();
+    void simulate(SimulationBatch& batch, SimulationTable& table, const QVector<int>& points);
+    static void simulate(SimulationBatch& batch, SimulationRule& rule);
+
+    quint64 simulationSeed(const SimulationKey& key) const;
+    void reseed(const SeedRegion& region, const SeedRegion* seeded = nullptr);
+
+    static void randomSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, const RandomSimulationParams& params, FastRandomGenerator& generator, SimulationValue& value);
+    static void incrementSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, const IncrementSimulationParams& params, SimulationValue& value);
+    static void decrementSimailation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, const DecrementSimulationParams& params, SimulationValue& value);
+    static void toggleSimulation(SimulationValue& value);
+    static void waveformSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, const ModbusSimulationParams& params, quint64 tick, double phaseOffset, FastRandomGenerator& generator, SimulationValue* values, int count);
+
+private:
+    ModbusMultiServer& _server;
+    QScopedPointer<QThread> _thread;
+
+    // guards everything below, the worker waits on _wakeUp for the next due simulation
+    mutable QMutex _mutex;
+    QWaitCondition _wakeUp;
+    bool _quit = false;
+    bool _paused = true;
+
+    SimulationClock* _clock;
+
+    QMap<quint8, SimulationDevice> _devices;
+    QMap<SimulationKey, SimulationRule> _rules;
+    int _simulationCount = 0;
+    quint32 _generation = 0;
+    QMap<int, SeedRegion> _seeds;
+
+    // replay of a recorded time series, frames due at once are merged into one update
+    QScopedPointer<ReplayFile> _replay;
+    ReplayParams _replayParams;
+    ReplayFrame _replayFrame;
+    QVector<double> _replayValues;
+    QVector<int> _replayOrder;
+    qint64 _replayStart = 0;
+    qint64 _replayOrigin = 0;
+    qint64 _replayPeriod = 0;
+
+    ///
+    /// \brief The ScheduledSimulation struct - entries of a stopped or restarted simulation are
+    /// left in the queue and dropped when their generation does not match any more
+    ///
+    struct ScheduledSimulation {
+        qint64 Due;
+        SimulationKey Key;
+        quint32 Generation;
+        bool Range;
+
+        bool operator>(const ScheduledSimulation& other) const { return Due > other.Due; }
+    };
+    std::priority_queue<ScheduledSimulation, std::vector<ScheduledSimulation>, std::greater<ScheduledSimulation>> _queue;
+
+    bool isScheduled(const ScheduledSimulation& entry) const;
 };
 
 #endif // DATASIMULATOR_H
@@ -23,9 +23,24 @@ DialogAutoSimulation::DialogAutoSimulation(DataDisplayMode mode, ModbusSimulatio
     else
         ui->comboBoxSimulationType->setCurrentIndex(0);
 
-    ui->lineEditInterval->setInputRange(1, 60000);
+    ui->lineEditInterval->setInputRange(1, 86400000);
     ui->lineEditInterval->setValue(_params.Interval);
 
+    ui->lineEditAmplitude->setInputMode(NumericLineEdit::DoubleMode);
+    ui->lineEditAmplitude->setInputRange(-DBL_MAX, DBL_MAX);
+    ui->lineEditAmplitude->setValue(_params.WaveformParams.Amplitude);
+    ui->lineEditOffset->setInputMode(NumericLineEdit::DoubleMode);
+    ui->lineEditOffset->setInputRange(-DBL_MAX, DBL_MAX);
+    ui->lineEditOffset->setValue(_params.WaveformParams.Offset);
+    ui->lineEditPeriod->setInputRange(1, 86400000);
+    ui->lineEditPeriod->setValue(qRound(_params.WaveformParams.Period));
+    ui->lineEditPhase->setInputMode(NumericLineEdit::DoubleMode);
+    ui->lineEditPhase->setInputRange(-360., 360.);
+    ui->lineEditPhase->setValue(_params.WaveformParams.Phase);
+    ui->lineEditNoise->setInputMode(NumericLineEdit::DoubleMode);
+    ui->lineEditNoise->setInputRange(0., DBL_MAX);
+    ui->lineEditNoise->setValue(_params.WaveformParams.Noise);
+
     switch(_displayMode)
     {
         case DataDisplayMode::Binary:
@@ -148,6 +163,18 @@ void DialogAutoSimulation::accept()
                                                                ui->lineEditHighLimit->value<double>());
             break;
 
+            case SimulationMode::Sine:
+            case SimulationMode::Square:
+            case SimulationMode::Triangle:
+            case SimulationMode::Sawtooth:
+            case SimulationMode::Exponential:
+                _params.WaveformParams.Amplitude = ui->lineEditAmplitude->value<double>();
+                _params.WaveformParams.Offset = ui->lineEditOffset->value<double>();
+                _params.WaveformParams.Period = ui->lineEditPeriod->value<int>();
+                _params.WaveformParams.Phase = ui->lineEditPhase->value<double>();
+                _params.WaveformParams.Noise = ui->lineEditNoise->value<double>();
+            break;
+
             default:
             break;
         }
@@ -172,9 +199,11 @@ void DialogAutoSimulation::on_checkBoxEnabled_toggled()
     ui->comboBoxSimulationType->setEnabled(enabled);
     ui->labelInterval->setEnabled(enabled);
     ui->lineEditInterval->setEnabled(enabled);
-    ui->labelStepValue->setEnabled(enabled && mode != SimulationMode::Random);
-    ui->lineEditStepValue->setEnabled(enabled && mode != SimulationMode::Random);
-    ui->groupBoxSimulatioRange->setEnabled(enabled);
+    const bool stepped = (mode == SimulationMode::Increment || mode == SimulationMode::Decrement);
+    ui->labelStepValue->setEnabled(enabled && stepped);
+    ui->lineEditStepValue->setEnabled(enabled && stepped);
+    ui->groupBoxSimulatioRange->setEnabled(enabled && !isWaveformMode(mode));
+    ui->groupBoxWaveform->setEnabled(enabled && isWaveformMode(mode));
 }
 
 ///
@@ -238,6 +267,12 @@ void DialogAutoSimulation::updateLimits()
         break;
 
         default:
+            ui->labelStepValue->setEnabled(false);
+            ui->lineEditStepValue->setEnabled(false);
         break;
     }
+
+    const bool waveform = isWaveformMode(ui->comboBoxSimulationType->currentSimulationMode());
+    ui->groupBoxSimulatioRange->setEnabled(ui->checkBoxEnabled->isChecked() && !waveform);
+    ui->groupBoxWaveform->setEnabled(ui->checkBoxEnabled->isChecked() && waveform);
 }
@@ -21,7 +21,7 @@ DialogCoilSimulation::DialogCoilSimulation(ModbusSimulationParams& params, QWidg
     else
         ui->comboBoxSimulationType->setCurrentIndex(0);
 
-    ui->lineEditInterval->setInputRange(1, 60000);
+    ui->lineEditInterval->setInputRange(1, 86400000);
     ui->lineEditInterval->setValue(_params.Interval);
     on_checkBoxEnabled_toggled();
 }
@@ -17,7 +17,7 @@ DialogDisplayDefinition::DialogDisplayDefinition(DisplayDefinition dd, QWidget*
     ui->lineEditPointAddress->setInputRange(ModbusLimits::addressRange(dd.ZeroBasedAddress));
     ui->lineEditLength->setInputRange(ModbusLimits::lengthRange());
     ui->lineEditSlaveAddress->setInputRange(ModbusLimits::slaveRange());
-    ui->lineEditLogLimit->setInputRange(4, 1000);
+    ui->lineEditLogLimit->setInputRange(4, ModbusLogBuffer::MaxCapacity);
 
     ui->comboBoxAddressBase->setCurrentIndex(dd.ZeroBasedAddress ? 0 : 1);
     ui->lineEditPointAddress->setValue(dd.PointAddress);
@@ -0,0 +1,64 @@
+#include "modbuslimits.h"
+#include "dialograngesimulation.h"
+#include "ui_dialograngesimulation.h"
+
+///
+/// \brief DialogRangeSimulation::DialogRangeSimulation
+/// \param rule
+/// \param zeroBasedAddress
+/// \param parent
+///
+DialogRangeSimulation::DialogRangeSimulation(ModbusSimulationRule& rule, bool zeroBasedAddress, QWidget *parent) :
+     QFixedSizeDialog(parent)
+    , ui(new Ui::DialogRangeSimulation)
+    ,_rule(rule)
+    ,_zeroBasedAddress(zeroBasedAddress)
+{
+    ui->setupUi(this);
+    ui->lineEditAddress->setInputRange(ModbusLimits::addressRange(zeroBasedAddress));
+    ui->lineEditNumberOfPoints->setInputRange(1, 65535);
+    ui->lineEditPhaseOffset->setInputMode(NumericLineEdit::DoubleMode);
+    ui->lineEditPhaseOffset->setInputRange(-65535., 65535.);
+    ui->lineEditAddress->setValue(rule.Address + (zeroBasedAddress ? 0 : 1));
+    ui->lineEditNumberOfPoints->setValue(rule.Length);
+    ui->lineEditPhaseOffset->setValue(rule.PhaseOffset);
+
+    switch(rule.Type)
+    {
+        case QModbusDataUnit::Coils:
+            setWindowTitle(tr("SIMULATE COILS"));
+        break;
+        case QModbusDataUnit::DiscreteInputs:
+             setWindowTitle(tr("SIMULATE DISCRETE INPUTS"));
+        break;
+        case QModbusDataUnit::InputRegisters:
+            setWindowTitle(tr("SIMULATE INPUT REGISTERS"));
+        break;
+        case QModbusDataUnit::HoldingRegisters:
+            setWindowTitle(tr("SIMULATE HOLDING REGISTERS"));
+        break;
+        default:
+        break;
+    }
+
+    ui->buttonBox->setFocus();
+}
+
+///
+/// \brief DialogRangeSimulation::~DialogRangeSimulation
+///
+DialogRangeSimulation::~DialogRangeSimulation()
+{
+    delete ui;
+}
+
+///
+/// \brief DialogRangeSimulation::accept
+///
+void DialogRangeSimulation::accept()
+{
+    _rule.Address = ui->lineEditAddress->value<int>() - (_zeroBasedAddress ? 0 : 1);
+    _rule.Length = ui->lineEditNumberOfPoints->value<int>();
+    _rule.PhaseOffset = ui->lineEditPhaseOffset->value<double>();
+    QFixedSizeDialog::accept();
+}
@@ -0,0 +1,30 @@
+#ifndef DIALOGRANGESIMULATION_H
+#define DIALOGRANGESIMULATION_H
+
+#include "qfixedsizedialog.h"
+#include "modbussimulationparams.h"
+
+namespace Ui {
+class DialogRangeSimulation;
+}
+
+///
+/// \brief The DialogRangeSimulation class
+///
+class DialogRangeSimulation : public QFixedSizeDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DialogRangeSimulation(ModbusSimulationRule& rule, bool zeroBasedAddress, QWidget *parent = nullptr);
+    ~DialogRangeSimulation();
+
+    void accept() override;
+
+private:
+    Ui::DialogRangeSimulation *ui;
+    ModbusSimulationRule& _rule;
+    bool _zeroBasedAddress;
+};
+
+#endif // DIALOGRANGESIMULATION_H
@@ -0,0 +1,136 @@
+#include <QMessageBox>
+#include "dialogtraffichistory.h"
+#include "ui_dialogtraffichistory.h"
+#include "trafficutils.h"
+
+///
+/// \brief DialogTrafficHistory::DialogTrafficHistory
+/// \param directory - journal directory
+/// \param journal - running journal, flushed before every query
+/// \param mode
+/// \param parent
+///
+DialogTrafficHistory::DialogTrafficHistory(const QString& directory, ModbusTrafficJournal* journal, DataDisplayMode mode, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::DialogTrafficHistory)
+    ,_directory(directory)
+    ,_journal(journal)
+{
+    ui->setupUi(this);
+    setWindowTitle(QString("%1 - %2").arg(windowTitle(), directory));
+
+    const auto now = QDateTime::currentDateTime();
+    ui->dateTimeEditFrom->setDateTime(now.addSecs(-3600));
+    ui->dateTimeEditTo->setDateTime(now);
+
+    ui->logView->setDataDisplayMode(mode);
+    ui->modbusMsg->setDataDisplayMode(mode);
+
+    connect(ui->logView->selectionModel(),
+            &QItemSelectionModel::selectionChanged,
+            this, [&](const QItemSelection& sel) {
+                if(!sel.indexes().isEmpty())
+                    showModbusMessage(sel.indexes().first());
+            });
+}
+
+///
+/// \brief DialogTrafficHistory::~DialogTrafficHistory
+///
+DialogTrafficHistory::~DialogTrafficHistory()
+{
+    ui->modbusMsg->setModbusMessage(nullptr);
+    ui->logView->setTrafficLog(nullptr);
+    delete ui;
+}
+
+///
+/// \brief DialogTrafficHistory::changeEvent
+/// \param event
+///
+void DialogTrafficHistory::changeEvent(QEvent* event)
+{
+    if (event->type() == QEvent::LanguageChange)
+    {
+        ui->retranslateUi(this);
+    }
+
+    QDialog::changeEvent(event);
+}
+
+///
+/// \brief DialogTrafficHistory::on_pushButtonQuery_clicked
+///
+void DialogTrafficHistory::on_pushButtonQuery_clicked()
+{
+    TrafficJournalQuery query;
+    query.From = ui->dateTimeEditFrom->dateTime();
+    query.To = ui->dateTimeEditTo->dateTime();
+    query.Limit = MaxFrames;
+
+    bool okCodes, okIds;
+    query.FunctionCodes = parseNumbers(ui->lineEditFunctionCodes->text(), &okCodes);
+    query.DeviceIds = parseNumbers(ui->lineEditDeviceIds->text(), &okIds);
+    const bool okAddress = parseRange(ui->lineEditAddress->text(), &query.FromAddress, &query.ToAddress);
+    if(!okCodes || !okIds || !okAddress)
+    {
+        QMessageBox::warning(this, windowTitle(), tr("Invalid filter. Use numbers and ranges, e.g. 15,16 or 4000-4100."));
+        return;
+    }
+
+    if(_journal && _journal->isOpen())
+        _journal->flush();
+
+    QVector<TrafficJournalFrame> frames;
+    QString error;
+    const auto count = ModbusTrafficJournal::query(_directory, query, [&](const TrafficJournalFrame& frame)
+    {
+        frames.push_back(frame);
+        return true;
+    }, &error);
+
+    if(count < 0)
+    {
+        QMessageBox::warning(this, windowTitle(), error);
+        return;
+    }
+
+    ui->modbusMsg->setModbusMessage(nullptr);
+    _modbusMessage.reset();
+    ui->logView->setTrafficLog(nullptr);
+
+    // a log of its own, so the found frames are shown the same way as the live traffic
+    _trafficLog.reset(new ModbusTrafficLog(qMax(1, frames.size())));
+    for(auto&& frame : frames)
+    {
+        const auto code = QModbusPdu::FunctionCode(quint8(frame.Pdu[0]));
+        const auto data = frame.Pdu.mid(1);
+        if(frame.Request)
+            _trafficLog->append(QModbusRequest(code, data), frame.Protocol, frame.DeviceId, frame.TransactionId, true, frame.dateTime());
+        else
+            _trafficLog->append(QModbusResponse(code, data), frame.Protocol, frame.DeviceId, frame.TransactionId, false, frame.dateTime());
+    }
+
+    ui->logView->setRowLimit(qMax(1, count));
+    ui->logView->setTrafficLog(_trafficLog.get());
+
+    // the log drops the oldest frames when their bytes do not fit
+    const auto shown = int(_trafficLog->endSequence() - _trafficLog->firstSequence());
+    if(shown < count)
+        ui->labelStatus->setText(QString(tr("Last %1 of %2 frames shown")).arg(shown).arg(count));
+    else if(count < MaxFrames)
+        ui->labelStatus->setText(QString(tr("%1 frames found")).arg(count));
+    else
+        ui->labelStatus->setText(QString(tr("First %1 frames shown")).arg(count));
+}
+
+///
+/// \brief DialogTrafficHistory::showModbusMessage
+/// \param index
+///
+void DialogTrafficHistory::showModbusMessage(const QModelIndex& index)
+{
+    const auto msg = ui->logView->createMessage(index);
+    ui->modbusMsg->setModbusMessage(msg);
+    _modbusMessage.reset(msg);
+}
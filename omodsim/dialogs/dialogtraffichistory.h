@@ -0,0 +1,43 @@
+#ifndef DIALOGTRAFFICHISTORY_H
+#define DIALOGTRAFFICHISTORY_H
+
+#include <QDialog>
+#include "enums.h"
+#include "modbustrafficlog.h"
+#include "modbustrafficjournal.h"
+
+namespace Ui {
+class DialogTrafficHistory;
+}
+
+///
+/// \brief The DialogTrafficHistory class - queries the traffic journal and shows the found frames
+///
+class DialogTrafficHistory : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DialogTrafficHistory(const QString& directory, ModbusTrafficJournal* journal, DataDisplayMode mode, QWidget *parent = nullptr);
+    ~DialogTrafficHistory();
+
+    static constexpr int MaxFrames = 100000;
+
+protected:
+    void changeEvent(QEvent* event) override;
+
+private slots:
+    void on_pushButtonQuery_clicked();
+
+private:
+    void showModbusMessage(const QModelIndex& index);
+
+private:
+    Ui::DialogTrafficHistory *ui;
+    QString _directory;
+    ModbusTrafficJournal* _journal;
+    QScopedPointer<ModbusTrafficLog> _trafficLog;
+    QScopedPointer<const ModbusMessage> _modbusMessage;
+};
+
+#endif // DIALOGTRAFFICHISTORY_H
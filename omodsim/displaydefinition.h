@@ -4,6 +4,7 @@
 #include <QSettings>
 #include <QModbusDataUnit>
 #include "modbuslimits.h"
+#include "modbuslogbuffer.h"
 
 ///
 /// \brief The DisplayDefinition struct
@@ -14,7 +15,7 @@ struct DisplayDefinition
     quint16 PointAddress = 1;
     QModbusDataUnit::RegisterType PointType = QModbusDataUnit::HoldingRegisters;
     quint16 Length = 100;
-    quint16 LogViewLimit = 30;
+    quint32 LogViewLimit = 30;
     bool ZeroBasedAddress = false;
 
     void normalize()
@@ -23,7 +24,7 @@ struct DisplayDefinition
         PointAddress = qMax<quint16>(ModbusLimits::addressRange(ZeroBasedAddress).from(), PointAddress);
         PointType = qBound(QModbusDataUnit::DiscreteInputs, PointType, QModbusDataUnit::HoldingRegisters);
         Length = qBound<quint16>(ModbusLimits::lengthRange().from(), Length, ModbusLimits::lengthRange().to());
-        LogViewLimit = qBound<quint16>(4, LogViewLimit, 1000);
+        LogViewLimit = qBound<quint32>(4, LogViewLimit, ModbusLogBuffer::MaxCapacity);
     }
 };
 Q_DECLARE_METATYPE(DisplayDefinition)
@@ -194,7 +194,12 @@ enum class SimulationMode
     Random,
     Increment,
     Decrement,
-    Toggle
+    Toggle,
+    Sine,
+    Square,
+    Triangle,
+    Sawtooth,
+    Exponential
 };
 Q_DECLARE_METATYPE(SimulationMode);
 
@@ -0,0 +1,99 @@
+#ifndef FASTRANDOMGENERATOR_H
+#define FASTRANDOMGENERATOR_H
+
+#include <QtGlobal>
+
+///
+/// \brief The FastRandomGenerator class - xoshiro256** generator
+///
+/// Not thread safe and not suitable for cryptography, but a few cycles per value
+/// and the same sequence for the same seed on every run.
+///
+class FastRandomGenerator
+{
+public:
+    explicit FastRandomGenerator(quint64 seed = 0)
+    {
+        this->seed(seed);
+    }
+
+    ///
+    /// \brief seed - expands the seed into the generator state with splitmix64
+    /// \param seed
+    ///
+    void seed(quint64 seed)
+    {
+        for(auto&& s : _state)
+        {
+            seed += 0x9E3779B97F4A7C15ULL;
+            auto z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            s = z ^ (z >> 31);
+        }
+    }
+
+    ///
+    /// \brief generate64
+    /// \return
+    ///
+    quint64 generate64()
+    {
+        const auto result = rotl(_state[1] * 5, 7) * 9;
+        const auto t = _state[1] << 17;
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = rotl(_state[3], 45);
+
+        return result;
+    }
+
+    ///
+    /// \brief generateDouble
+    /// \return value in [0, 1)
+    ///
+    double generateDouble()
+    {
+        return (generate64() >> 11) * 0x1.0p-53;
+    }
+
+    ///
+    /// \brief bounded
+    /// \param highest
+    /// \return value in [0, highest)
+    ///
+    double bounded(double highest)
+    {
+        return generateDouble() * highest;
+    }
+
+    ///
+    /// \brief fillRange
+    /// \param values
+    /// \param count
+    /// \param from
+    /// \param to
+    /// \return values in [from, to)
+    ///
+    void fillRange(double* values, int count, double from, double to)
+    {
+        const auto range = to - from;
+        for(int i = 0; i < count; i++)
+            values[i] = from + generateDouble() * range;
+    }
+
+private:
+    static quint64 rotl(quint64 x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+private:
+    quint64 _state[4];
+};
+
+#endif // FASTRANDOMGENERATOR_H
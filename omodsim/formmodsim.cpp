@@ -12,7 +12,7 @@
 #include "formmodsim.h"
 #include "ui_formmodsim.h"
 
-QVersionNumber FormModSim::VERSION = QVersionNumber(1, 6);
+QVersionNumber FormModSim::VERSION = QVersionNumber(1, 10);
 
 ///
 /// \brief FormModSim::FormModSim
@@ -33,11 +33,12 @@ FormModSim::FormModSim(int id, ModbusMultiServer& server, QSharedPointer<DataSim
     setWindowTitle(QString("ModSim%1").arg(_formId));
 
     ui->lineEditDeviceId->setInputRange(ModbusLimits::slaveRange());
-    ui->lineEditDeviceId->setValue(server.deviceId());
+    ui->lineEditDeviceId->setValue(1);
 
     ui->stackedWidget->setCurrentIndex(0);
     ui->scriptControl->setModbusMultiServer(&_mbMultiServer);
     ui->scriptControl->setByteOrder(ui->outputWidget->byteOrder());
+    ui->outputWidget->setTrafficLog(_mbMultiServer.trafficLog());
 
     ui->lineEditAddress->setPaddingZeroes(true);
     ui->lineEditAddress->setInputRange(ModbusLimits::addressRange(true));
@@ -52,16 +53,13 @@ FormModSim::FormModSim(int id, ModbusMultiServer& server, QSharedPointer<DataSim
     onDefinitionChanged();
     ui->outputWidget->setFocus();
 
-    connect(&_mbMultiServer, &ModbusMultiServer::request, this, &FormModSim::on_mbRequest);
-    connect(&_mbMultiServer, &ModbusMultiServer::response, this, &FormModSim::on_mbResponse);
     connect(&_mbMultiServer, &ModbusMultiServer::connected, this, &FormModSim::on_mbConnected);
     connect(&_mbMultiServer, &ModbusMultiServer::disconnected, this, &FormModSim::on_mbDisconnected);
-    connect(&_mbMultiServer, &ModbusMultiServer::deviceIdChanged, this, &FormModSim::on_mbDeviceIdChanged);
-    connect(&_mbMultiServer, &ModbusMultiServer::dataChanged, this, &FormModSim::on_mbDataChanged);
 
     connect(_dataSimulator.get(), &DataSimulator::simulationStarted, this, &FormModSim::on_simulationStarted);
     connect(_dataSimulator.get(), &DataSimulator::simulationStopped, this, &FormModSim::on_simulationStopped);
-    connect(_dataSimulator.get(), &DataSimulator::dataSimulated, this, &FormModSim::on_dataSimulated);
+    connect(_dataSimulator.get(), &DataSimulator::rangeSimulationStarted, this, &FormModSim::on_rangeSimulationStarted);
+    connect(_dataSimulator.get(), &DataSimulator::rangeSimulationStopped, this, &FormModSim::on_rangeSimulationStopped);
 }
 
 ///
@@ -69,6 +67,7 @@ FormModSim::FormModSim(int id, ModbusMultiServer& server, QSharedPointer<DataSim
 ///
 FormModSim::~FormModSim()
 {
+    _mbMultiServer.unsubscribe(formId());
     delete ui;
 }
 
@@ -94,6 +93,8 @@ void FormModSim::changeEvent(QEvent* e)
 void FormModSim::closeEvent(QCloseEvent *event)
 {
     _mbMultiServer.removeUnitMap(formId());
+    _mbMultiServer.unsubscribe(formId());
+    _dataSimulator->removeRandomSeed(formId());
 
     emit closing();
     QWidget::closeEvent(event);
@@ -138,6 +139,7 @@ DisplayDefinition FormModSim::displayDefinition() const
     dd.PointType = ui->comboBoxModbusPointType->currentPointType();
     dd.Length = ui->lineEditLength->value<int>();
     dd.ZeroBasedAddress = ui->lineEditAddress->range<int>().from() == 0;
+    dd.LogViewLimit = ui->outputWidget->logViewLimit();
 
     return dd;
 }
@@ -167,6 +169,8 @@ void FormModSim::setDisplayDefinition(const DisplayDefinition& dd)
     ui->comboBoxModbusPointType->setCurrentPointType(dd.PointType);
     ui->comboBoxModbusPointType->blockSignals(false);
 
+    ui->outputWidget->setLogViewLimit(dd.LogViewLimit);
+
     onDefinitionChanged();
 }
 
@@ -301,6 +305,11 @@ ByteOrder FormModSim::byteOrder() const
 void FormModSim::setByteOrder(ByteOrder order)
 {
     ui->outputWidget->setByteOrder(order);
+
+    const auto dd = displayDefinition();
+    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+    _dataSimulator->setByteOrder(dd.DeviceId, dd.PointType, addr, dd.Length, order);
+
     emit byteOrderChanged(order);
 }
 
@@ -435,7 +444,7 @@ ModbusSimulationMap FormModSim::simulationMap() const
     const auto endAddr = startAddr + dd.Length;
 
     ModbusSimulationMap result;
-    const auto simulationMap = _dataSimulator->simulationMap();
+    const auto simulationMap = _dataSimulator->simulationMap(dd.DeviceId);
     for(auto&& key : simulationMap.keys())
     {
         if(key.first == dd.PointType &&
@@ -449,13 +458,78 @@ ModbusSimulationMap FormModSim::simulationMap() const
 }
 
 
+///
+/// \brief FormModSim::simulationRules
+/// \return range simulations that overlap the form
+///
+ModbusSimulationRules FormModSim::simulationRules() const
+{
+    const auto dd = displayDefinition();
+    const auto startAddr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+    const auto endAddr = startAddr + dd.Length;
+
+    ModbusSimulationRules result;
+    for(auto&& rule : _dataSimulator->simulationRules())
+    {
+        if(rule.DeviceId == dd.DeviceId && rule.Type == dd.PointType &&
+           rule.Address < endAddr && startAddr < rule.Address + rule.Length)
+        {
+            result.push_back(rule);
+        }
+    }
+
+    return result;
+}
+
+///
+/// \brief FormModSim::startRangeSimulation
+/// \param rule
+///
+void FormModSim::startRangeSimulation(const ModbusSimulationRule& rule)
+{
+    auto r = rule;
+    r.DeviceId = displayDefinition().DeviceId;
+    _dataSimulator->startRangeSimulation(dataDisplayMode(), byteOrder(), r);
+}
+
+///
+/// \brief FormModSim::stopRangeSimulation
+/// \param type
+/// \param addr
+/// \param length
+///
+void FormModSim::stopRangeSimulation(QModbusDataUnit::RegisterType type, quint16 addr, quint16 length)
+{
+    _dataSimulator->stopRangeSimulation(displayDefinition().DeviceId, type, addr, length);
+}
+
+///
+/// \brief FormModSim::randomSeed
+/// \return seed of the random simulations shown by the form
+///
+quint64 FormModSim::randomSeed() const
+{
+    return _dataSimulator->randomSeed(formId());
+}
+
+///
+/// \brief FormModSim::setRandomSeed
+/// \param seed - applies to the simulations shown by the form, 0 seeds them randomly
+///
+void FormModSim::setRandomSeed(quint64 seed)
+{
+    const auto dd = displayDefinition();
+    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+    _dataSimulator->setRandomSeed(formId(), dd.DeviceId, dd.PointType, addr, dd.Length, seed);
+}
+
 QModbusDataUnit FormModSim::serializeModbusDataUnit(QModbusDataUnit::RegisterType type,
                                                     quint16 startAddress,
                                                     quint16 length) const
 {
     QModbusDataUnit dataUnit;
 
-    const auto serverData = _mbMultiServer.data(type, startAddress, length);
+    const auto serverData = _mbMultiServer.data(displayDefinition().DeviceId, type, startAddress, length);
 
     const auto& unit = serverData;
 
@@ -484,7 +558,7 @@ QModbusDataUnit FormModSim::serializeModbusDataUnit(QModbusDataUnit::RegisterTyp
 ///
 void FormModSim::startSimulation(QModbusDataUnit::RegisterType type, quint16 addr, const ModbusSimulationParams& params)
 {
-    _dataSimulator->startSimulation(dataDisplayMode(), type, addr, params);
+    _dataSimulator->startSimulation(displayDefinition().DeviceId, dataDisplayMode(), byteOrder(), type, addr, params);
 }
 
 void FormModSim::configureModbusDataUnit(QModbusDataUnit::RegisterType type,
@@ -495,7 +569,7 @@ void FormModSim::configureModbusDataUnit(QModbusDataUnit::RegisterType type,
     unit.setRegisterType(type);
     unit.setStartAddress(startAddress);
     unit.setValues(values);
-    _mbMultiServer.setData(unit);
+    _mbMultiServer.setData(displayDefinition().DeviceId, unit);
 }
 
 
@@ -693,11 +767,21 @@ void FormModSim::onDefinitionChanged()
 
     const auto dd = displayDefinition();
     const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
-    _mbMultiServer.setDeviceId(dd.DeviceId);
-    _mbMultiServer.addUnitMap(formId(), dd.PointType, addr, dd.Length);
+    _mbMultiServer.addUnitMap(formId(), dd.DeviceId, dd.PointType, addr, dd.Length);
+    _mbMultiServer.subscribe(formId(), dd.DeviceId, dd.PointType, addr, dd.Length, [this](const QModbusDataUnit& data)
+    {
+        on_mbDataChanged(data);
+    });
 
+    // the seed follows the form to its new range, running simulations keep their sequences
+    _dataSimulator->moveRandomSeed(formId(), dd.DeviceId, dd.PointType, addr, dd.Length);
+
+    ui->scriptControl->setDeviceId(dd.DeviceId);
     ui->scriptControl->setAddressBase(dd.ZeroBasedAddress ? AddressBase::Base0 : AddressBase::Base1);
-    ui->outputWidget->setup(dd, _dataSimulator->simulationMap(), _mbMultiServer.data(dd.PointType, addr, dd.Length));
+    ui->outputWidget->setup(dd, _dataSimulator->simulationMap(dd.DeviceId), _mbMultiServer.data(dd.DeviceId, dd.PointType, addr, dd.Length));
+
+    for(auto&& rule : simulationRules())
+        on_rangeSimulationStarted(rule);
 }
 
 ///
@@ -718,9 +802,10 @@ void FormModSim::on_outputWidget_itemDoubleClicked(quint16 addr, const QVariant&
 {
     const auto mode = dataDisplayMode();
     const auto pointType = ui->comboBoxModbusPointType->currentPointType();
+    const auto deviceId = displayDefinition().DeviceId;
     const auto zeroBasedAddress = displayDefinition().ZeroBasedAddress;
     const auto simAddr = addr - (zeroBasedAddress ? 0 : 1);
-    auto simParams = _dataSimulator->simulationParams(pointType, addr);
+    auto simParams = _dataSimulator->simulationParams(deviceId, pointType, addr);
 
     switch(pointType)
     {
@@ -732,12 +817,12 @@ void FormModSim::on_outputWidget_itemDoubleClicked(quint16 addr, const QVariant&
             switch(dlg.exec())
             {
                 case QDialog::Accepted:
-                    _mbMultiServer.writeRegister(pointType, params);
+                    _mbMultiServer.writeRegister(deviceId, pointType, params);
                 break;
 
                 case 2:
-                    if(simParams.Mode == SimulationMode::No) _dataSimulator->stopSimulation(pointType, simAddr);
-                    else _dataSimulator->startSimulation(mode, pointType, simAddr, simParams);
+                    if(simParams.Mode == SimulationMode::No) _dataSimulator->stopSimulation(deviceId, pointType, simAddr);
+                    else _dataSimulator->startSimulation(deviceId, mode, byteOrder(), pointType, simAddr, simParams);
                 break;
             }
         }
@@ -751,7 +836,7 @@ void FormModSim::on_outputWidget_itemDoubleClicked(quint16 addr, const QVariant&
             {
                 DialogWriteHoldingRegisterBits dlg(params, this);
                 if(dlg.exec() == QDialog::Accepted)
-                    _mbMultiServer.writeRegister(pointType, params);
+                    _mbMultiServer.writeRegister(deviceId, pointType, params);
             }
             else
             {
@@ -759,12 +844,12 @@ void FormModSim::on_outputWidget_itemDoubleClicked(quint16 addr, const QVariant&
                 switch(dlg.exec())
                 {
                     case QDialog::Accepted:
-                        _mbMultiServer.writeRegister(pointType, params);
+                        _mbMultiServer.writeRegister(deviceId, pointType, params);
                     break;
 
                     case 2:
-                        if(simParams.Mode == SimulationMode::No) _dataSimulator->stopSimulation(pointType, simAddr);
-                        else _dataSimulator->startSimulation(mode, pointType, simAddr, simParams);
+                        if(simParams.Mode == SimulationMode::No) _dataSimulator->stopSimulation(deviceId, pointType, simAddr);
+                        else _dataSimulator->startSimulation(deviceId, mode, byteOrder(), pointType, simAddr, simParams);
                     break;
                 }
             }
@@ -776,17 +861,6 @@ void FormModSim::on_outputWidget_itemDoubleClicked(quint16 addr, const QVariant&
     }
 }
 
-///
-/// \brief FormModSim::on_mbDeviceIdChanged
-/// \param deviceId
-///
-void FormModSim::on_mbDeviceIdChanged(quint8 deviceId)
-{
-    blockSignals(true);
-    ui->lineEditDeviceId->setValue(deviceId);
-    blockSignals(false);
-}
-
 ///
 /// \brief FormModSim::on_mbConnected
 ///
@@ -803,75 +877,75 @@ void FormModSim::on_mbDisconnected(const ConnectionDetails&)
    updateStatus();
 }
 
-///
-/// \brief FormModSim::on_mbRequest
-/// \param req
-/// \param protocol
-/// \param transactionId
-///
-void FormModSim::on_mbRequest(const QModbusRequest& req, ModbusMessage::ProtocolType protocol, int transactionId)
-{
-    const auto deviceId = ui->lineEditDeviceId->value<int>();
-    ui->outputWidget->updateTraffic(req, deviceId, transactionId, protocol);
-}
-
-///
-/// \brief FormModSim::on_mbResponse
-/// \param resp
-/// \param protocol
-/// \param transactionId
-///
-void FormModSim::on_mbResponse(const QModbusResponse& resp, ModbusMessage::ProtocolType protocol, int transactionId)
-{
-    const auto deviceId = ui->lineEditDeviceId->value<int>();
-    ui->outputWidget->updateTraffic(resp, deviceId, transactionId, protocol);
-}
-
 ///
 /// \brief FormModSim::on_mbDataChanged
+/// \param data - changed part of the displayed range
 ///
-void FormModSim::on_mbDataChanged(const QModbusDataUnit&)
+void FormModSim::on_mbDataChanged(const QModbusDataUnit& data)
 {
-    const auto dd = displayDefinition();
-    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
-    ui->outputWidget->updateData(_mbMultiServer.data(dd.PointType, addr, dd.Length));
+    ui->outputWidget->updateValues(data);
 }
 
 ///
 /// \brief FormModSim::on_simulationStarted
+/// \param deviceId
 /// \param type
 /// \param addr
 ///
-void FormModSim::on_simulationStarted(QModbusDataUnit::RegisterType type, quint16 addr)
+void FormModSim::on_simulationStarted(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr)
 {
-    ui->outputWidget->setSimulated(type, addr, true);
+    if(deviceId == displayDefinition().DeviceId)
+        ui->outputWidget->setSimulated(type, addr, true);
 }
 
 ///
 /// \brief FormModSim::on_simulationStopped
+/// \param deviceId
 /// \param type
 /// \param addr
 ///
-void FormModSim::on_simulationStopped(QModbusDataUnit::RegisterType type, quint16 addr)
+void FormModSim::on_simulationStopped(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr)
 {
-    ui->outputWidget->setSimulated(type, addr, false);
+    if(deviceId == displayDefinition().DeviceId)
+        ui->outputWidget->setSimulated(type, addr, false);
 }
 
 ///
-/// \brief FormModSim::on_dataSimulated
-/// \param mode
-/// \param type
-/// \param addr
-/// \param value
+/// \brief FormModSim::on_rangeSimulationStarted
+/// \param rule
 ///
-void FormModSim::on_dataSimulated(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, QVariant value)
+void FormModSim::on_rangeSimulationStarted(const ModbusSimulationRule& rule)
 {
     const auto dd = displayDefinition();
-    const auto pointAddr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
-    if(type == dd.PointType && addr >= pointAddr && addr <= pointAddr + dd.Length)
-    {
-        _mbMultiServer.writeRegister(type, { addr, value, mode, byteOrder(), true });
-    }
+    if(rule.DeviceId != dd.DeviceId)
+        return;
+
+    const int startAddr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+    const auto first = qMax<int>(rule.Address, startAddr);
+    const auto last = qMin<int>(rule.Address + rule.Length, startAddr + dd.Length);
+
+    for(int addr = first; addr < last; addr++)
+        ui->outputWidget->setSimulated(rule.Type, addr, true);
+}
+
+///
+/// \brief FormModSim::on_rangeSimulationStopped
+/// \param rule
+///
+void FormModSim::on_rangeSimulationStopped(const ModbusSimulationRule& rule)
+{
+    const auto dd = displayDefinition();
+    if(rule.DeviceId != dd.DeviceId)
+        return;
+
+    const int startAddr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+    const auto first = qMax<int>(rule.Address, startAddr);
+    const auto last = qMin<int>(rule.Address + rule.Length, startAddr + dd.Length);
+
+    // points simulated on their own stay marked
+    const auto simulationMap = _dataSimulator->simulationMap(dd.DeviceId);
+    for(int addr = first; addr < last; addr++)
+        ui->outputWidget->setSimulated(rule.Type, addr, simulationMap.contains({ rule.Type, quint16(addr) }));
 }
 
 ///
@@ -8,6 +8,7 @@
 #include "datasimulator.h"
 #include "modbusmultiserver.h"
 #include "displaydefinition.h"
+#include "formmodsimdata.h"
 #include "outputwidget.h"
 #include "scriptcontrol.h"
 #include "scriptsettings.h"
@@ -87,6 +88,13 @@ public:
     ModbusSimulationMap simulationMap() const;
     void startSimulation(QModbusDataUnit::RegisterType type, quint16 addr, const ModbusSimulationParams& params);
 
+    ModbusSimulationRules simulationRules() const;
+    void startRangeSimulation(const ModbusSimulationRule& rule);
+    void stopRangeSimulation(QModbusDataUnit::RegisterType type, quint16 addr, quint16 length);
+
+    quint64 randomSeed() const;
+    void setRandomSeed(quint64 seed);
+
     QModbusDataUnit serializeModbusDataUnit(QModbusDataUnit::RegisterType pointType,
                                             quint16 pointAddress,
                                             quint16 length) const;
@@ -130,15 +138,13 @@ private slots:
     void on_comboBoxAddressBase_addressBaseChanged(AddressBase base);
     void on_comboBoxModbusPointType_pointTypeChanged(QModbusDataUnit::RegisterType value);
     void on_outputWidget_itemDoubleClicked(quint16 addr, const QVariant& value);
-    void on_mbDeviceIdChanged(quint8 deviceId);
     void on_mbConnected(const ConnectionDetails& cd);
     void on_mbDisconnected(const ConnectionDetails& cd);
-    void on_mbRequest(const QModbusRequest& req, ModbusMessage::ProtocolType protocol, int transactionId);
-    void on_mbResponse(const QModbusResponse& resp, ModbusMessage::ProtocolType protocol, int transactionId);
     void on_mbDataChanged(const QModbusDataUnit& data);
-    void on_simulationStarted(QModbusDataUnit::RegisterType type, quint16 addr);
-    void on_simulationStopped(QModbusDataUnit::RegisterType type, quint16 addr);
-    void on_dataSimulated(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, QVariant value);
+    void on_simulationStarted(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr);
+    void on_simulationStopped(quint8 deviceId, QModbusDataUnit::RegisterType type, quint16 addr);
+    void on_rangeSimulationStarted(const ModbusSimulationRule& rule);
+    void on_rangeSimulationStopped(const ModbusSimulationRule& rule);
 
 private:
     void updateStatus();
@@ -272,7 +278,7 @@ inline QDataStream& operator <<(QDataStream& out, FormModSim* frm)
     out << dd.PointType;
     out << dd.PointAddress;
     out << dd.Length;
-    out << dd.LogViewLimit;
+    out << quint16(qMin<quint32>(dd.LogViewLimit, 1000));
     out << dd.ZeroBasedAddress;
 
     out << frm->byteOrder();
@@ -286,6 +292,10 @@ inline QDataStream& operator <<(QDataStream& out, FormModSim* frm)
     out << unit.startAddress();
     out << unit.values();
 
+    out << frm->simulationRules();
+    out << frm->randomSeed();
+    out << dd.LogViewLimit;
+
     return out;
 }
 
@@ -300,103 +310,41 @@ inline QDataStream& operator >>(QDataStream& in, FormModSim* frm)
     if(!frm) return in;
     const auto ver = frm->property("Version").value<QVersionNumber>();
 
-    bool isMaximized;
-    in >> isMaximized;
-
-    QSize windowSize;
-    in >> windowSize;
-
-    DisplayMode displayMode;
-    in >> displayMode;
-
-    DataDisplayMode dataDisplayMode;
-    in >> dataDisplayMode;
-
-    bool hexAddresses;
-    in >> hexAddresses;
-
-    QColor bkgClr;
-    in >> bkgClr;
-
-    QColor fgClr;
-    in >> fgClr;
-
-    QColor stCrl;
-    in >> stCrl;
-
-    QFont font;
-    in >> font;
-
-    DisplayDefinition dd;
-    if(ver >= QVersionNumber(1, 5))
-    {
-        in >> dd.DeviceId;
-        in >> dd.PointType;
-        in >> dd.PointAddress;
-        in >> dd.Length;
-        in >> dd.LogViewLimit;
-    }
-    if(ver >= QVersionNumber(1, 6))
-    {
-        in >> dd.ZeroBasedAddress;
-    }
-
-    ModbusSimulationMap simulationMap;
-    ByteOrder byteOrder = ByteOrder::LittleEndian;
-    if(ver >= QVersionNumber(1, 1))
-    {
-        in >> byteOrder;
-        in >> simulationMap;
-    }
-
-    ScriptSettings scriptSettings;
-    if(ver >=  QVersionNumber(1, 2))
-    {
-        in >> frm->scriptControl();
-        in >> scriptSettings;
-    }
-
-    AddressDescriptionMap descriptionMap;
-    if(ver >=  QVersionNumber(1, 3))
-    {
-        in >> descriptionMap;
-    }
-
-    if(in.status() != QDataStream::Ok)
+    FormModSimData data;
+    if(readFormModSimData(in, ver, data).status() != QDataStream::Ok)
         return in;
 
     auto wnd = frm->parentWidget();
-    wnd->resize(windowSize);
+    wnd->resize(data.WindowSize);
     wnd->setWindowState(Qt::WindowActive);
-    if(isMaximized) wnd->setWindowState(Qt::WindowMaximized);
-    else wnd->resize(windowSize);
-
-    frm->setDisplayMode(displayMode);
-    frm->setDataDisplayMode(dataDisplayMode);
-    frm->setDisplayHexAddresses(hexAddresses);
-    frm->setBackgroundColor(bkgClr);
-    frm->setForegroundColor(fgClr);
-    frm->setStatusColor(stCrl);
-    frm->setFont(font);
-    frm->setDisplayDefinition(dd);
-    frm->setByteOrder(byteOrder);
-    frm->setScriptSettings(scriptSettings);
-
-    for(auto&& k : simulationMap.keys())
-        frm->startSimulation(k.first, k.second,  simulationMap[k]);
-
-    for(auto&& k : descriptionMap.keys())
-        frm->setDescription(k.first, k.second, descriptionMap[k]);
-
-    QModbusDataUnit::RegisterType type;
-    int startAddress;
-    QVector<quint16> values;
-
-    in >> type;
-    in >> startAddress;
-    in >> values;
-
-    frm->configureModbusDataUnit(type, startAddress, values);
+    if(data.IsMaximized) wnd->setWindowState(Qt::WindowMaximized);
+    else wnd->resize(data.WindowSize);
+
+    frm->setDisplayMode(data.Mode);
+    frm->setDataDisplayMode(data.DataMode);
+    frm->setDisplayHexAddresses(data.HexAddresses);
+    frm->setBackgroundColor(data.BackgroundColor);
+    frm->setForegroundColor(data.ForegroundColor);
+    frm->setStatusColor(data.StatusColor);
+    frm->setFont(data.Font);
+    frm->setDisplayDefinition(data.Definition);
+    frm->setByteOrder(data.Order);
+    frm->scriptControl()->restoreState(data.ScriptState);
+    frm->setScriptSettings(data.ScriptParams);
+
+    for(auto&& k : data.SimulationMap.keys())
+        frm->startSimulation(k.first, k.second, data.SimulationMap[k]);
+
+    for(auto&& k : data.DescriptionMap.keys())
+        frm->setDescription(k.first, k.second, data.DescriptionMap[k]);
+
+    frm->configureModbusDataUnit(data.UnitType, data.UnitAddress, data.UnitValues);
+
+    for(auto&& rule : data.SimulationRules)
+        frm->startRangeSimulation(rule);
+
+    if(data.RandomSeed != 0)
+        frm->setRandomSeed(data.RandomSeed);
 
     return in;
 }
@@ -0,0 +1,140 @@
+#ifndef FORMMODSIMDATA_H
+#define FORMMODSIMDATA_H
+
+#include <QSize>
+#include <QFont>
+#include <QColor>
+#include <QVariant>
+#include <QDataStream>
+#include <QVersionNumber>
+#include <QModbusDataUnit>
+#include "enums.h"
+#include "datasimulator.h"
+#include "displaydefinition.h"
+#include "scriptsettings.h"
+
+///
+/// \brief The AddressDescriptionMap type
+///
+typedef QMap<QPair<QModbusDataUnit::RegisterType, quint16>, QString> AddressDescriptionMap;
+
+///
+/// \brief The FormModSimData struct - contents of a form file after the form ID
+///
+/// Decoded by the form windows and by the headless server, which uses the simulation
+/// part only.
+///
+struct FormModSimData
+{
+    bool IsMaximized = false;
+    QSize WindowSize;
+    DisplayMode Mode = DisplayMode::Data;
+    DataDisplayMode DataMode = DataDisplayMode::Hex;
+    bool HexAddresses = false;
+    QColor BackgroundColor;
+    QColor ForegroundColor;
+    QColor StatusColor;
+    QFont Font;
+
+    DisplayDefinition Definition;
+    ByteOrder Order = ByteOrder::LittleEndian;
+    ModbusSimulationMap SimulationMap;
+    QMap<QString, QVariant> ScriptState;
+    ScriptSettings ScriptParams;
+    AddressDescriptionMap DescriptionMap;
+
+    QModbusDataUnit::RegisterType UnitType = QModbusDataUnit::Invalid;
+    int UnitAddress = 0;
+    QVector<quint16> UnitValues;
+
+    ModbusSimulationRules SimulationRules;
+    quint64 RandomSeed = 0;
+};
+
+///
+/// \brief readFormModSimData
+/// \param in
+/// \param ver - version of the form file, 1.0 to 1.10
+/// \param data
+/// \return
+///
+inline QDataStream& readFormModSimData(QDataStream& in, const QVersionNumber& ver, FormModSimData& data)
+{
+    in >> data.IsMaximized;
+    in >> data.WindowSize;
+    in >> data.Mode;
+    in >> data.DataMode;
+    in >> data.HexAddresses;
+    in >> data.BackgroundColor;
+    in >> data.ForegroundColor;
+    in >> data.StatusColor;
+    in >> data.Font;
+
+    auto& dd = data.Definition;
+    if(ver >= QVersionNumber(1, 5))
+    {
+        in >> dd.DeviceId;
+        in >> dd.PointType;
+        in >> dd.PointAddress;
+        in >> dd.Length;
+
+        quint16 logViewLimit;
+        in >> logViewLimit;
+        dd.LogViewLimit = logViewLimit;
+    }
+    if(ver >= QVersionNumber(1, 6))
+    {
+        in >> dd.ZeroBasedAddress;
+    }
+
+    if(ver >= QVersionNumber(1, 1))
+    {
+        in >> data.Order;
+        in >> data.SimulationMap;
+    }
+    if(ver < QVersionNumber(1, 7))
+    {
+        // simulation intervals were stored in seconds
+        for(auto&& params : data.SimulationMap)
+            params.Interval *= 1000;
+    }
+
+    if(ver >= QVersionNumber(1, 2))
+    {
+        in >> data.ScriptState;
+        in >> data.ScriptParams;
+    }
+
+    if(ver >= QVersionNumber(1, 3))
+    {
+        in >> data.DescriptionMap;
+    }
+
+    in >> data.UnitType;
+    in >> data.UnitAddress;
+    in >> data.UnitValues;
+
+    if(ver >= QVersionNumber(1, 8))
+    {
+        in >> data.SimulationRules;
+    }
+
+    if(ver >= QVersionNumber(1, 9))
+    {
+        in >> data.RandomSeed;
+    }
+
+    if(ver >= QVersionNumber(1, 10))
+    {
+        // log view limits beyond 1000 rows
+        quint32 logViewLimit;
+        in >> logViewLimit;
+
+        dd.LogViewLimit = logViewLimit;
+        dd.normalize();
+    }
+
+    return in;
+}
+
+#endif // FORMMODSIMDATA_H
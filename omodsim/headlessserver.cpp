@@ -0,0 +1,238 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QVersionNumber>
+#include "formmodsimdata.h"
+#include "headlessserver.h"
+
+///
+/// \brief HeadlessServer::HeadlessServer
+/// \param parent
+///
+HeadlessServer::HeadlessServer(QObject* parent)
+    : QObject(parent)
+    ,_dataSimulator(new DataSimulator(_mbMultiServer, this))
+{
+    connect(&_mbMultiServer, &ModbusMultiServer::connected, this, &HeadlessServer::on_mbConnected);
+    connect(&_mbMultiServer, &ModbusMultiServer::disconnected, this, &HeadlessServer::on_mbDisconnected);
+    connect(&_mbMultiServer, &ModbusMultiServer::connectionError, this, &HeadlessServer::on_mbConnectionError);
+}
+
+///
+/// \brief HeadlessServer::~HeadlessServer
+///
+HeadlessServer::~HeadlessServer()
+{
+    _dataSimulator->stopSimulations();
+}
+
+///
+/// \brief HeadlessServer::loadConfig
+/// \param filename
+/// \return
+///
+bool HeadlessServer::loadConfig(const QString& filename)
+{
+    // a scenario runs on its own, without a test config
+    if(QFileInfo(filename).suffix().compare("scn", Qt::CaseInsensitive) == 0)
+    {
+        ReplayParams params;
+        params.FileName = filename;
+        return startReplay(params);
+    }
+
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream s(&file);
+    s.setByteOrder(QDataStream::BigEndian);
+    s.setVersion(QDataStream::Version::Qt_5_0);
+
+    quint8 magic = 0;
+    s >> magic;
+
+    if(magic != 0x35)
+        return false;
+
+    QVersionNumber ver;
+    s >> ver;
+
+    if(ver < QVersionNumber(1, 0) || ver > QVersionNumber(1, 1))
+        return false;
+
+    QStringList listFilename;
+    s >> listFilename;
+
+    QList<ConnectionDetails> conns;
+    s >> conns;
+
+    ReplayParams replayParams;
+    if(ver >= QVersionNumber(1, 1))
+    {
+        s >> replayParams;
+    }
+
+    if(s.status() != QDataStream::Ok)
+        return false;
+
+    bool result = true;
+    for(auto&& filename: listFilename)
+    {
+        if(!filename.isEmpty())
+            result &= loadForm(filename);
+    }
+
+    for(auto&& cd : conns)
+        _mbMultiServer.connectDevice(cd);
+
+    if(!replayParams.FileName.isEmpty())
+        result &= startReplay(replayParams);
+
+    return result;
+}
+
+///
+/// \brief HeadlessServer::loadForm
+/// \param filename
+/// \return
+///
+bool HeadlessServer::loadForm(const QString& filename)
+{
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream s(&file);
+    s.setByteOrder(QDataStream::BigEndian);
+    s.setVersion(QDataStream::Version::Qt_5_0);
+
+    quint8 magic = 0;
+    s >> magic;
+
+    if(magic != 0x34)
+        return false;
+
+    QVersionNumber ver;
+    s >> ver;
+
+    int formId;
+    s >> formId;
+
+    // window, view and script settings are not used without user interface
+    FormModSimData data;
+    if(readFormModSimData(s, ver, data).status() != QDataStream::Ok)
+        return false;
+
+    const auto& dd = data.Definition;
+    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+    _mbMultiServer.addUnitMap(formId, dd.DeviceId, dd.PointType, addr, dd.Length);
+
+    QModbusDataUnit unit;
+    unit.setRegisterType(data.UnitType);
+    unit.setStartAddress(data.UnitAddress);
+    unit.setValues(data.UnitValues);
+    _mbMultiServer.setData(dd.DeviceId, unit);
+
+    if(data.RandomSeed != 0)
+        _dataSimulator->setRandomSeed(formId, dd.DeviceId, dd.PointType, addr, dd.Length, data.RandomSeed);
+
+    for(auto&& k : data.SimulationMap.keys())
+        _dataSimulator->startSimulation(dd.DeviceId, data.DataMode, data.Order, k.first, k.second, data.SimulationMap[k]);
+
+    for(auto rule : data.SimulationRules)
+    {
+        rule.DeviceId = dd.DeviceId;
+        _dataSimulator->startRangeSimulation(data.DataMode, data.Order, rule);
+    }
+
+    return true;
+}
+
+///
+/// \brief HeadlessServer::startReplay
+/// \param params
+/// \param errorString
+/// \return
+///
+bool HeadlessServer::startReplay(const ReplayParams& params, QString* errorString)
+{
+    return _dataSimulator->startReplay(params, errorString);
+}
+
+///
+/// \brief HeadlessServer::startPcapCapture
+/// \param params
+/// \param errorString
+/// \return
+///
+bool HeadlessServer::startPcapCapture(const PcapCaptureParams& params, QString* errorString)
+{
+    return _mbMultiServer.pcapWriter()->start(params, errorString);
+}
+
+///
+/// \brief HeadlessServer::startTrafficJournal
+/// \param params
+/// \param errorString
+/// \return
+///
+bool HeadlessServer::startTrafficJournal(const TrafficJournalParams& params, QString* errorString)
+{
+    return _mbMultiServer.trafficJournal()->open(params, errorString);
+}
+
+///
+/// \brief HeadlessServer::setTrafficFilter
+/// \param expression
+/// \param errorString
+/// \return
+///
+bool HeadlessServer::setTrafficFilter(const QString& expression, QString* errorString)
+{
+    return _mbMultiServer.trafficFilter()->compile(expression, errorString);
+}
+
+///
+/// \brief HeadlessServer::on_mbConnected
+/// \param cd
+///
+void HeadlessServer::on_mbConnected(const ConnectionDetails& cd)
+{
+    switch(cd.Type)
+    {
+        case ConnectionType::Tcp:
+            qInfo("Modbus/TCP Srv %s:%d started", qPrintable(cd.TcpParams.IPAddress), cd.TcpParams.ServicePort);
+        break;
+
+        case ConnectionType::Serial:
+            qInfo("Port %s opened", qPrintable(cd.SerialParams.PortName));
+        break;
+    }
+}
+
+///
+/// \brief HeadlessServer::on_mbDisconnected
+/// \param cd
+///
+void HeadlessServer::on_mbDisconnected(const ConnectionDetails& cd)
+{
+    switch(cd.Type)
+    {
+        case ConnectionType::Tcp:
+            qInfo("Modbus/TCP Srv %s:%d stopped", qPrintable(cd.TcpParams.IPAddress), cd.TcpParams.ServicePort);
+        break;
+
+        case ConnectionType::Serial:
+            qInfo("Port %s closed", qPrintable(cd.SerialParams.PortName));
+        break;
+    }
+}
+
+///
+/// \brief HeadlessServer::on_mbConnectionError
+/// \param error
+///
+void HeadlessServer::on_mbConnectionError(const QString& error)
+{
+    qWarning("%s", qPrintable(error));
+}
@@ -0,0 +1,37 @@
+#ifndef HEADLESSSERVER_H
+#define HEADLESSSERVER_H
+
+#include <QObject>
+#include "datasimulator.h"
+#include "displaydefinition.h"
+#include "modbusmultiserver.h"
+
+///
+/// \brief The HeadlessServer class
+///
+class HeadlessServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeadlessServer(QObject* parent = nullptr);
+    ~HeadlessServer() override;
+
+    bool loadConfig(const QString& filename);
+    bool loadForm(const QString& filename);
+    bool startReplay(const ReplayParams& params, QString* errorString = nullptr);
+    bool startPcapCapture(const PcapCaptureParams& params, QString* errorString = nullptr);
+    bool startTrafficJournal(const TrafficJournalParams& params, QString* errorString = nullptr);
+    bool setTrafficFilter(const QString& expression, QString* errorString = nullptr);
+
+private slots:
+    void on_mbConnected(const ConnectionDetails& cd);
+    void on_mbDisconnected(const ConnectionDetails& cd);
+    void on_mbConnectionError(const QString& error);
+
+private:
+    ModbusMultiServer _mbMultiServer;
+    QSharedPointer<DataSimulator> _dataSimulator;
+};
+
+#endif // HEADLESSSERVER_H
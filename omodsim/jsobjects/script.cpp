@@ -1,6 +1,6 @@
-#include <QTimer>
 #include <QJSValue>
 #include <QJSEngine>
+#include "simulationclock.h"
 #include "script.h"
 
 ///
@@ -57,10 +57,14 @@ void Script::setTimeout(const QJSValue& func, int timeout)
     if(!func.isCallable())
        return;
 
-    QTimer::singleShot(timeout, this, [func]
+    auto timer = new SimulationTimer(this);
+    timer->setSingleShot(true);
+    connect(timer, &SimulationTimer::timeout, this, [func, timer]
     {
+        timer->deleteLater();
         const_cast<QJSValue&>(func).call();
     });
+    timer->start(timeout);
 }
 
 ///
@@ -4,11 +4,13 @@
 ///
 /// \brief Server::Server
 /// \param server
+/// \param deviceId
 /// \param order
 /// \param base
 ///
-Server::Server(ModbusMultiServer* server, const ByteOrder* order, AddressBase base)
-    :_addressBase((Address::Base)base)
+Server::Server(ModbusMultiServer* server, quint8 deviceId, const ByteOrder* order, AddressBase base)
+    :_deviceId(deviceId)
+    ,_addressBase((Address::Base)base)
     ,_byteOrder(order)
     ,_mbMultiServer(server)
 {
@@ -52,7 +54,7 @@ void Server::setAddressBase(Address::Base base)
 quint16 Server::readHolding(quint16 address) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    const auto data = _mbMultiServer->data(QModbusDataUnit::HoldingRegisters, address, 1);
+    const auto data = _mbMultiServer->data(_deviceId, QModbusDataUnit::HoldingRegisters, address, 1);
     return toByteOrderValue(data.value(0), *_byteOrder);
 }
 
@@ -64,7 +66,7 @@ quint16 Server::readHolding(quint16 address) const
 void Server::writeHolding(quint16 address, quint16 value)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeValue(QModbusDataUnit::HoldingRegisters, address, value, *_byteOrder);
+    _mbMultiServer->writeValue(_deviceId, QModbusDataUnit::HoldingRegisters, address, value, *_byteOrder);
 }
 
 ///
@@ -75,7 +77,7 @@ void Server::writeHolding(quint16 address, quint16 value)
 quint16 Server::readInput(quint16 address) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    const auto data = _mbMultiServer->data(QModbusDataUnit::InputRegisters, address, 1);
+    const auto data = _mbMultiServer->data(_deviceId, QModbusDataUnit::InputRegisters, address, 1);
     return toByteOrderValue(data.value(0), *_byteOrder);
 }
 
@@ -87,7 +89,7 @@ quint16 Server::readInput(quint16 address) const
 void Server::writeInput(quint16 address, quint16 value)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeValue(QModbusDataUnit::InputRegisters, address, value, *_byteOrder);
+    _mbMultiServer->writeValue(_deviceId, QModbusDataUnit::InputRegisters, address, value, *_byteOrder);
 }
 
 ///
@@ -98,7 +100,7 @@ void Server::writeInput(quint16 address, quint16 value)
 bool Server::readDiscrete(quint16 address) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    const auto data = _mbMultiServer->data(QModbusDataUnit::DiscreteInputs, address, 1);
+    const auto data = _mbMultiServer->data(_deviceId, QModbusDataUnit::DiscreteInputs, address, 1);
     return toByteOrderValue(data.value(0), *_byteOrder);
 }
 
@@ -110,7 +112,7 @@ bool Server::readDiscrete(quint16 address) const
 void Server::writeDiscrete(quint16 address, bool value)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeValue(QModbusDataUnit::DiscreteInputs, address, value, *_byteOrder);
+    _mbMultiServer->writeValue(_deviceId, QModbusDataUnit::DiscreteInputs, address, value, *_byteOrder);
 }
 
 ///
@@ -121,7 +123,7 @@ void Server::writeDiscrete(quint16 address, bool value)
 bool Server::readCoil(quint16 address) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    const auto data = _mbMultiServer->data(QModbusDataUnit::Coils, address, 1);
+    const auto data = _mbMultiServer->data(_deviceId, QModbusDataUnit::Coils, address, 1);
     return toByteOrderValue(data.value(0), *_byteOrder);
 }
 
@@ -133,7 +135,7 @@ bool Server::readCoil(quint16 address) const
 void Server::writeCoil(quint16 address, bool value)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeValue(QModbusDataUnit::Coils, address, value, *_byteOrder);
+    _mbMultiServer->writeValue(_deviceId, QModbusDataUnit::Coils, address, value, *_byteOrder);
 }
 
 ///
@@ -146,7 +148,7 @@ void Server::writeCoil(quint16 address, bool value)
 qint32 Server::readInt32(Register::Type reg, quint16 address, bool swapped) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    return _mbMultiServer->readInt32((QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
+    return _mbMultiServer->readInt32(_deviceId, (QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
 }
 
 ///
@@ -159,7 +161,7 @@ qint32 Server::readInt32(Register::Type reg, quint16 address, bool swapped) cons
 void Server::writeInt32(Register::Type reg, quint16 address, qint32 value, bool swapped)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeInt32((QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
+    _mbMultiServer->writeInt32(_deviceId, (QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
 }
 
 ///
@@ -172,7 +174,7 @@ void Server::writeInt32(Register::Type reg, quint16 address, qint32 value, bool
 quint32 Server::readUInt32(Register::Type reg, quint16 address, bool swapped) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    return _mbMultiServer->readUInt32((QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
+    return _mbMultiServer->readUInt32(_deviceId, (QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
 }
 
 ///
@@ -185,7 +187,7 @@ quint32 Server::readUInt32(Register::Type reg, quint16 address, bool swapped) co
 void Server::writeUInt32(Register::Type reg, quint16 address, quint32 value, bool swapped)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeUInt32((QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
+    _mbMultiServer->writeUInt32(_deviceId, (QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
 }
 
 ///
@@ -198,7 +200,7 @@ void Server::writeUInt32(Register::Type reg, quint16 address, quint32 value, boo
 qint64 Server::readInt64(Register::Type reg, quint16 address, bool swapped) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    return _mbMultiServer->readInt64((QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
+    return _mbMultiServer->readInt64(_deviceId, (QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
 }
 
 ///
@@ -211,7 +213,7 @@ qint64 Server::readInt64(Register::Type reg, quint16 address, bool swapped) cons
 void Server::writeInt64(Register::Type reg, quint16 address, qint64 value, bool swapped)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeInt64((QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
+    _mbMultiServer->writeInt64(_deviceId, (QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
 }
 
 ///
@@ -224,7 +226,7 @@ void Server::writeInt64(Register::Type reg, quint16 address, qint64 value, bool
 quint64 Server::readUInt64(Register::Type reg, quint16 address, bool swapped) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    return _mbMultiServer->readUInt64((QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
+    return _mbMultiServer->readUInt64(_deviceId, (QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
 }
 
 ///
@@ -237,7 +239,7 @@ quint64 Server::readUInt64(Register::Type reg, quint16 address, bool swapped) co
 void Server::writeUInt64(Register::Type reg, quint16 address, quint64 value, bool swapped)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeUInt64((QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
+    _mbMultiServer->writeUInt64(_deviceId, (QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
 }
 
 ///
@@ -250,7 +252,7 @@ void Server::writeUInt64(Register::Type reg, quint16 address, quint64 value, boo
 float Server::readFloat(Register::Type reg, quint16 address, bool swapped) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    return _mbMultiServer->readFloat((QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
+    return _mbMultiServer->readFloat(_deviceId, (QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
 }
 
 ///
@@ -263,7 +265,7 @@ float Server::readFloat(Register::Type reg, quint16 address, bool swapped) const
 void Server::writeFloat(Register::Type reg, quint16 address, float value, bool swapped)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeFloat((QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
+    _mbMultiServer->writeFloat(_deviceId, (QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
 }
 
 ///
@@ -276,7 +278,7 @@ void Server::writeFloat(Register::Type reg, quint16 address, float value, bool s
 double Server::readDouble(Register::Type reg, quint16 address, bool swapped) const
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    return _mbMultiServer->readDouble((QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
+    return _mbMultiServer->readDouble(_deviceId, (QModbusDataUnit::RegisterType)reg, address, *_byteOrder, swapped);
 }
 
 ///
@@ -289,7 +291,7 @@ double Server::readDouble(Register::Type reg, quint16 address, bool swapped) con
 void Server::writeDouble(Register::Type reg, quint16 address, double value, bool swapped)
 {
     address -= _addressBase == Address::Base::Base0 ? 0 : 1;
-    _mbMultiServer->writeDouble((QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
+    _mbMultiServer->writeDouble(_deviceId, (QModbusDataUnit::RegisterType)reg, address, value, *_byteOrder, swapped);
 }
 
 ///
@@ -308,10 +310,14 @@ void Server::onChange(Register::Type reg, quint16 address, const QJSValue& func)
 
 ///
 /// \brief Server::on_dataChanged
+/// \param deviceId
 /// \param data
 ///
-void Server::on_dataChanged(const QModbusDataUnit& data)
+void Server::on_dataChanged(quint8 deviceId, const QModbusDataUnit& data)
 {
+    if(deviceId != _deviceId)
+        return;
+
     const auto reg = (Register::Type)data.registerType();
     for(uint i = 0; i < data.valueCount(); i++)
     {
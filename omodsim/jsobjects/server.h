@@ -37,7 +37,7 @@ class Server : public QObject
     Q_OBJECT
 
 public:
-    explicit Server(ModbusMultiServer* server, const ByteOrder* order, AddressBase base);
+    explicit Server(ModbusMultiServer* server, quint8 deviceId, const ByteOrder* order, AddressBase base);
     ~Server() override;
 
     Q_PROPERTY(Address::Base addressBase READ addressBase WRITE setAddressBase);
@@ -80,9 +80,10 @@ public slots:
     void setAddressBase(Address::Base base);
 
 private slots:
-    void on_dataChanged(const QModbusDataUnit& data);
+    void on_dataChanged(quint8 deviceId, const QModbusDataUnit& data);
 
 private:
+    quint8 _deviceId;
     Address::Base _addressBase;
     const ByteOrder* _byteOrder;
     ModbusMultiServer* _mbMultiServer;
@@ -1,7 +1,15 @@
 #include <QApplication>
 #include <QFontDatabase>
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <QSocketNotifier>
+#endif
 #include "mainwindow.h"
 #include "cmdlineparser.h"
+#include "headlessserver.h"
+#include "trafficutils.h"
 
 ///
 /// \brief showVersion
@@ -30,6 +38,101 @@ static void showErrorMessage(const QString &message)
     fputs(qPrintable(message), stderr);
 }
 
+///
+/// \brief queryJournal - prints the matching journal frames to the standard output
+/// \param parser
+/// \return
+///
+static int queryJournal(const CmdLineParser& parser)
+{
+    TrafficJournalQuery query;
+    if(parser.isSet(CmdLineParser::_from))
+        query.From = QDateTime::fromString(parser.value(CmdLineParser::_from), Qt::ISODateWithMs);
+    if(parser.isSet(CmdLineParser::_to))
+        query.To = QDateTime::fromString(parser.value(CmdLineParser::_to), Qt::ISODateWithMs);
+
+    bool okCodes, okIds;
+    query.FunctionCodes = parseNumbers(parser.value(CmdLineParser::_function), &okCodes);
+    query.DeviceIds = parseNumbers(parser.value(CmdLineParser::_unit), &okIds);
+    const bool okAddress = parseRange(parser.value(CmdLineParser::_address), &query.FromAddress, &query.ToAddress);
+
+    const bool okTime = (!parser.isSet(CmdLineParser::_from) || query.From.isValid()) &&
+                        (!parser.isSet(CmdLineParser::_to) || query.To.isValid());
+    if(!okCodes || !okIds || !okAddress || !okTime)
+    {
+        showErrorMessage("Invalid query\n");
+        return EXIT_FAILURE;
+    }
+
+    QString error;
+    const auto directory = parser.value(CmdLineParser::_query);
+    const auto count = ModbusTrafficJournal::query(directory, query, [](const TrafficJournalFrame& frame)
+    {
+        const auto code = QModbusPdu::FunctionCode(quint8(frame.Pdu[0]));
+        const auto data = frame.Pdu.mid(1);
+        const QScopedPointer<const ModbusMessage> msg(frame.Request ?
+            ModbusMessage::create(QModbusRequest(code, data), frame.Protocol, frame.DeviceId, frame.dateTime(), true) :
+            ModbusMessage::create(QModbusResponse(code, data), frame.Protocol, frame.DeviceId, frame.dateTime(), false));
+
+        if(frame.Protocol == ModbusMessage::Tcp)
+            ((QModbusAduTcp*)msg->adu())->setTransactionId(frame.TransactionId);
+
+        const auto str = QString("%1: %2 %3 %4\n").arg(
+            (frame.Request ? "Tx" : "Rx"),
+            frame.dateTime().toString(Qt::ISODateWithMs),
+            (frame.Request ? "<<" : ">>"),
+            msg->toString(DataDisplayMode::Hex));
+        fputs(qPrintable(str), stdout);
+        return true;
+    }, &error);
+
+    if(count < 0)
+    {
+        showErrorMessage(QString("Failed to query %1: %2\n").arg(directory, error));
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+#ifdef Q_OS_UNIX
+///
+/// \brief quitSignalFd - socket pair written from the signal handler
+///
+static int quitSignalFd[2];
+
+///
+/// \brief quitSignalHandler
+///
+static void quitSignalHandler(int)
+{
+    const char c = 1;
+    const auto written = ::write(quitSignalFd[0], &c, sizeof(c));
+    Q_UNUSED(written)
+}
+
+///
+/// \brief installQuitHandler - SIGINT and SIGTERM leave the event loop, so destructors run
+/// \param app
+///
+static void installQuitHandler(QCoreApplication* app)
+{
+    if(::socketpair(AF_UNIX, SOCK_STREAM, 0, quitSignalFd) != 0)
+        return;
+
+    auto notifier = new QSocketNotifier(quitSignalFd[1], QSocketNotifier::Read, app);
+    QObject::connect(notifier, QOverload<QSocketDescriptor, QSocketNotifier::Type>::of(&QSocketNotifier::activated), app, &QCoreApplication::quit);
+
+    struct sigaction action = {};
+    action.sa_handler = quitSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+#endif
+
 ///
 /// \brief main
 /// \param argc
@@ -38,13 +141,13 @@ static void showErrorMessage(const QString &message)
 ///
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
-    a.setApplicationName(APP_NAME);
-    a.setApplicationVersion(APP_VERSION);
-    QFontDatabase::addApplicationFont(":/fonts/firacode.ttf");
+    const bool headless = CmdLineParser::isHeadless(argc, argv);
+    QScopedPointer<QCoreApplication> a(headless ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
+    a->setApplicationName(APP_NAME);
+    a->setApplicationVersion(APP_VERSION);
 
     CmdLineParser parser;
-    if(!parser.parse(a.arguments()))
+    if(!parser.parse(a->arguments()))
     {
         showErrorMessage(parser.errorText() + QLatin1Char('\n'));
         return EXIT_FAILURE;
@@ -62,12 +165,121 @@ int main(int argc, char *argv[])
         return EXIT_SUCCESS;
     }
 
+    if(parser.isSet(CmdLineParser::_query))
+    {
+        return queryJournal(parser);
+    }
+
+    if(parser.isSet(CmdLineParser::_updateRate))
+    {
+        ModbusMultiServer::setUpdateRate(parser.value(CmdLineParser::_updateRate).toInt());
+    }
+
+    if(parser.isSet(CmdLineParser::_stats))
+    {
+        ModbusMultiServer::setStatisticsFile(parser.value(CmdLineParser::_stats));
+    }
+
+    if(parser.isSet(CmdLineParser::_clockRate))
+    {
+        SimulationClock::instance()->setRate(parser.value(CmdLineParser::_clockRate).toDouble());
+    }
+
+#ifdef Q_OS_LINUX
+    if(parser.isSet(CmdLineParser::_epoll))
+    {
+        ModbusMultiServer::setEpollEnabled(true);
+    }
+#endif
+
     QString cfg;
     if(parser.isSet(CmdLineParser::_config))
     {
         cfg = parser.value(CmdLineParser::_config);
     }
 
+    if(headless)
+    {
+        HeadlessServer server;
+        if(!cfg.isEmpty() && !server.loadConfig(cfg))
+        {
+            showErrorMessage(QString("Failed to load config %1\n").arg(cfg));
+            return EXIT_FAILURE;
+        }
+
+        for(auto&& filename : parser.positionalArguments())
+        {
+            if(!server.loadForm(filename))
+            {
+                showErrorMessage(QString("Failed to open %1\n").arg(filename));
+                return EXIT_FAILURE;
+            }
+        }
+
+        if(parser.isSet(CmdLineParser::_replay))
+        {
+            ReplayParams params;
+            params.FileName = parser.value(CmdLineParser::_replay);
+            params.Loop = parser.isSet(CmdLineParser::_replayLoop);
+            if(parser.isSet(CmdLineParser::_replayRate))
+                params.Rate = parser.value(CmdLineParser::_replayRate).toDouble();
+
+            QString error;
+            if(!server.startReplay(params, &error))
+            {
+                showErrorMessage(QString("Failed to replay %1: %2\n").arg(params.FileName, error));
+                return EXIT_FAILURE;
+            }
+        }
+
+        if(parser.isSet(CmdLineParser::_logFilter))
+        {
+            QString error;
+            if(!server.setTrafficFilter(parser.value(CmdLineParser::_logFilter), &error))
+            {
+                showErrorMessage(QString("%1\n").arg(error));
+                return EXIT_FAILURE;
+            }
+        }
+
+        if(parser.isSet(CmdLineParser::_pcap))
+        {
+            PcapCaptureParams params;
+            params.FileName = parser.value(CmdLineParser::_pcap);
+            params.MaxFileSize = qint64(parser.value(CmdLineParser::_pcapSize).toDouble() * 1024 * 1024);
+            params.MaxFileDuration = parser.value(CmdLineParser::_pcapTime).toInt();
+
+            QString error;
+            if(!server.startPcapCapture(params, &error))
+            {
+                showErrorMessage(QString("Failed to capture to %1: %2\n").arg(params.FileName, error));
+                return EXIT_FAILURE;
+            }
+        }
+
+        if(parser.isSet(CmdLineParser::_journal))
+        {
+            TrafficJournalParams params;
+            params.Directory = parser.value(CmdLineParser::_journal);
+            if(parser.isSet(CmdLineParser::_journalSize))
+                params.MaxSegmentSize = qint64(parser.value(CmdLineParser::_journalSize).toDouble() * 1024 * 1024);
+
+            QString error;
+            if(!server.startTrafficJournal(params, &error))
+            {
+                showErrorMessage(QString("Failed to open journal %1: %2\n").arg(params.Directory, error));
+                return EXIT_FAILURE;
+            }
+        }
+
+#ifdef Q_OS_UNIX
+        installQuitHandler(a.data());
+#endif
+        return a->exec();
+    }
+
+    QFontDatabase::addApplicationFont(":/fonts/firacode.ttf");
+
     MainWindow w;
     if(!cfg.isEmpty())
     {
@@ -75,5 +287,5 @@ int main(int argc, char *argv[])
     }
     w.show();
 
-    return a.exec();
+    return a->exec();
 }
@@ -10,9 +10,13 @@
 #include "dialogselectserviceport.h"
 #include "dialogsetupserialport.h"
 #include "dialogsetuppresetdata.h"
+#include "dialograngesimulation.h"
+#include "dialogautosimulation.h"
+#include "dialogcoilsimulation.h"
 #include "dialogscriptsettings.h"
 #include "dialogforcemultiplecoils.h"
 #include "dialogforcemultipleregisters.h"
+#include "dialogtraffichistory.h"
 #include "runmodecombobox.h"
 #include "searchlineedit.h"
 #include "mainstatusbar.h"
@@ -31,7 +35,7 @@ MainWindow::MainWindow(QWidget *parent)
     ,_icoBigEndian(":/res/actionBigEndian.png")
     ,_icoLittleEndian(":/res/actionLittleEndian.png")
     ,_windowCounter(0)
-    ,_dataSimulator(new DataSimulator(this))
+    ,_dataSimulator(new DataSimulator(_mbMultiServer, this))
 {
     ui->setupUi(this);
 
@@ -205,11 +209,17 @@ void MainWindow::on_awake()
     ui->actionDblFloat->setEnabled(frm != nullptr);
     ui->actionSwappedDbl->setEnabled(frm != nullptr);
     ui->actionByteOrder->setEnabled(frm != nullptr);
+    ui->actionRandomSeed->setEnabled(frm != nullptr);
 
     ui->actionRunScript->setEnabled(frm && frm->canRunScript());
     ui->actionStopScript->setEnabled(frm && frm->canStopScript());
     ui->actionScriptSettings->setEnabled(frm && !frm->canStopScript());
     _actionRunMode->setEnabled(frm && !frm->canStopScript());
+    ui->actionStopReplay->setEnabled(_dataSimulator->isReplaying());
+    ui->actionPcapCapture->setEnabled(!_mbMultiServer.pcapWriter()->isRunning());
+    ui->actionPcapCaptureOff->setEnabled(_mbMultiServer.pcapWriter()->isRunning());
+    ui->actionTrafficJournal->setEnabled(!_mbMultiServer.trafficJournal()->isOpen());
+    ui->actionTrafficJournalOff->setEnabled(_mbMultiServer.trafficJournal()->isOpen());
 
     ui->actionToolbar->setChecked(ui->toolBarMain->isVisible());
     ui->actionStatusBar->setChecked(statusBar()->isVisible());
@@ -702,6 +712,148 @@ void MainWindow::on_actionPresetHoldingRegs_triggered()
     presetRegs(QModbusDataUnit::HoldingRegisters);
 }
 
+///
+/// \brief MainWindow::on_actionRangeSimulation_triggered
+///
+void MainWindow::on_actionRangeSimulation_triggered()
+{
+    auto frm = currentMdiChild();
+    if(!frm) return;
+
+    const auto dd = frm->displayDefinition();
+    const auto rules = frm->simulationRules();
+
+    ModbusSimulationRule rule;
+    if(!rules.isEmpty())
+    {
+        rule = rules.first();
+    }
+    else
+    {
+        rule.Type = dd.PointType;
+        rule.Address = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+        rule.Length = dd.Length;
+    }
+
+    {
+        DialogRangeSimulation dlg(rule, dd.ZeroBasedAddress, this);
+        if(dlg.exec() != QDialog::Accepted) return;
+    }
+
+    switch(rule.Type)
+    {
+        case QModbusDataUnit::Coils:
+        case QModbusDataUnit::DiscreteInputs:
+        {
+            DialogCoilSimulation dlg(rule.Params, this);
+            if(dlg.exec() != QDialog::Accepted) return;
+        }
+        break;
+
+        default:
+        {
+            DialogAutoSimulation dlg(frm->dataDisplayMode(), rule.Params, this);
+            if(dlg.exec() != QDialog::Accepted) return;
+        }
+        break;
+    }
+
+    if(rule.Params.Mode == SimulationMode::No)
+        frm->stopRangeSimulation(rule.Type, rule.Address, rule.Length);
+    else
+        frm->startRangeSimulation(rule);
+}
+
+///
+/// \brief MainWindow::on_actionRandomSeed_triggered
+///
+void MainWindow::on_actionRandomSeed_triggered()
+{
+    auto frm = currentMdiChild();
+    if(!frm) return;
+
+    QInputDialog dlg(this);
+    dlg.setWindowTitle(tr("Random Seed"));
+    dlg.setLabelText(tr("Seed of random simulations (0 - random on every run):"));
+    dlg.setTextValue(QString::number(frm->randomSeed()));
+    if(dlg.exec() != QDialog::Accepted)
+        return;
+
+    bool ok;
+    const auto seed = dlg.textValue().toULongLong(&ok);
+    if(ok) frm->setRandomSeed(seed);
+}
+
+///
+/// \brief MainWindow::on_actionReplayRecording_triggered
+///
+void MainWindow::on_actionReplayRecording_triggered()
+{
+    const auto filename = QFileDialog::getOpenFileName(this, QString(), QString(), tr("Recordings (*.csv *.omsr);;All files (*)"));
+    if(filename.isEmpty()) return;
+
+    ReplayParams params;
+    params.FileName = filename;
+
+    auto frm = currentMdiChild();
+    if(frm) params.Order = frm->byteOrder();
+
+    QString error;
+    if(!_dataSimulator->startReplay(params, &error))
+        QMessageBox::warning(this, windowTitle(), QString(tr("Failed to replay %1: %2")).arg(filename, error));
+}
+
+///
+/// \brief MainWindow::on_actionRunScenario_triggered
+///
+void MainWindow::on_actionRunScenario_triggered()
+{
+    const auto filename = QFileDialog::getOpenFileName(this, QString(), QString(), tr("Scenarios (*.scn);;All files (*)"));
+    if(filename.isEmpty()) return;
+
+    ReplayParams params;
+    params.FileName = filename;
+
+    auto frm = currentMdiChild();
+    if(frm) params.Order = frm->byteOrder();
+
+    QString error;
+    if(!_dataSimulator->startReplay(params, &error))
+        QMessageBox::warning(this, windowTitle(), QString(tr("Failed to run scenario %1: %2")).arg(filename, error));
+}
+
+///
+/// \brief MainWindow::on_actionStopReplay_triggered
+///
+void MainWindow::on_actionStopReplay_triggered()
+{
+    _dataSimulator->stopReplay();
+}
+
+///
+/// \brief MainWindow::on_actionClockSpeed_triggered
+///
+void MainWindow::on_actionClockSpeed_triggered()
+{
+    auto clock = SimulationClock::instance();
+
+    bool ok;
+    const auto rate = QInputDialog::getDouble(this, tr("Clock Speed"), tr("Speed of the simulation clock (0 - stopped, step by hand):"),
+                                              clock->rate(), 0, 1000000, 2, &ok);
+    if(ok) clock->setRate(rate);
+}
+
+///
+/// \brief MainWindow::on_actionStepClock_triggered
+///
+void MainWindow::on_actionStepClock_triggered()
+{
+    bool ok;
+    const auto seconds = QInputDialog::getDouble(this, tr("Step Clock"), tr("Seconds to move the simulation clock forward:"),
+                                                 1, 0, 31536000, 3, &ok);
+    if(ok) SimulationClock::instance()->step(qRound64(seconds * 1000));
+}
+
 ///
 /// \brief MainWindow::on_actionMsgParser_triggered
 ///
@@ -742,6 +894,97 @@ void MainWindow::on_actionCaptureOff_triggered()
     frm->stopTextCapture();
 }
 
+///
+/// \brief MainWindow::on_actionPcapCapture_triggered
+///
+void MainWindow::on_actionPcapCapture_triggered()
+{
+    auto filename = QFileDialog::getSaveFileName(this, QString(), QString(), tr("Pcapng files (*.pcapng)"));
+    if(filename.isEmpty()) return;
+    if(!filename.endsWith(".pcapng", Qt::CaseInsensitive)) filename += ".pcapng";
+
+    bool ok;
+    const auto size = QInputDialog::getInt(this, tr("Pcapng Capture"), tr("Start a new file every N megabytes (0 - one file):"),
+                                           0, 0, 1000000, 1, &ok);
+    if(!ok) return;
+
+    PcapCaptureParams params;
+    params.FileName = filename;
+    params.MaxFileSize = qint64(size) * 1024 * 1024;
+
+    QString error;
+    if(!_mbMultiServer.pcapWriter()->start(params, &error))
+        QMessageBox::warning(this, windowTitle(), QString(tr("Failed to capture to %1: %2")).arg(filename, error));
+}
+
+///
+/// \brief MainWindow::on_actionPcapCaptureOff_triggered
+///
+void MainWindow::on_actionPcapCaptureOff_triggered()
+{
+    _mbMultiServer.pcapWriter()->stop();
+}
+
+///
+/// \brief MainWindow::on_actionTrafficJournal_triggered
+///
+void MainWindow::on_actionTrafficJournal_triggered()
+{
+    const auto dir = QFileDialog::getExistingDirectory(this, tr("Traffic Journal Directory"));
+    if(dir.isEmpty()) return;
+
+    TrafficJournalParams params;
+    params.Directory = dir;
+
+    QString error;
+    if(!_mbMultiServer.trafficJournal()->open(params, &error))
+        QMessageBox::warning(this, windowTitle(), QString(tr("Failed to open journal %1: %2")).arg(dir, error));
+}
+
+///
+/// \brief MainWindow::on_actionTrafficJournalOff_triggered
+///
+void MainWindow::on_actionTrafficJournalOff_triggered()
+{
+    _mbMultiServer.trafficJournal()->close();
+}
+
+///
+/// \brief MainWindow::on_actionTrafficHistory_triggered
+///
+void MainWindow::on_actionTrafficHistory_triggered()
+{
+    auto journal = _mbMultiServer.trafficJournal();
+    const auto dir = journal->isOpen() ? journal->params().Directory :
+                                         QFileDialog::getExistingDirectory(this, tr("Traffic Journal Directory"));
+    if(dir.isEmpty()) return;
+
+    auto frm = currentMdiChild();
+    const auto mode = frm ? frm->dataDisplayMode() : DataDisplayMode::Hex;
+
+    auto dlg = new DialogTrafficHistory(dir, journal, mode, this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose, true);
+    dlg->show();
+}
+
+///
+/// \brief MainWindow::on_actionTrafficFilter_triggered
+///
+void MainWindow::on_actionTrafficFilter_triggered()
+{
+    auto filter = _mbMultiServer.trafficFilter();
+
+    bool ok;
+    const auto expression = QInputDialog::getText(this, tr("Traffic Filter"),
+                                                  tr("Log only matching frames (empty - all frames),\ne.g. fc=15,16;unit=1;addr=4000-4100;sample=10 or exceptions:"),
+                                                  QLineEdit::Normal, filter->expression(), &ok);
+    if(!ok) return;
+
+    QString error;
+    if(!filter->compile(expression, &error))
+        QMessageBox::warning(this, windowTitle(), error);
+}
+
 ///
 /// \brief MainWindow::on_actionToolbar_triggered
 ///
@@ -1050,14 +1293,14 @@ void MainWindow::forceCoils(QModbusDataUnit::RegisterType type)
 
     if(dd.PointType == type)
     {
-        const auto data = _mbMultiServer.data(type, presetParams.PointAddress - (dd.ZeroBasedAddress ? 0 : 1), presetParams.Length);
+        const auto data = _mbMultiServer.data(dd.DeviceId, type, presetParams.PointAddress - (dd.ZeroBasedAddress ? 0 : 1), presetParams.Length);
         params.Value = QVariant::fromValue(data.values());
     }
 
     DialogForceMultipleCoils dlg(params, type, presetParams.Length, this);
     if(dlg.exec() == QDialog::Accepted)
     {
-        _mbMultiServer.writeRegister(type, params);
+        _mbMultiServer.writeRegister(dd.DeviceId, type, params);
     }
 }
 
@@ -1086,14 +1329,14 @@ void MainWindow::presetRegs(QModbusDataUnit::RegisterType type)
 
     if(dd.PointType == type)
     {
-        const auto data = _mbMultiServer.data(type, presetParams.PointAddress - (dd.ZeroBasedAddress ? 0 : 1), presetParams.Length);
+        const auto data = _mbMultiServer.data(dd.DeviceId, type, presetParams.PointAddress - (dd.ZeroBasedAddress ? 0 : 1), presetParams.Length);
         params.Value = QVariant::fromValue(data.values());
     }
 
     DialogForceMultipleRegisters dlg(params, type, presetParams.Length, this);
     if(dlg.exec() == QDialog::Accepted)
     {
-        _mbMultiServer.writeRegister(type, params);
+        _mbMultiServer.writeRegister(dd.DeviceId, type, params);
     }
 }
 
@@ -1225,6 +1468,18 @@ FormModSim* MainWindow::firstMdiChild() const
 ///
 void MainWindow::loadConfig(const QString& filename)
 {
+    // a scenario runs on its own, without a test config
+    if(QFileInfo(filename).suffix().compare("scn", Qt::CaseInsensitive) == 0)
+    {
+        ReplayParams params;
+        params.FileName = filename;
+
+        QString error;
+        if(!_dataSimulator->startReplay(params, &error))
+            QMessageBox::warning(this, windowTitle(), QString(tr("Failed to run scenario %1: %2")).arg(filename, error));
+        return;
+    }
+
     QFile file(filename);
     if(!file.open(QFile::ReadOnly))
         return;
@@ -1242,7 +1497,7 @@ void MainWindow::loadConfig(const QString& filename)
     QVersionNumber ver;
     s >> ver;
 
-    if(ver != QVersionNumber(1, 0))
+    if(ver < QVersionNumber(1, 0) || ver > QVersionNumber(1, 1))
         return;
 
     QStringList listFilename;
@@ -1251,6 +1506,12 @@ void MainWindow::loadConfig(const QString& filename)
     QList<ConnectionDetails> conns;
     s >> conns;
 
+    ReplayParams replayParams;
+    if(ver >= QVersionNumber(1, 1))
+    {
+        s >> replayParams;
+    }
+
     if(s.status() != QDataStream::Ok)
         return;
 
@@ -1270,6 +1531,10 @@ void MainWindow::loadConfig(const QString& filename)
         if(!filename.isEmpty())
             openFile(filename);
     }
+
+    QString error;
+    if(!replayParams.FileName.isEmpty() && !_dataSimulator->startReplay(replayParams, &error))
+        QMessageBox::warning(this, windowTitle(), QString(tr("Failed to replay %1: %2")).arg(replayParams.FileName, error));
 }
 
 ///
@@ -1303,13 +1568,16 @@ void MainWindow::saveConfig(const QString& filename)
     s << (quint8)0x35;
 
     // version number
-    s << QVersionNumber(1, 0);
+    s << QVersionNumber(1, 1);
 
     // list of files
     s << listFilename;
 
     // connections
     s << _mbMultiServer.connections();
+
+    // running replay or scenario
+    s << (_dataSimulator->isReplaying() ? _dataSimulator->replayParams() : ReplayParams());
 }
 
 ///
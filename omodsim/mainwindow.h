@@ -95,9 +95,22 @@ private slots:
     void on_actionForceDiscretes_triggered();
     void on_actionPresetInputRegs_triggered();
     void on_actionPresetHoldingRegs_triggered();
+    void on_actionRangeSimulation_triggered();
+    void on_actionRandomSeed_triggered();
+    void on_actionReplayRecording_triggered();
+    void on_actionRunScenario_triggered();
+    void on_actionStopReplay_triggered();
+    void on_actionClockSpeed_triggered();
+    void on_actionStepClock_triggered();
     void on_actionMsgParser_triggered();
     void on_actionTextCapture_triggered();
     void on_actionCaptureOff_triggered();
+    void on_actionPcapCapture_triggered();
+    void on_actionPcapCaptureOff_triggered();
+    void on_actionTrafficJournal_triggered();
+    void on_actionTrafficJournalOff_triggered();
+    void on_actionTrafficHistory_triggered();
+    void on_actionTrafficFilter_triggered();
 
     /* View menu slots */
     void on_actionToolbar_triggered();
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include "modbusdatacoalescer.h"
+#include "modbusdataunitmap.h"
+
+///
+/// \brief WordBits
+///
+static constexpr int WordBits = 64;
+
+///
+/// \brief ModbusDataCoalescer::markDirty
+/// \param deviceId
+/// \param pointType
+/// \param pointAddress
+/// \param length
+///
+void ModbusDataCoalescer::markDirty(quint8 deviceId, QModbusDataUnit::RegisterType pointType, int pointAddress, int length)
+{
+    const int first = qMax(0, pointAddress);
+    const int last = qMin(pointAddress + length, ModbusDataUnitMap::TableSize) - 1;
+    if(first > last)
+        return;
+
+    auto& bitmap = _bitmaps[deviceId << 8 | pointType];
+    if(bitmap.Words.empty())
+        bitmap.Words.resize(ModbusDataUnitMap::TableSize / WordBits);
+
+    const int firstWord = first / WordBits;
+    const int lastWord = last / WordBits;
+    for(int i = firstWord; i <= lastWord; i++)
+    {
+        const int lo = (i == firstWord) ? first % WordBits : 0;
+        const int hi = (i == lastWord) ? last % WordBits : WordBits - 1;
+        const quint64 mask = (hi - lo == WordBits - 1) ? ~quint64(0) : ((quint64(1) << (hi - lo + 1)) - 1) << lo;
+        bitmap.Words[i] |= mask;
+    }
+
+    bitmap.FirstWord = qMin(bitmap.FirstWord, firstWord);
+    bitmap.LastWord = qMax(bitmap.LastWord, lastWord);
+    _empty = false;
+}
+
+///
+/// \brief ModbusDataCoalescer::takeDirtyRanges
+/// \return merged runs of changed registers, bitmaps are cleared
+///
+QVector<ModbusDataCoalescer::DirtyRange> ModbusDataCoalescer::takeDirtyRanges()
+{
+    QVector<DirtyRange> ranges;
+    for(auto it = _bitmaps.begin(); it != _bitmaps.end(); ++it)
+    {
+        const quint8 deviceId = it.key() >> 8;
+        const auto pointType = (QModbusDataUnit::RegisterType)(it.key() & 0xFF);
+        auto& bitmap = it.value();
+        if(bitmap.LastWord < 0)
+            continue;
+
+        int start = -1;
+        for(int i = bitmap.FirstWord; i <= bitmap.LastWord; i++)
+        {
+            const auto word = bitmap.Words[i];
+
+            int bit = 0;
+            while(bit < WordBits)
+            {
+                // next set bit outside a run, next clear bit inside it
+                const auto edges = ((start < 0) ? word : ~word) & (~quint64(0) << bit);
+                if(edges == 0)
+                    break;
+
+                bit = qCountTrailingZeroBits(edges);
+                const int addr = i * WordBits + bit;
+                if(start < 0)
+                {
+                    start = addr;
+                }
+                else
+                {
+                    ranges.push_back({ deviceId, pointType, start, addr - start });
+                    start = -1;
+                }
+            }
+        }
+
+        if(start >= 0)
+            ranges.push_back({ deviceId, pointType, start, (bitmap.LastWord + 1) * WordBits - start });
+
+        std::fill(bitmap.Words.begin() + bitmap.FirstWord, bitmap.Words.begin() + bitmap.LastWord + 1, 0);
+        bitmap.FirstWord = INT_MAX;
+        bitmap.LastWord = -1;
+    }
+
+    _empty = true;
+    return ranges;
+}
@@ -0,0 +1,49 @@
+#ifndef MODBUSDATACOALESCER_H
+#define MODBUSDATACOALESCER_H
+
+#include <vector>
+#include <climits>
+#include <QHash>
+#include <QVector>
+#include <QModbusDataUnit>
+
+///
+/// \brief The ModbusDataCoalescer class collects changed registers in per-table dirty bitmaps
+///
+class ModbusDataCoalescer
+{
+public:
+    ///
+    /// \brief The DirtyRange struct
+    ///
+    struct DirtyRange
+    {
+        quint8 DeviceId;
+        QModbusDataUnit::RegisterType PointType;
+        int PointAddress;
+        int Length;
+    };
+
+    bool isEmpty() const { return _empty; }
+
+    void markDirty(quint8 deviceId, QModbusDataUnit::RegisterType pointType, int pointAddress, int length);
+    QVector<DirtyRange> takeDirtyRanges();
+
+private:
+    ///
+    /// \brief The DirtyBitmap struct
+    ///
+    struct DirtyBitmap
+    {
+        int FirstWord = INT_MAX;
+        int LastWord = -1;
+        std::vector<quint64> Words;
+    };
+
+private:
+    // bitmaps are kept once allocated, only their used words are cleared
+    QHash<int, DirtyBitmap> _bitmaps;
+    bool _empty = true;
+};
+
+#endif // MODBUSDATACOALESCER_H
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include "modbusdatadispatcher.h"
+
+///
+/// \brief ModbusDataDispatcher::subscribe
+/// \param id
+/// \param deviceId
+/// \param pointType
+/// \param pointAddress
+/// \param length
+/// \param handler
+///
+void ModbusDataDispatcher::subscribe(int id, quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length, Handler handler)
+{
+    unsubscribe(id);
+
+    const auto key = indexKey(deviceId, pointType);
+    auto& index = _indexes[key];
+
+    const Subscription s = { id, pointAddress, pointAddress + length, handler };
+    const auto it = std::upper_bound(index.Items.begin(), index.Items.end(), s.StartAddress, [](int addr, const Subscription& item) {
+        return addr < item.StartAddress;
+    });
+    index.Items.insert(it, s);
+    index.MaxLength = qMax<int>(index.MaxLength, length);
+
+    _subscriptionKeys[id] = key;
+}
+
+///
+/// \brief ModbusDataDispatcher::unsubscribe
+/// \param id
+///
+void ModbusDataDispatcher::unsubscribe(int id)
+{
+    const auto it = _subscriptionKeys.find(id);
+    if(it == _subscriptionKeys.end())
+        return;
+
+    auto& index = _indexes[it.value()];
+    index.Items.erase(std::remove_if(index.Items.begin(), index.Items.end(), [id](const Subscription& item) {
+        return item.Id == id;
+    }), index.Items.end());
+
+    if(index.Items.isEmpty())
+        _indexes.remove(it.value());
+    else
+        updateMaxLength(index);
+
+    _subscriptionKeys.erase(it);
+}
+
+///
+/// \brief ModbusDataDispatcher::dispatch
+/// \param deviceId
+/// \param data
+///
+void ModbusDataDispatcher::dispatch(quint8 deviceId, const QModbusDataUnit& data) const
+{
+    const auto it = _indexes.find(indexKey(deviceId, data.registerType()));
+    if(it == _indexes.end() || data.valueCount() == 0)
+        return;
+
+    const int startAddress = data.startAddress();
+    const int endAddress = startAddress + data.valueCount();
+
+    // copy the overlapping subscriptions first, a handler may subscribe or unsubscribe
+    QVector<Subscription> targets;
+    const auto& items = it->Items;
+    auto last = std::lower_bound(items.begin(), items.end(), endAddress, [](const Subscription& item, int addr) {
+        return item.StartAddress < addr;
+    });
+    while(last != items.begin())
+    {
+        --last;
+        if(last->StartAddress + it->MaxLength <= startAddress)
+            break;
+
+        if(last->EndAddress > startAddress)
+            targets.append(*last);
+    }
+
+    const auto values = data.values();
+    for(auto&& s : targets)
+    {
+        const int first = qMax(s.StartAddress, startAddress);
+        const int count = qMin(s.EndAddress, endAddress) - first;
+        s.Callback(QModbusDataUnit(data.registerType(), first, values.mid(first - startAddress, count)));
+    }
+}
+
+///
+/// \brief ModbusDataDispatcher::updateMaxLength
+/// \param index
+///
+void ModbusDataDispatcher::updateMaxLength(SubscriptionIndex& index)
+{
+    index.MaxLength = 0;
+    for(auto&& item : index.Items)
+        index.MaxLength = qMax(index.MaxLength, item.EndAddress - item.StartAddress);
+}
@@ -0,0 +1,52 @@
+#ifndef MODBUSDATADISPATCHER_H
+#define MODBUSDATADISPATCHER_H
+
+#include <functional>
+#include <QHash>
+#include <QVector>
+#include <QModbusDataUnit>
+
+///
+/// \brief The ModbusDataDispatcher class delivers data changes to the subscribers whose range overlaps them
+///
+class ModbusDataDispatcher
+{
+public:
+    typedef std::function<void(const QModbusDataUnit&)> Handler;
+
+    void subscribe(int id, quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length, Handler handler);
+    void unsubscribe(int id);
+
+    void dispatch(quint8 deviceId, const QModbusDataUnit& data) const;
+
+private:
+    ///
+    /// \brief The Subscription struct
+    ///
+    struct Subscription
+    {
+        int Id;
+        int StartAddress;
+        int EndAddress;
+        Handler Callback;
+    };
+
+    ///
+    /// \brief The SubscriptionIndex struct - subscriptions sorted by start address
+    ///
+    struct SubscriptionIndex
+    {
+        int MaxLength = 0;
+        QVector<Subscription> Items;
+    };
+
+    static int indexKey(quint8 deviceId, QModbusDataUnit::RegisterType pointType) { return deviceId << 8 | pointType; }
+
+    void updateMaxLength(SubscriptionIndex& index);
+
+private:
+    QHash<int, int> _subscriptionKeys;
+    QHash<int, SubscriptionIndex> _indexes;
+};
+
+#endif // MODBUSDATADISPATCHER_H
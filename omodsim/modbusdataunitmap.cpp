@@ -1,45 +1,61 @@
+#include <cstring>
+#include <QMutexLocker>
 #include "modbusdataunitmap.h"
 
 ///
-/// \brief getDataValue
-/// \param modbusMap
+/// \brief tableIndex
 /// \param pointType
-/// \param pointAddress
 /// \return
 ///
-quint16 getDataValue(const QModbusDataUnitMap& modbusMap, QModbusDataUnit::RegisterType pointType, quint16 pointAddress)
+static inline int tableIndex(QModbusDataUnit::RegisterType pointType)
 {
-    const auto length = modbusMap[pointType].valueCount();
-    const auto startAddress = modbusMap[pointType].startAddress();
-    if(pointAddress < startAddress || pointAddress > startAddress + length)
-        return 0;
-    else
-        return modbusMap[pointType].value(pointAddress - startAddress);
+    switch(pointType)
+    {
+        case QModbusDataUnit::DiscreteInputs:
+        case QModbusDataUnit::Coils:
+        case QModbusDataUnit::InputRegisters:
+        case QModbusDataUnit::HoldingRegisters:
+            return pointType - QModbusDataUnit::DiscreteInputs;
+
+        default:
+            return -1;
+    }
 }
 
 ///
-/// \brief setDataValue
-/// \param modbusMap
-/// \param pointType
+/// \brief clipRange
 /// \param pointAddress
-/// \param value
+/// \param count
+/// \return number of values that fits into the register table
 ///
-void setDataValue(QModbusDataUnitMap& modbusMap, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 value)
+static inline int clipRange(int pointAddress, int count)
 {
-    const auto startAddress = modbusMap[pointType].startAddress();
-    const auto idx = pointAddress - startAddress;
-    if(idx >= 0) modbusMap[pointType].setValue(idx, value);
+    if(pointAddress < 0 || pointAddress >= ModbusDataUnitMap::TableSize)
+        return 0;
+
+    return qBound(0, count, ModbusDataUnitMap::TableSize - pointAddress);
 }
 
 ///
 /// \brief ModbusDataUnitMap::ModbusDataUnitMap
 ///
 ModbusDataUnitMap::ModbusDataUnitMap()
+    :_sequence(0)
+{
+    for(auto&& extent : _extents)
+        extent.store(NoExtent, std::memory_order_relaxed);
+
+    for(auto&& t : _tables)
+        t.store(nullptr, std::memory_order_relaxed);
+}
+
+///
+/// \brief ModbusDataUnitMap::~ModbusDataUnitMap
+///
+ModbusDataUnitMap::~ModbusDataUnitMap()
 {
-    _modbusDataUnitGlobalMap.insert(QModbusDataUnit::Coils,            { QModbusDataUnit::Coils,               0, 65535 });
-    _modbusDataUnitGlobalMap.insert(QModbusDataUnit::DiscreteInputs,   { QModbusDataUnit::DiscreteInputs,      0, 65535 });
-    _modbusDataUnitGlobalMap.insert(QModbusDataUnit::InputRegisters,   { QModbusDataUnit::InputRegisters,      0, 65535 });
-    _modbusDataUnitGlobalMap.insert(QModbusDataUnit::HoldingRegisters, { QModbusDataUnit::HoldingRegisters,    0, 65535 });
+    for(auto&& t : _tables)
+        delete t.load(std::memory_order_relaxed);
 }
 
 ///
@@ -66,38 +82,214 @@ void ModbusDataUnitMap::removeUnitMap(int id)
 }
 
 ///
-/// \brief ModbusDataUnitMap::begin
-/// \return
+/// \brief ModbusDataUnitMap::isEmpty
+/// \return true if no unit map was added
+///
+bool ModbusDataUnitMap::isEmpty() const
+{
+    for(auto&& extent : _extents)
+    {
+        if(extent.load(std::memory_order_acquire) != NoExtent)
+            return false;
+    }
+
+    return true;
+}
+
 ///
-QModbusDataUnitMap::ConstIterator ModbusDataUnitMap::begin()
+/// \brief ModbusDataUnitMap::contains
+/// \param pointType
+/// \param pointAddress
+/// \param count
+/// \return true if the range lies within the mapped registers
+///
+bool ModbusDataUnitMap::contains(QModbusDataUnit::RegisterType pointType, int pointAddress, int count) const
 {
-    return _modbusDataUnitMap.begin();
+    const auto idx = tableIndex(pointType);
+    if(idx < 0 || count <= 0)
+        return false;
+
+    const auto extent = _extents[idx].load(std::memory_order_acquire);
+    const int startAddress = extent >> 16;
+    const int lastAddress = extent & 0xFFFF;
+
+    return pointAddress >= startAddress &&
+           pointAddress + count - 1 <= lastAddress;
 }
 
 ///
-/// \brief ModbusDataUnitMap::end
-/// \return
+/// \brief ModbusDataUnitMap::readData
+/// \param data
+/// \return false if the requested range is not mapped
 ///
-QModbusDataUnitMap::Iterator ModbusDataUnitMap::end()
+bool ModbusDataUnitMap::readData(QModbusDataUnit* data) const
 {
-    return _modbusDataUnitMap.end();
+    if(!data || !contains(data->registerType(), data->startAddress(), data->valueCount()))
+        return false;
+
+    QVector<quint16> values(data->valueCount());
+    readValues(data->registerType(), data->startAddress(), values.data(), values.size());
+    data->setValues(values);
+
+    return true;
 }
 
 ///
-/// \brief ModbusDataUnitMap::setData
+/// \brief ModbusDataUnitMap::writeData
 /// \param data
+/// \return false if the requested range is not mapped
 ///
-void ModbusDataUnitMap::setData(const QModbusDataUnit& data)
+bool ModbusDataUnitMap::writeData(const QModbusDataUnit& data)
 {
-    const auto addr = data.startAddress();
-    const auto length = data.valueCount();
-    const auto type = data.registerType();
+    if(!contains(data.registerType(), data.startAddress(), data.valueCount()))
+        return false;
 
-    for(uint i = 0; i < length; i++)
+    auto values = data.values();
+    if(data.registerType() == QModbusDataUnit::Coils ||
+       data.registerType() == QModbusDataUnit::DiscreteInputs)
     {
-        setDataValue(_modbusDataUnitMap, type, addr + i, data.value(i));
-        setDataValue(_modbusDataUnitGlobalMap, type, addr + i, data.value(i));
+        for(auto& v : values) v = !!v; // force values to bit
     }
+
+    writeValues(data.registerType(), data.startAddress(), values.constData(), values.size());
+    return true;
+}
+
+///
+/// \brief ModbusDataUnitMap::table
+/// \param pointType
+/// \return register table, allocated on first write
+///
+ModbusDataUnitMap::RegisterTable* ModbusDataUnitMap::table(QModbusDataUnit::RegisterType pointType)
+{
+    const auto idx = tableIndex(pointType);
+    if(idx < 0)
+        return nullptr;
+
+    // called with the write lock held
+    auto t = _tables[idx].load(std::memory_order_relaxed);
+    if(!t)
+    {
+        t = new RegisterTable;
+        _tables[idx].store(t, std::memory_order_release);
+    }
+
+    return t;
+}
+
+///
+/// \brief ModbusDataUnitMap::table
+/// \param pointType
+/// \return register table or nullptr if nothing was written into it yet
+///
+const ModbusDataUnitMap::RegisterTable* ModbusDataUnitMap::table(QModbusDataUnit::RegisterType pointType) const
+{
+    const auto idx = tableIndex(pointType);
+    return idx < 0 ? nullptr : _tables[idx].load(std::memory_order_acquire);
+}
+
+///
+/// \brief ModbusDataUnitMap::beginWrite
+///
+void ModbusDataUnitMap::beginWrite()
+{
+    _writeMutex.lock();
+    _sequence.store(_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+///
+/// \brief ModbusDataUnitMap::endWrite
+///
+void ModbusDataUnitMap::endWrite()
+{
+    _sequence.store(_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    _writeMutex.unlock();
+}
+
+///
+/// \brief ModbusDataUnitMap::writeValues
+/// \param pointType
+/// \param pointAddress
+/// \param values
+/// \param count
+///
+void ModbusDataUnitMap::writeValues(QModbusDataUnit::RegisterType pointType, int pointAddress, const quint16* values, int count)
+{
+    count = clipRange(pointAddress, count);
+    if(count == 0 || tableIndex(pointType) < 0)
+        return;
+
+    beginWrite();
+    memcpy(table(pointType)->Values + pointAddress, values, count * sizeof(quint16));
+    endWrite();
+}
+
+///
+/// \brief ModbusDataUnitMap::readValues
+/// \param pointType
+/// \param pointAddress
+/// \param values
+/// \param count
+///
+void ModbusDataUnitMap::readValues(QModbusDataUnit::RegisterType pointType, int pointAddress, quint16* values, int count) const
+{
+    const auto size = clipRange(pointAddress, count);
+    if(count > size) memset(values + size, 0, (count - size) * sizeof(quint16));
+
+    if(size == 0)
+        return;
+
+    const auto t = table(pointType);
+    if(!t)
+    {
+        memset(values, 0, size * sizeof(quint16));
+        return;
+    }
+
+    // retry while a write is in progress or has happened during the copy
+    quint32 sequence;
+    do
+    {
+        sequence = _sequence.load(std::memory_order_acquire);
+        if(sequence & 1)
+            continue;
+
+        memcpy(values, t->Values + pointAddress, size * sizeof(quint16));
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    while((sequence & 1) || sequence != _sequence.load(std::memory_order_relaxed));
+}
+
+///
+/// \brief ModbusDataUnitMap::maskWriteValue
+/// \param pointType
+/// \param pointAddress
+/// \param andMask
+/// \param orMask
+/// \return false if the address is not mapped
+///
+bool ModbusDataUnitMap::maskWriteValue(QModbusDataUnit::RegisterType pointType, int pointAddress, quint16 andMask, quint16 orMask)
+{
+    if(!contains(pointType, pointAddress, 1))
+        return false;
+
+    beginWrite();
+    auto& value = table(pointType)->Values[pointAddress];
+    value = (value & andMask) | (orMask & ~andMask);
+    endWrite();
+
+    return true;
+}
+
+///
+/// \brief ModbusDataUnitMap::setData
+/// \param data
+///
+void ModbusDataUnitMap::setData(const QModbusDataUnit& data)
+{
+    const auto values = data.values();
+    writeValues(data.registerType(), data.startAddress(), values.constData(), values.size());
 }
 
 ///
@@ -109,14 +301,10 @@ void ModbusDataUnitMap::setData(const QModbusDataUnit& data)
 ///
 QModbusDataUnit ModbusDataUnitMap::getData(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length) const
 {
-    QModbusDataUnit data(pointType, pointAddress, length);
-    for(int i = 0; i < length; i++)
-    {
-        const auto value = getDataValue(_modbusDataUnitGlobalMap, pointType, pointAddress + i);
-        data.setValue(i, value);
-    }
+    QVector<quint16> values(length);
+    readValues(pointType, pointAddress, values.data(), length);
 
-    return data;
+    return QModbusDataUnit(pointType, pointAddress, values);
 }
 
 ///
@@ -124,32 +312,98 @@ QModbusDataUnit ModbusDataUnitMap::getData(QModbusDataUnit::RegisterType pointTy
 ///
 void ModbusDataUnitMap::updateDataUnitMap()
 {
-    QMultiMap<QModbusDataUnit::RegisterType, QModbusDataUnit> multimap;
+    int startAddress[QModbusDataUnit::HoldingRegisters] = {};
+    int endAddress[QModbusDataUnit::HoldingRegisters] = {};
     for(auto&& unit : _dataUnits)
     {
-        multimap.insert(unit.registerType(), unit);
+        const auto idx = tableIndex(unit.registerType());
+        if(idx < 0 || unit.valueCount() == 0)
+            continue;
+
+        const int start = unit.startAddress();
+        const int end = qMin<int>(start + unit.valueCount(), TableSize);
+
+        startAddress[idx] = (endAddress[idx] > 0) ? qMin(startAddress[idx], start) : start;
+        endAddress[idx] = qMax(endAddress[idx], end);
+    }
+
+    for(int i = 0; i < QModbusDataUnit::HoldingRegisters; i++)
+    {
+        const auto extent = (endAddress[i] > startAddress[i]) ? quint32(startAddress[i]) << 16 | quint32(endAddress[i] - 1) : NoExtent;
+        _extents[i].store(extent, std::memory_order_release);
     }
+}
+
+///
+/// \brief ModbusDataUnitMapList::ModbusDataUnitMapList
+///
+ModbusDataUnitMapList::ModbusDataUnitMapList()
+{
+    for(auto&& unitMap : _unitMaps)
+        unitMap.store(nullptr, std::memory_order_relaxed);
+}
+
+///
+/// \brief ModbusDataUnitMapList::~ModbusDataUnitMapList
+///
+ModbusDataUnitMapList::~ModbusDataUnitMapList()
+{
+    for(auto&& unitMap : _unitMaps)
+        delete unitMap.load(std::memory_order_relaxed);
+}
 
-    QModbusDataUnitMap modbusMap;
-    for(auto&& type: multimap.uniqueKeys())
+///
+/// \brief ModbusDataUnitMapList::find
+/// \param deviceId
+/// \return register bank of the device or nullptr if it was never used
+///
+ModbusDataUnitMap* ModbusDataUnitMapList::find(quint8 deviceId) const
+{
+    return _unitMaps[deviceId].load(std::memory_order_acquire);
+}
+
+///
+/// \brief ModbusDataUnitMapList::unitMap
+/// \param deviceId
+/// \return register bank of the device, created on first use
+///
+ModbusDataUnitMap& ModbusDataUnitMapList::unitMap(quint8 deviceId)
+{
+    auto unitMap = find(deviceId);
+    if(unitMap)
+        return *unitMap;
+
+    QMutexLocker locker(&_mutex);
+    unitMap = _unitMaps[deviceId].load(std::memory_order_relaxed);
+    if(!unitMap)
+    {
+        unitMap = new ModbusDataUnitMap;
+        _unitMaps[deviceId].store(unitMap, std::memory_order_release);
+    }
+
+    return *unitMap;
+}
+
+///
+/// \brief ModbusDataUnitMapList::isServed
+/// \param deviceId
+/// \return true if any unit map is added for the device
+///
+bool ModbusDataUnitMapList::isServed(quint8 deviceId) const
+{
+    const auto unitMap = find(deviceId);
+    return unitMap && !unitMap->isEmpty();
+}
+
+///
+/// \brief ModbusDataUnitMapList::removeUnitMap
+/// \param id
+///
+void ModbusDataUnitMapList::removeUnitMap(int id)
+{
+    for(auto&& unitMap : _unitMaps)
     {
-        quint16 startAddress = 65535;
-        quint16 endAddress = 0;
-        for(auto&& unit : multimap.values(type))
-        {
-            startAddress = qMin<quint16>(startAddress, unit.startAddress());
-            endAddress = qMax<quint16>(endAddress, unit.startAddress() + unit.valueCount());
-        }
-
-        const quint16 length = endAddress - startAddress;
-        if(length > 0)
-            modbusMap.insert(type, {type, startAddress, length});
-
-        for(int i = 0; i < length; i++)
-        {
-            const auto value = getDataValue(_modbusDataUnitGlobalMap, type, startAddress + i);
-            setDataValue(modbusMap, type, startAddress + i, value);
-        }
+        const auto m = unitMap.load(std::memory_order_acquire);
+        if(m) m->removeUnitMap(id);
     }
-    _modbusDataUnitMap = modbusMap;
 }
@@ -1,37 +1,98 @@
 #ifndef MODBUSDATAUNITMAP_H
 #define MODBUSDATAUNITMAP_H
 
+#include <atomic>
+#include <QMutex>
 #include <QModbusDataUnit>
 
 ///
 /// \brief The ModbusDataUnitMap class
 ///
+/// Register values may be read from any thread without locking, writes are serialized.
+/// Unit maps are added and removed from the thread that owns the ModbusMultiServer.
+///
 class ModbusDataUnitMap
 {
 public:
     explicit ModbusDataUnitMap();
+    ~ModbusDataUnitMap();
+
+    ModbusDataUnitMap(const ModbusDataUnitMap&) = delete;
+    ModbusDataUnitMap& operator=(const ModbusDataUnitMap&) = delete;
+
+    static constexpr int TableSize = 0x10000;
 
     void addUnitMap(int id, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length);
     void removeUnitMap(int id);
 
+    bool isEmpty() const;
+    bool contains(QModbusDataUnit::RegisterType pointType, int pointAddress, int count) const;
+
+    bool readData(QModbusDataUnit* data) const;
+    bool writeData(const QModbusDataUnit& data);
+
     void setData(const QModbusDataUnit& data);
     QModbusDataUnit getData(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length) const;
 
-    QModbusDataUnitMap::ConstIterator begin();
-    QModbusDataUnitMap::Iterator end();
+    void writeValues(QModbusDataUnit::RegisterType pointType, int pointAddress, const quint16* values, int count);
+    void readValues(QModbusDataUnit::RegisterType pointType, int pointAddress, quint16* values, int count) const;
 
-    operator QModbusDataUnitMap(){
-        return _modbusDataUnitMap;
-    }
+    bool maskWriteValue(QModbusDataUnit::RegisterType pointType, int pointAddress, quint16 andMask, quint16 orMask);
 
 private:
     void updateDataUnitMap();
 
+private:
+    ///
+    /// \brief The RegisterTable struct
+    ///
+    struct alignas(64) RegisterTable
+    {
+        quint16 Values[TableSize] = {};
+    };
+
+    RegisterTable* table(QModbusDataUnit::RegisterType pointType);
+    const RegisterTable* table(QModbusDataUnit::RegisterType pointType) const;
+
+    void beginWrite();
+    void endWrite();
+
 private:
     QMap<int, QModbusDataUnit> _dataUnits;
-    QModbusDataUnitMap _modbusDataUnitMap;
-    QModbusDataUnitMap _modbusDataUnitGlobalMap;
+
+    // start address in the high word, last address in the low word, so a whole table fits
+    static constexpr quint32 NoExtent = 0xFFFF0000;
+    std::atomic<quint32> _extents[QModbusDataUnit::HoldingRegisters];
+    std::atomic<RegisterTable*> _tables[QModbusDataUnit::HoldingRegisters];
+
+    // seqlock, odd while a write is in progress
+    alignas(64) std::atomic<quint32> _sequence;
+    QMutex _writeMutex;
 };
 
+///
+/// \brief The ModbusDataUnitMapList class
+///
+class ModbusDataUnitMapList
+{
+public:
+    explicit ModbusDataUnitMapList();
+    ~ModbusDataUnitMapList();
+
+    ModbusDataUnitMapList(const ModbusDataUnitMapList&) = delete;
+    ModbusDataUnitMapList& operator=(const ModbusDataUnitMapList&) = delete;
+
+    static constexpr int MaxDeviceId = 0xFF;
+
+    ModbusDataUnitMap* find(quint8 deviceId) const;
+    ModbusDataUnitMap& unitMap(quint8 deviceId);
+
+    bool isServed(quint8 deviceId) const;
+    void removeUnitMap(int id);
+
+private:
+    std::atomic<ModbusDataUnitMap*> _unitMaps[MaxDeviceId + 1];
+    QMutex _mutex;
+};
 
 #endif // MODBUSDATAUNITMAP_H
@@ -0,0 +1,882 @@
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QVarLengthArray>
+#include "modbusepollserver.h"
+
+///
+/// \brief MbapHeaderSize
+///
+static constexpr int MbapHeaderSize = 7;
+
+///
+/// \brief MaxMbapLength - unit identifier and the largest PDU
+///
+static constexpr int MaxMbapLength = 254;
+
+///
+/// \brief ReadChunkSize
+///
+static constexpr int ReadChunkSize = 0x4000;
+
+///
+/// \brief MaxEvents
+///
+static constexpr int MaxEvents = 256;
+
+///
+/// \brief MaxAcceptBatch - connections accepted per wakeup, leaves the rest to other workers
+///
+static constexpr int MaxAcceptBatch = 64;
+
+///
+/// \brief AcceptRetryInterval - pause in ms after running out of file descriptors
+///
+static constexpr int AcceptRetryInterval = 100;
+
+///
+/// \brief raiseFileLimit
+///
+static void raiseFileLimit()
+{
+    rlimit limit;
+    if(getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+///
+/// \brief readWord
+/// \param data
+/// \param pos
+/// \return big-endian word at the position
+///
+static inline quint16 readWord(const QByteArray& data, int pos)
+{
+    return quint8(data[pos]) << 8 | quint8(data[pos + 1]);
+}
+
+///
+/// \brief exceptionResponse
+/// \param req
+/// \param code
+/// \return
+///
+static inline QModbusResponse exceptionResponse(const QModbusRequest& req, QModbusPdu::ExceptionCode code)
+{
+    return QModbusExceptionResponse(req.functionCode(), code);
+}
+
+///
+/// \brief readBits
+/// \param unitMap
+/// \param pointType
+/// \param req
+/// \return
+///
+static QModbusResponse readBits(const ModbusDataUnitMap* unitMap, QModbusDataUnit::RegisterType pointType, const QModbusRequest& req)
+{
+    const auto data = req.data();
+    if(data.size() != 4)
+        return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+    const int address = readWord(data, 0);
+    const int count = readWord(data, 2);
+    if(count < 1 || count > 2000)
+        return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+    if(!unitMap->contains(pointType, address, count))
+        return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+
+    QVarLengthArray<quint16, 2000> values(count);
+    unitMap->readValues(pointType, address, values.data(), count);
+
+    const int byteCount = (count + 7) / 8;
+    QByteArray payload(1 + byteCount, 0);
+    payload[0] = char(byteCount);
+    for(int i = 0; i < count; i++)
+    {
+        if(values[i])
+            payload[1 + i / 8] = char(payload[1 + i / 8] | (1 << (i % 8)));
+    }
+
+    return QModbusResponse(req.functionCode(), payload);
+}
+
+///
+/// \brief readRegisters
+/// \param unitMap
+/// \param pointType
+/// \param req
+/// \return
+///
+static QModbusResponse readRegisters(const ModbusDataUnitMap* unitMap, QModbusDataUnit::RegisterType pointType, const QModbusRequest& req)
+{
+    const auto data = req.data();
+    if(data.size() != 4)
+        return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+    const int address = readWord(data, 0);
+    const int count = readWord(data, 2);
+    if(count < 1 || count > 125)
+        return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+    if(!unitMap->contains(pointType, address, count))
+        return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+
+    quint16 values[125];
+    unitMap->readValues(pointType, address, values, count);
+
+    QByteArray payload(1 + count * 2, 0);
+    payload[0] = char(count * 2);
+    for(int i = 0; i < count; i++)
+    {
+        payload[1 + i * 2] = char(values[i] >> 8);
+        payload[2 + i * 2] = char(values[i]);
+    }
+
+    return QModbusResponse(req.functionCode(), payload);
+}
+
+///
+/// \brief ModbusEpollServer::ModbusEpollServer
+/// \param unitMaps
+/// \param statistics
+/// \param parent
+///
+ModbusEpollServer::ModbusEpollServer(ModbusDataUnitMapList* unitMaps, ModbusStatistics* statistics, QObject *parent)
+    : QModbusServer(parent)
+    ,_unitMaps(unitMaps)
+    ,_statistics(statistics)
+{
+    Q_ASSERT(_unitMaps != nullptr);
+    Q_ASSERT(_statistics != nullptr);
+
+    // signals are delivered from the worker threads
+    qRegisterMetaType<QModbusRequest>("QModbusRequest");
+    qRegisterMetaType<QModbusResponse>("QModbusResponse");
+    qRegisterMetaType<QModbusDataUnit::RegisterType>("QModbusDataUnit::RegisterType");
+}
+
+///
+/// \brief ModbusEpollServer::~ModbusEpollServer
+///
+ModbusEpollServer::~ModbusEpollServer()
+{
+    close();
+}
+
+///
+/// \brief ModbusEpollServer::connectionCount
+/// \return
+///
+int ModbusEpollServer::connectionCount() const
+{
+    int count = 0;
+    for(auto&& worker : _workers)
+        count += worker->ConnectionCount.load(std::memory_order_relaxed);
+
+    return count;
+}
+
+///
+/// \brief ModbusEpollServer::workerCount
+/// \return
+///
+int ModbusEpollServer::workerCount() const
+{
+    return (int)_workers.size();
+}
+
+///
+/// \brief ModbusEpollServer::open
+/// \return
+///
+bool ModbusEpollServer::open()
+{
+    if(state() == QModbusDevice::ConnectedState)
+        return true;
+
+    const QHostAddress address(connectionParameter(QModbusDevice::NetworkAddressParameter).toString());
+    const quint16 port = connectionParameter(QModbusDevice::NetworkPortParameter).toUInt();
+
+    sockaddr_storage addr;
+    socklen_t addrLen;
+    memset(&addr, 0, sizeof(addr));
+
+    if(address.protocol() == QAbstractSocket::IPv6Protocol)
+    {
+        auto addr6 = reinterpret_cast<sockaddr_in6*>(&addr);
+        const auto ip = address.toIPv6Address();
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons(port);
+        memcpy(&addr6->sin6_addr, &ip, sizeof(addr6->sin6_addr));
+        addrLen = sizeof(sockaddr_in6);
+    }
+    else
+    {
+        auto addr4 = reinterpret_cast<sockaddr_in*>(&addr);
+        addr4->sin_family = AF_INET;
+        addr4->sin_port = htons(port);
+        addr4->sin_addr.s_addr = htonl(address.toIPv4Address());
+        addrLen = sizeof(sockaddr_in);
+    }
+
+    _exceptionStatusOffset = value(QModbusServer::ExceptionStatusOffset).value<quint16>();
+    _serverIdData.clear();
+    _serverIdData.append(char(value(QModbusServer::ServerIdentifier).value<quint8>()));
+    _serverIdData.append(char(value(QModbusServer::RunIndicatorStatus).value<quint8>()));
+    _serverIdData.append(value(QModbusServer::AdditionalData).toByteArray().left(250));
+    _serverIdData.prepend(char(_serverIdData.size()));
+
+    raiseFileLimit();
+
+    _listenFd = ::socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    bool result = (_listenFd >= 0);
+    if(result)
+    {
+        int on = 1;
+        setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        result = ::bind(_listenFd, reinterpret_cast<sockaddr*>(&addr), addrLen) == 0 &&
+                 ::listen(_listenFd, SOMAXCONN) == 0;
+    }
+
+    const int workers = qMax(1, QThread::idealThreadCount());
+    for(int i = 0; result && i < workers; i++)
+        result = addWorker();
+
+    if(!result)
+    {
+        setError(QString::fromLocal8Bit(strerror(errno)), QModbusDevice::ConnectionError);
+        close();
+        return false;
+    }
+
+    for(auto&& worker : _workers)
+        worker->Thread->start();
+
+    setState(QModbusDevice::ConnectedState);
+    return true;
+}
+
+///
+/// \brief ModbusEpollServer::close
+///
+void ModbusEpollServer::close()
+{
+    if(_listenFd < 0)
+        return;
+
+    for(auto&& worker : _workers)
+    {
+        if(worker->Thread->isRunning())
+        {
+            const quint64 stop = 1;
+            if(::write(worker->EventFd, &stop, sizeof(stop)) == sizeof(stop))
+                worker->Thread->wait();
+        }
+
+        for(auto&& conn : worker->Connections)
+            ::close(conn.first);
+
+        ::close(worker->EventFd);
+        ::close(worker->EpollFd);
+    }
+    _workers.clear();
+
+    ::close(_listenFd);
+    _listenFd = -1;
+
+    setState(QModbusDevice::UnconnectedState);
+}
+
+///
+/// \brief ModbusEpollServer::addWorker
+/// \return
+///
+bool ModbusEpollServer::addWorker()
+{
+    std::unique_ptr<Worker> worker(new Worker);
+    worker->EpollFd = epoll_create1(EPOLL_CLOEXEC);
+    worker->EventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    bool result = (worker->EpollFd >= 0 && worker->EventFd >= 0);
+    if(result)
+    {
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = worker.get();
+
+        result = epoll_ctl(worker->EpollFd, EPOLL_CTL_ADD, worker->EventFd, &ev) == 0;
+    }
+
+    if(result)
+    {
+        listen(worker.get());
+        result = worker->Listening;
+    }
+
+    if(!result)
+    {
+        if(worker->EventFd >= 0) ::close(worker->EventFd);
+        if(worker->EpollFd >= 0) ::close(worker->EpollFd);
+        return false;
+    }
+
+    auto w = worker.get();
+    worker->Thread.reset(QThread::create([this, w]{ runWorker(w); }));
+    worker->Thread->setObjectName("ModbusEpollWorker");
+
+    _workers.push_back(std::move(worker));
+    return true;
+}
+
+///
+/// \brief ModbusEpollServer::listen
+/// \param worker
+///
+void ModbusEpollServer::listen(Worker* worker)
+{
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+#ifdef EPOLLEXCLUSIVE
+    // wake one worker per incoming connection instead of all of them
+    ev.events |= EPOLLEXCLUSIVE;
+#endif
+    ev.data.ptr = nullptr;
+
+    worker->Listening = epoll_ctl(worker->EpollFd, EPOLL_CTL_ADD, _listenFd, &ev) == 0;
+}
+
+///
+/// \brief ModbusEpollServer::readData
+/// \param newData
+/// \return
+///
+bool ModbusEpollServer::readData(QModbusDataUnit* newData) const
+{
+    const auto unitMap = _unitMaps->find(serverAddress());
+    return unitMap && unitMap->readData(newData);
+}
+
+///
+/// \brief ModbusEpollServer::writeData
+/// \param newData
+/// \return
+///
+bool ModbusEpollServer::writeData(const QModbusDataUnit& newData)
+{
+    const auto unitMap = _unitMaps->find(serverAddress());
+    if(!unitMap || !unitMap->writeData(newData))
+        return false;
+
+    emit unitDataWritten(serverAddress(), newData.registerType(), newData.startAddress(), newData.valueCount());
+    return true;
+}
+
+///
+/// \brief ModbusEpollServer::runWorker
+/// \param worker
+///
+void ModbusEpollServer::runWorker(Worker* worker)
+{
+    epoll_event events[MaxEvents];
+
+    forever
+    {
+        const int count = epoll_wait(worker->EpollFd, events, MaxEvents, worker->Listening ? -1 : AcceptRetryInterval);
+        if(count < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            break;
+        }
+
+        if(count == 0 && !worker->Listening)
+            listen(worker);
+
+        for(int i = 0; i < count; i++)
+        {
+            if(events[i].data.ptr == worker)
+                return;
+
+            auto conn = static_cast<Connection*>(events[i].data.ptr);
+            if(conn == nullptr)
+            {
+                acceptConnections(worker);
+                continue;
+            }
+
+            const auto flags = events[i].events;
+            if(flags & (EPOLLERR | EPOLLHUP))
+            {
+                closeConnection(worker, conn);
+                continue;
+            }
+
+            if((flags & EPOLLOUT) && !writeConnection(worker, conn))
+                continue;
+
+            if(flags & (EPOLLIN | EPOLLRDHUP))
+                readConnection(worker, conn);
+        }
+    }
+}
+
+///
+/// \brief ModbusEpollServer::acceptConnections
+/// \param worker
+///
+void ModbusEpollServer::acceptConnections(Worker* worker)
+{
+    for(int i = 0; i < MaxAcceptBatch; i++)
+    {
+        const int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            if(errno == EMFILE || errno == ENFILE)
+            {
+                // out of descriptors, stop listening for a while instead of spinning on the pending connection
+                epoll_ctl(worker->EpollFd, EPOLL_CTL_DEL, _listenFd, nullptr);
+                worker->Listening = false;
+            }
+            break;
+        }
+
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        std::unique_ptr<Connection> conn(new Connection);
+        conn->Socket = fd;
+        conn->Id = _connectionCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = conn.get();
+
+        if(epoll_ctl(worker->EpollFd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            ::close(fd);
+            continue;
+        }
+
+        worker->Connections[fd] = std::move(conn);
+        worker->ConnectionCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+///
+/// \brief ModbusEpollServer::closeConnection
+/// \param worker
+/// \param conn
+///
+void ModbusEpollServer::closeConnection(Worker* worker, Connection* conn)
+{
+    const int fd = conn->Socket;
+    epoll_ctl(worker->EpollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+
+    worker->Connections.erase(fd);
+    worker->ConnectionCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+///
+/// \brief ModbusEpollServer::readConnection
+/// \param worker
+/// \param conn
+///
+void ModbusEpollServer::readConnection(Worker* worker, Connection* conn)
+{
+    auto& buffer = conn->ReadBuffer;
+    const int size = buffer.size();
+    buffer.resize(size + ReadChunkSize);
+
+    const auto n = ::recv(conn->Socket, buffer.data() + size, ReadChunkSize, 0);
+    buffer.resize(size + qMax<int>(0, n));
+
+    if(n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    {
+        closeConnection(worker, conn);
+        return;
+    }
+
+    if(n > 0 && processFrames(worker, conn))
+        writeConnection(worker, conn);
+}
+
+///
+/// \brief ModbusEpollServer::processFrames
+/// \param worker
+/// \param conn
+/// \return false if the connection was closed
+///
+bool ModbusEpollServer::processFrames(Worker* worker, Connection* conn)
+{
+    const auto& buffer = conn->ReadBuffer;
+
+    int pos = 0;
+    while(buffer.size() - pos >= MbapHeaderSize)
+    {
+        const auto frame = reinterpret_cast<const quint8*>(buffer.constData()) + pos;
+        const quint16 transactionId = frame[0] << 8 | frame[1];
+        const quint16 protocolId = frame[2] << 8 | frame[3];
+        const quint16 length = frame[4] << 8 | frame[5];
+        const quint8 deviceId = frame[6];
+
+        if(protocolId != 0 || length < 2 || length > MaxMbapLength)
+        {
+            closeConnection(worker, conn);
+            return false;
+        }
+
+        const int size = MbapHeaderSize - 1 + length;
+        if(buffer.size() - pos < size)
+            break;
+
+        // several transactions may be in flight, they are answered in order
+        if(_unitMaps->isServed(deviceId))
+        {
+            const QModbusRequest req(QModbusPdu::FunctionCode(frame[7]),
+                                     QByteArray(reinterpret_cast<const char*>(frame) + MbapHeaderSize + 1, length - 2));
+
+            QElapsedTimer timer;
+            timer.start();
+
+            emit request(req, deviceId, transactionId, conn->Id);
+            const auto resp = processUnitRequest(deviceId, req);
+            emit response(resp, deviceId, transactionId, conn->Id);
+
+            _statistics->addRequest(req, resp, timer.nsecsElapsed());
+
+            const auto data = resp.data();
+            const quint8 funcCode = resp.isException() ? (resp.functionCode() | QModbusPdu::ExceptionByte) : resp.functionCode();
+            const quint16 respLength = data.size() + 2;
+            const char header[MbapHeaderSize + 1] = {
+                char(transactionId >> 8), char(transactionId),
+                0, 0,
+                char(respLength >> 8), char(respLength),
+                char(deviceId), char(funcCode)
+            };
+            conn->WriteBuffer.append(header, sizeof(header));
+            conn->WriteBuffer.append(data);
+        }
+
+        pos += size;
+    }
+
+    conn->ReadBuffer.remove(0, pos);
+    return true;
+}
+
+///
+/// \brief ModbusEpollServer::writeConnection
+/// \param worker
+/// \param conn
+/// \return false if the connection was closed
+///
+bool ModbusEpollServer::writeConnection(Worker* worker, Connection* conn)
+{
+    auto& buffer = conn->WriteBuffer;
+    int pos = 0;
+    while(pos < buffer.size())
+    {
+        const auto n = ::send(conn->Socket, buffer.constData() + pos, buffer.size() - pos, MSG_NOSIGNAL);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            if(errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+
+            closeConnection(worker, conn);
+            return false;
+        }
+        pos += n;
+    }
+    buffer.remove(0, pos);
+
+    // do not read new requests while the client does not take responses
+    const bool waitingWrite = !buffer.isEmpty();
+    if(waitingWrite != conn->WaitingWrite)
+    {
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = (waitingWrite ? EPOLLOUT : EPOLLIN) | EPOLLRDHUP;
+        ev.data.ptr = conn;
+
+        epoll_ctl(worker->EpollFd, EPOLL_CTL_MOD, conn->Socket, &ev);
+        conn->WaitingWrite = waitingWrite;
+    }
+
+    return true;
+}
+
+///
+/// \brief ModbusEpollServer::processUnitRequest
+/// \param deviceId
+/// \param req
+/// \return
+///
+QModbusResponse ModbusEpollServer::processUnitRequest(quint8 deviceId, const QModbusRequest& req)
+{
+    const auto unitMap = _unitMaps->find(deviceId);
+    if(!unitMap)
+        return exceptionResponse(req, QModbusPdu::ServerDeviceFailure);
+
+    const auto data = req.data();
+    switch(req.functionCode())
+    {
+        case QModbusPdu::ReadCoils:
+            return readBits(unitMap, QModbusDataUnit::Coils, req);
+
+        case QModbusPdu::ReadDiscreteInputs:
+            return readBits(unitMap, QModbusDataUnit::DiscreteInputs, req);
+
+        case QModbusPdu::ReadHoldingRegisters:
+            return readRegisters(unitMap, QModbusDataUnit::HoldingRegisters, req);
+
+        case QModbusPdu::ReadInputRegisters:
+            return readRegisters(unitMap, QModbusDataUnit::InputRegisters, req);
+
+        case QModbusPdu::WriteSingleCoil:
+        {
+            if(data.size() != 4)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            const int address = readWord(data, 0);
+            const quint16 value = readWord(data, 2);
+            if(value != 0xFF00 && value != 0x0000)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            if(!unitMap->contains(QModbusDataUnit::Coils, address, 1))
+                return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+
+            const quint16 bit = (value == 0xFF00);
+            unitMap->writeValues(QModbusDataUnit::Coils, address, &bit, 1);
+            emit unitDataWritten(deviceId, QModbusDataUnit::Coils, address, 1);
+
+            return QModbusResponse(req.functionCode(), data);
+        }
+
+        case QModbusPdu::WriteSingleRegister:
+        {
+            if(data.size() != 4)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            const int address = readWord(data, 0);
+            if(!unitMap->contains(QModbusDataUnit::HoldingRegisters, address, 1))
+                return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+
+            const quint16 value = readWord(data, 2);
+            unitMap->writeValues(QModbusDataUnit::HoldingRegisters, address, &value, 1);
+            emit unitDataWritten(deviceId, QModbusDataUnit::HoldingRegisters, address, 1);
+
+            return QModbusResponse(req.functionCode(), data);
+        }
+
+        case QModbusPdu::WriteMultipleCoils:
+        {
+            if(data.size() < 5)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            const int address = readWord(data, 0);
+            const int count = readWord(data, 2);
+            const int byteCount = quint8(data[4]);
+            if(count < 1 || count > 0x7B0 || byteCount != (count + 7) / 8 || data.size() != 5 + byteCount)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            if(!unitMap->contains(QModbusDataUnit::Coils, address, count))
+                return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+
+            QVarLengthArray<quint16, 0x7B0> values(count);
+            for(int i = 0; i < count; i++)
+                values[i] = (quint8(data[5 + i / 8]) >> (i % 8)) & 1;
+
+            unitMap->writeValues(QModbusDataUnit::Coils, address, values.constData(), count);
+            emit unitDataWritten(deviceId, QModbusDataUnit::Coils, address, count);
+
+            return QModbusResponse(req.functionCode(), data.left(4));
+        }
+
+        case QModbusPdu::WriteMultipleRegisters:
+        {
+            if(data.size() < 5)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            const int address = readWord(data, 0);
+            const int count = readWord(data, 2);
+            const int byteCount = quint8(data[4]);
+            if(count < 1 || count > 0x7B || byteCount != count * 2 || data.size() != 5 + byteCount)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            if(!unitMap->contains(QModbusDataUnit::HoldingRegisters, address, count))
+                return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+
+            quint16 values[0x7B];
+            for(int i = 0; i < count; i++)
+                values[i] = readWord(data, 5 + i * 2);
+
+            unitMap->writeValues(QModbusDataUnit::HoldingRegisters, address, values, count);
+            emit unitDataWritten(deviceId, QModbusDataUnit::HoldingRegisters, address, count);
+
+            return QModbusResponse(req.functionCode(), data.left(4));
+        }
+
+        case QModbusPdu::MaskWriteRegister:
+        {
+            if(data.size() != 6)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            const int address = readWord(data, 0);
+            if(!unitMap->maskWriteValue(QModbusDataUnit::HoldingRegisters, address, readWord(data, 2), readWord(data, 4)))
+                return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+
+            emit unitDataWritten(deviceId, QModbusDataUnit::HoldingRegisters, address, 1);
+            return QModbusResponse(req.functionCode(), data);
+        }
+
+        case QModbusPdu::ReadWriteMultipleRegisters:
+        {
+            if(data.size() < 9)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            const int readAddress = readWord(data, 0);
+            const int readCount = readWord(data, 2);
+            const int writeAddress = readWord(data, 4);
+            const int writeCount = readWord(data, 6);
+            const int byteCount = quint8(data[8]);
+            if(readCount < 1 || readCount > 0x7D || writeCount < 1 || writeCount > 0x79 ||
+               byteCount != writeCount * 2 || data.size() != 9 + byteCount)
+            {
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+            }
+
+            if(!unitMap->contains(QModbusDataUnit::HoldingRegisters, readAddress, readCount) ||
+               !unitMap->contains(QModbusDataUnit::HoldingRegisters, writeAddress, writeCount))
+            {
+                return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+            }
+
+            // the write operation is performed before the read
+            quint16 values[0x7D];
+            for(int i = 0; i < writeCount; i++)
+                values[i] = readWord(data, 9 + i * 2);
+
+            unitMap->writeValues(QModbusDataUnit::HoldingRegisters, writeAddress, values, writeCount);
+            emit unitDataWritten(deviceId, QModbusDataUnit::HoldingRegisters, writeAddress, writeCount);
+
+            unitMap->readValues(QModbusDataUnit::HoldingRegisters, readAddress, values, readCount);
+
+            QByteArray payload(1 + readCount * 2, 0);
+            payload[0] = char(readCount * 2);
+            for(int i = 0; i < readCount; i++)
+            {
+                payload[1 + i * 2] = char(values[i] >> 8);
+                payload[2 + i * 2] = char(values[i]);
+            }
+
+            return QModbusResponse(req.functionCode(), payload);
+        }
+
+        case QModbusPdu::ReadFifoQueue:
+        {
+            if(data.size() != 2)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            // the first register holds the count of the queued registers that follow it
+            const int address = readWord(data, 0);
+            quint16 values[32];
+            if(!unitMap->contains(QModbusDataUnit::HoldingRegisters, address, 1))
+                return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+
+            unitMap->readValues(QModbusDataUnit::HoldingRegisters, address, values, 1);
+            const int count = values[0];
+            if(count > 31)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            if(!unitMap->contains(QModbusDataUnit::HoldingRegisters, address, count + 1))
+                return exceptionResponse(req, QModbusPdu::IllegalDataAddress);
+
+            unitMap->readValues(QModbusDataUnit::HoldingRegisters, address, values, count + 1);
+
+            const int byteCount = (count + 1) * 2;
+            QByteArray payload(2 + byteCount, 0);
+            payload[0] = char(byteCount >> 8);
+            payload[1] = char(byteCount);
+            for(int i = 0; i <= count; i++)
+            {
+                payload[2 + i * 2] = char(values[i] >> 8);
+                payload[3 + i * 2] = char(values[i]);
+            }
+
+            return QModbusResponse(req.functionCode(), payload);
+        }
+
+        case QModbusPdu::ReadExceptionStatus:
+        {
+            if(!data.isEmpty())
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            if(!unitMap->contains(QModbusDataUnit::Coils, _exceptionStatusOffset, 8))
+                return exceptionResponse(req, QModbusPdu::ServerDeviceFailure);
+
+            quint16 values[8];
+            unitMap->readValues(QModbusDataUnit::Coils, _exceptionStatusOffset, values, 8);
+
+            quint8 status = 0;
+            for(int i = 0; i < 8; i++)
+                status |= (values[i] ? 1 : 0) << i;
+
+            return QModbusResponse(req.functionCode(), QByteArray(1, char(status)));
+        }
+
+        case QModbusPdu::ReportServerId:
+        {
+            if(!data.isEmpty())
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            return QModbusResponse(req.functionCode(), _serverIdData);
+        }
+
+        case QModbusPdu::Diagnostics:
+        {
+            if(data.size() < 2)
+                return exceptionResponse(req, QModbusPdu::IllegalDataValue);
+
+            // Return Query Data echoes the request, the other sub-functions use the counters of QModbusServer
+            if(readWord(data, 0) == 0x0000)
+                return QModbusResponse(req.functionCode(), data);
+
+            return exceptionResponse(req, QModbusPdu::IllegalFunction);
+        }
+
+        default:
+            // QModbusServer lives on the thread of its owner, its state is not touched from the workers
+            return exceptionResponse(req, QModbusPdu::IllegalFunction);
+    }
+}
+
+#endif // Q_OS_LINUX
@@ -0,0 +1,111 @@
+#ifndef MODBUSEPOLLSERVER_H
+#define MODBUSEPOLLSERVER_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <QThread>
+#include <QModbusServer>
+#include "modbusdataunitmap.h"
+#include "modbusstatistics.h"
+
+///
+/// \brief The ModbusEpollServer class implements Modbus/TCP listener on non-blocking sockets and epoll
+///
+/// Connections are spread over a pool of worker threads, each running its own epoll loop.
+/// Register access goes directly to the shared ModbusDataUnitMapList, all signals are
+/// emitted from the worker threads and reach GUI objects as queued connections.
+///
+/// The workers answer the register function codes, Read FIFO Queue, Read Exception Status,
+/// Report Server ID and the Return Query Data diagnostic. Functions that keep state in
+/// QModbusServer are not answered, see UnsupportedFunctions.
+///
+class ModbusEpollServer : public QModbusServer
+{
+    Q_OBJECT
+
+public:
+    explicit ModbusEpollServer(ModbusDataUnitMapList* unitMaps, ModbusStatistics* statistics, QObject *parent = nullptr);
+    ~ModbusEpollServer() override;
+
+    int connectionCount() const;
+    int workerCount() const;
+
+    /// \brief UnsupportedFunctions - answered with an Illegal Function exception
+    static constexpr const char* UnsupportedFunctions =
+            "Diagnostics other than Return Query Data (0x08), Get Comm Event Counter (0x0B), "
+            "Get Comm Event Log (0x0C), Read/Write File Record (0x14, 0x15) and "
+            "Encapsulated Interface Transport (0x2B)";
+
+signals:
+    void request(const QModbusRequest& req, quint8 deviceId, int transactionId, quint64 connectionId);
+    void response(const QModbusResponse& resp, quint8 deviceId, int transactionId, quint64 connectionId);
+    void unitDataWritten(quint8 deviceId, QModbusDataUnit::RegisterType table, int address, int size);
+
+protected:
+    bool open() override;
+    void close() override;
+
+    bool readData(QModbusDataUnit* newData) const override;
+    bool writeData(const QModbusDataUnit& newData) override;
+
+private:
+    ///
+    /// \brief The Connection struct
+    ///
+    struct Connection
+    {
+        int Socket = -1;
+        quint64 Id = 0;         // unique while the server runs, addresses of closed connections are reused
+        QByteArray ReadBuffer;
+        QByteArray WriteBuffer;
+        bool WaitingWrite = false;
+    };
+
+    ///
+    /// \brief The Worker struct
+    ///
+    struct Worker
+    {
+        int EpollFd = -1;
+        int EventFd = -1;
+        bool Listening = false;
+        QScopedPointer<QThread> Thread;
+        std::atomic<int> ConnectionCount{0};
+        std::unordered_map<int, std::unique_ptr<Connection>> Connections;
+    };
+
+    bool addWorker();
+    void runWorker(Worker* worker);
+    void listen(Worker* worker);
+
+    void acceptConnections(Worker* worker);
+    void closeConnection(Worker* worker, Connection* conn);
+
+    void readConnection(Worker* worker, Connection* conn);
+    bool writeConnection(Worker* worker, Connection* conn);
+    bool processFrames(Worker* worker, Connection* conn);
+
+    QModbusResponse processUnitRequest(quint8 deviceId, const QModbusRequest& req);
+
+private:
+    ModbusDataUnitMapList* _unitMaps;
+    ModbusStatistics* _statistics;
+
+    int _listenFd = -1;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::atomic<quint64> _connectionCounter{0};
+
+    // server values taken when the listener opens, the workers do not touch QModbusServer
+    quint16 _exceptionStatusOffset = 0;
+    QByteArray _serverIdData;
+};
+
+#endif // Q_OS_LINUX
+
+#endif // MODBUSEPOLLSERVER_H
@@ -0,0 +1,209 @@
+#include <cstring>
+#include "modbuslogbuffer.h"
+
+///
+/// \brief ModbusLogBuffer::ModbusLogBuffer
+/// \param capacity
+///
+ModbusLogBuffer::ModbusLogBuffer(int capacity)
+    :_startTime(QDateTime::currentDateTime())
+{
+    _clock.start();
+    setCapacity(capacity);
+}
+
+///
+/// \brief ModbusLogBuffer::capacity
+/// \return
+///
+int ModbusLogBuffer::capacity() const
+{
+    return _records.size();
+}
+
+///
+/// \brief ModbusLogBuffer::setCapacity
+/// \param capacity - number of frames, the buffer is cleared
+///
+void ModbusLogBuffer::setCapacity(int capacity)
+{
+    capacity = qBound(1, capacity, MaxCapacity);
+
+    _records.resize(capacity);
+    _records.squeeze();
+    _slab.resize(qMax(MinSlabSize, capacity * AverageFrameSize));
+    _slab.squeeze();
+
+    clear();
+}
+
+///
+/// \brief ModbusLogBuffer::resize
+/// \param capacity - number of frames, the newest frames that fit are kept
+///
+void ModbusLogBuffer::resize(int capacity)
+{
+    const auto records = _records;
+    const auto slab = _slab;
+    const auto first = _first;
+    const auto count = _count;
+
+    setCapacity(capacity);
+
+    for(int i = 0; i < count; i++)
+    {
+        auto record = records[(first + i) % records.size()];
+        const auto data = slab.constData() + record.Offset;
+
+        removeFirst(overflow(record.Size, &record.Offset));
+        std::memcpy(_slab.data() + record.Offset, data, record.Size);
+        _records[(_first + _count) % _records.size()] = record;
+
+        _writePos = record.Offset + record.Size;
+        _count++;
+    }
+}
+
+///
+/// \brief ModbusLogBuffer::clear
+///
+void ModbusLogBuffer::clear()
+{
+    _first = 0;
+    _count = 0;
+    _writePos = 0;
+}
+
+///
+/// \brief ModbusLogBuffer::overflow
+/// \param size - frame size in bytes
+/// \param offset - where the frame goes in the slab
+/// \return number of the oldest frames to drop before the frame fits
+///
+int ModbusLogBuffer::overflow(int size, quint32* offset) const
+{
+    int count = (_count == _records.size()) ? 1 : 0;
+
+    auto pos = _writePos;
+    if(pos + size > quint32(_slab.size()))
+    {
+        // frames between the write position and the end of the slab are the oldest ones
+        while(count < _count && at(count).Offset >= pos)
+            count++;
+
+        pos = 0;
+    }
+
+    while(count < _count && at(count).Offset >= pos && at(count).Offset < pos + size)
+        count++;
+
+    if(offset) *offset = pos;
+    return count;
+}
+
+///
+/// \brief ModbusLogBuffer::removeFirst
+/// \param count
+///
+void ModbusLogBuffer::removeFirst(int count)
+{
+    count = qMin(count, _count);
+    _first = (_first + count) % _records.size();
+    _count -= count;
+}
+
+///
+/// \brief ModbusLogBuffer::append
+/// \param pdu
+/// \param protocol
+/// \param deviceId
+/// \param transactionId
+/// \param request
+///
+void ModbusLogBuffer::append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request)
+{
+    append(pdu, protocol, deviceId, transactionId, request, _clock.nsecsElapsed());
+}
+
+///
+/// \brief ModbusLogBuffer::append
+/// \param pdu
+/// \param protocol
+/// \param deviceId
+/// \param transactionId
+/// \param request
+/// \param timestamp - wall clock time of a frame that was logged earlier, e.g. read from a journal
+///
+void ModbusLogBuffer::append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request, const QDateTime& timestamp)
+{
+    append(pdu, protocol, deviceId, transactionId, request, _startTime.msecsTo(timestamp) * 1000000);
+}
+
+///
+/// \brief ModbusLogBuffer::append
+/// \param pdu
+/// \param protocol
+/// \param deviceId
+/// \param transactionId
+/// \param request
+/// \param timestamp - nanoseconds since the buffer was created
+///
+void ModbusLogBuffer::append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request, qint64 timestamp)
+{
+    const int size = 1 + pdu.dataSize();
+
+    quint32 offset;
+    removeFirst(overflow(size, &offset));
+
+    auto& record = _records[(_first + _count) % _records.size()];
+    record.Timestamp = timestamp;
+    record.Offset = offset;
+    record.Size = quint16(size);
+    record.TransactionId = quint16(transactionId);
+    record.DeviceId = quint8(deviceId);
+    record.Protocol = quint8(protocol);
+    record.Request = request;
+
+    auto data = reinterpret_cast<uchar*>(_slab.data()) + offset;
+    data[0] = pdu.isException() ? (pdu.functionCode() | QModbusPdu::ExceptionByte) : pdu.functionCode();
+    std::memcpy(data + 1, pdu.data().constData(), size - 1);
+
+    _writePos = offset + size;
+    _count++;
+}
+
+///
+/// \brief ModbusLogBuffer::timestamp
+/// \param record
+/// \return wall clock time of the frame
+///
+QDateTime ModbusLogBuffer::timestamp(const ModbusLogRecord& record) const
+{
+    return _startTime.addMSecs(record.Timestamp / 1000000);
+}
+
+///
+/// \brief ModbusLogBuffer::createMessage
+/// \param i
+/// \return decoded frame, owned by the caller
+///
+const ModbusMessage* ModbusLogBuffer::createMessage(int i) const
+{
+    if(i < 0 || i >= _count)
+        return nullptr;
+
+    const auto& record = at(i);
+    const auto bytes = pdu(record);
+    const auto code = QModbusPdu::FunctionCode(bytes[0]);
+    const auto data = QByteArray(reinterpret_cast<const char*>(bytes + 1), record.Size - 1);
+    const auto protocol = ModbusMessage::ProtocolType(record.Protocol);
+
+    const auto msg = record.Request ?
+                ModbusMessage::create(QModbusRequest(code, data), protocol, record.DeviceId, timestamp(record), true) :
+                ModbusMessage::create(QModbusResponse(code, data), protocol, record.DeviceId, timestamp(record), false);
+
+    if(protocol == ModbusMessage::Tcp)
+        ((QModbusAduTcp*)msg->adu())->setTransactionId(record.TransactionId);
+
+    return msg;
+}
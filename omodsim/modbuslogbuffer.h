@@ -0,0 +1,79 @@
+#ifndef MODBUSLOGBUFFER_H
+#define MODBUSLOGBUFFER_H
+
+#include <QVector>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include "modbusmessage.h"
+
+///
+/// \brief The ModbusLogRecord struct - one logged frame, the PDU bytes are kept in the buffer slab
+///
+struct ModbusLogRecord
+{
+    qint64 Timestamp;       // nanoseconds since the buffer was created
+    quint32 Offset;         // function code and data in the slab
+    quint16 Size;
+    quint16 TransactionId;
+    quint8 DeviceId;
+    quint8 Protocol;
+    bool Request;
+};
+Q_DECLARE_TYPEINFO(ModbusLogRecord, Q_PRIMITIVE_TYPE);
+
+///
+/// \brief The ModbusLogBuffer class - ring buffer of raw frames
+///
+/// Records and PDU bytes live in two preallocated rings, appending a frame only copies its bytes
+/// and drops the oldest frames when either ring is full. Frames are decoded on demand.
+///
+class ModbusLogBuffer
+{
+public:
+    explicit ModbusLogBuffer(int capacity = 30);
+
+    static constexpr int MaxCapacity = 5000000;
+
+    int capacity() const;
+    void setCapacity(int capacity);
+    void resize(int capacity);
+
+    int size() const { return _count; }
+    bool isEmpty() const { return _count == 0; }
+    void clear();
+
+    int overflow(int size, quint32* offset = nullptr) const;
+    void removeFirst(int count);
+    void append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request);
+    void append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request, const QDateTime& timestamp);
+
+    const ModbusLogRecord& at(int i) const {
+        return _records[(_first + i) % _records.size()];
+    }
+
+    const uchar* pdu(const ModbusLogRecord& record) const {
+        return reinterpret_cast<const uchar*>(_slab.constData()) + record.Offset;
+    }
+
+    QDateTime timestamp(const ModbusLogRecord& record) const;
+    const ModbusMessage* createMessage(int i) const;
+
+private:
+    void append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request, qint64 timestamp);
+
+private:
+    // room for frames of typical size, the longest PDU always fits
+    static constexpr int AverageFrameSize = 64;
+    static constexpr int MinSlabSize = 64 * 1024;
+
+    QVector<ModbusLogRecord> _records;
+    QByteArray _slab;
+    int _first = 0;
+    int _count = 0;
+    quint32 _writePos = 0;
+
+    QElapsedTimer _clock;
+    QDateTime _startTime;
+};
+
+#endif // MODBUSLOGBUFFER_H
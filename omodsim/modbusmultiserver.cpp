@@ -1,14 +1,327 @@
+#include <QThread>
 #include "numericutils.h"
+#include "modbuslimits.h"
+#include "qmodbusadurtu.h"
 #include "modbusmultiserver.h"
 
+///
+/// \brief MbapHeaderSize
+///
+static constexpr int MbapHeaderSize = 7;
+
+///
+/// \brief The ModbusTcpServer::ConnectionObserver class
+///
+class ModbusTcpServer::ConnectionObserver : public QModbusTcpConnectionObserver
+{
+public:
+    explicit ConnectionObserver(ModbusTcpServer* server)
+        :_server(server)
+    {
+    }
+
+    bool acceptNewConnection(QTcpSocket* newClient) override
+    {
+        _server->acceptConnection(newClient);
+        return true;
+    }
+
+private:
+    ModbusTcpServer* _server;
+};
+
+///
+/// \brief ModbusTcpServer::ModbusTcpServer
+/// \param unitMaps
+/// \param statistics
+/// \param parent
+///
+ModbusTcpServer::ModbusTcpServer(ModbusDataUnitMapList* unitMaps, ModbusStatistics* statistics, QObject *parent)
+    : QModbusTcpServer(parent)
+    ,_unitMaps(unitMaps)
+    ,_statistics(statistics)
+{
+    Q_ASSERT(_unitMaps != nullptr);
+    Q_ASSERT(_statistics != nullptr);
+    installConnectionObserver(new ConnectionObserver(this));
+}
+
+///
+/// \brief ModbusTcpServer::acceptConnection
+/// \param socket
+///
+void ModbusTcpServer::acceptConnection(QTcpSocket* socket)
+{
+    // connected before QModbusTcpServer own handler, so requests are peeked before they are processed
+    // socket addresses are reused after a disconnect, the counter is not
+    const quint64 connectionId = ++_connectionCounter;
+    auto buffer = QSharedPointer<QByteArray>::create();
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket, buffer, connectionId]
+    {
+        peekRequests(socket, *buffer, connectionId);
+    });
+}
+
+///
+/// \brief ModbusTcpServer::peekRequests
+/// \param socket
+/// \param buffer
+/// \param connectionId
+///
+void ModbusTcpServer::peekRequests(QTcpSocket* socket, QByteArray& buffer, quint64 connectionId)
+{
+    // QModbusTcpServer processes all complete frames of a socket at once,
+    // anything left in the queue belongs to frames it has dropped
+    _pendingRequests.clear();
+
+    buffer.append(socket->peek(socket->bytesAvailable()));
+    while(buffer.size() >= MbapHeaderSize)
+    {
+        const quint16 transactionId = quint8(buffer[0]) << 8 | quint8(buffer[1]);
+        const quint16 length = quint8(buffer[4]) << 8 | quint8(buffer[5]);
+        const quint8 deviceId = buffer[6];
+
+        // same framing as QModbusTcpServer, the length includes the unit identifier
+        const int size = MbapHeaderSize + quint16(length - 1);
+        if(buffer.size() < size)
+            break;
+
+        if(_unitMaps->isServed(deviceId))
+            _pendingRequests.enqueue({ deviceId, transactionId, connectionId });
+
+        buffer.remove(0, size);
+    }
+
+    // QModbusTcpServer ignores frames not addressed to serverAddress
+    if(!_pendingRequests.isEmpty())
+        setServerAddress(_pendingRequests.head().DeviceId);
+}
+
+///
+/// \brief ModbusTcpServer::processRequest
+/// \param req
+/// \return
+///
+QModbusResponse ModbusTcpServer::processRequest(const QModbusPdu &req)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    _pendingRequest = _pendingRequests.isEmpty() ? PendingRequest{ quint8(serverAddress()), 0, 0 } : _pendingRequests.dequeue();
+
+    emit request(req, _pendingRequest.DeviceId, _pendingRequest.TransactionId, _pendingRequest.ConnectionId);
+    auto resp = QModbusTcpServer::processRequest(req);
+    emit response(resp, _pendingRequest.DeviceId, _pendingRequest.TransactionId, _pendingRequest.ConnectionId);
+
+    _statistics->addRequest(req, resp, timer.nsecsElapsed());
+
+    // the server address stays the requested unit until the request is processed
+    if(!_pendingRequests.isEmpty())
+        setServerAddress(_pendingRequests.head().DeviceId);
+
+    return resp;
+}
+
+///
+/// \brief ModbusTcpServer::readData
+/// \param newData
+/// \return
+///
+bool ModbusTcpServer::readData(QModbusDataUnit* newData) const
+{
+    const auto unitMap = _unitMaps->find(serverAddress());
+    return unitMap && unitMap->readData(newData);
+}
+
+///
+/// \brief ModbusTcpServer::writeData
+/// \param newData
+/// \return
+///
+bool ModbusTcpServer::writeData(const QModbusDataUnit& newData)
+{
+    const auto unitMap = _unitMaps->find(serverAddress());
+    if(!unitMap || !unitMap->writeData(newData))
+        return false;
+
+    emit dataWritten(newData.registerType(), newData.startAddress(), newData.valueCount());
+    return true;
+}
+
+///
+/// \brief ModbusRtuServer::ModbusRtuServer
+/// \param unitMaps
+/// \param statistics
+/// \param parent
+///
+ModbusRtuServer::ModbusRtuServer(ModbusDataUnitMapList* unitMaps, ModbusStatistics* statistics, QObject *parent)
+    : QModbusRtuSerialServer(parent)
+    ,_unitMaps(unitMaps)
+    ,_statistics(statistics)
+{
+    Q_ASSERT(_unitMaps != nullptr);
+    Q_ASSERT(_statistics != nullptr);
+
+    // QModbusRtuSerialServer drops frames not addressed to serverAddress, so its reader is replaced
+    auto port = device();
+    disconnect(port, &QIODevice::readyRead, this, nullptr);
+    connect(port, &QIODevice::readyRead, this, &ModbusRtuServer::readFrames);
+}
+
+///
+/// \brief ModbusRtuServer::frameDelay
+/// \return silent interval between frames in microseconds, 3.5 characters or 1750 above 19200 baud
+///
+qint64 ModbusRtuServer::frameDelay() const
+{
+    const auto baudRate = connectionParameter(QModbusDevice::SerialBaudRateParameter).toInt();
+    return (baudRate <= 0 || baudRate > 19200) ? 1750 : 38500000 / baudRate;
+}
+
+///
+/// \brief ModbusRtuServer::readFrames
+///
+void ModbusRtuServer::readFrames()
+{
+    // a silent interval ends the frame, whatever is left of it is garbage
+    if(_frameTimer.isValid() && _frameTimer.nsecsElapsed() / 1000 > frameDelay())
+        _buffer.clear();
+
+    _frameTimer.start();
+    _buffer.append(device()->readAll());
+
+    while(_buffer.size() >= 2)
+    {
+        // the request size follows from the function code and, for writes, the byte count
+        const QModbusRequest head(QModbusPdu::FunctionCode(quint8(_buffer[1])), _buffer.mid(2));
+        const int dataSize = QModbusRequest::calculateDataSize(head);
+        if(dataSize < 0)
+            return;
+
+        const int size = 2 + dataSize + 2;
+        if(_buffer.size() < size)
+            return;
+
+        const auto frame = _buffer.left(size);
+        _buffer.remove(0, size);
+        processFrame(frame);
+    }
+}
+
+///
+/// \brief ModbusRtuServer::processFrame
+/// \param frame - device address, PDU and CRC
+///
+void ModbusRtuServer::processFrame(const QByteArray& frame)
+{
+    const int size = frame.size() - 2;
+    const quint16 crc = quint8(frame[size]) << 8 | quint8(frame[size + 1]);
+    if(crc != QModbusAduRtu::calculateCRC(frame.constData(), size))
+    {
+        _buffer.clear();
+        return;
+    }
+
+    const quint8 deviceId = frame[0];
+    const QModbusRequest req(QModbusPdu::FunctionCode(quint8(frame[1])), frame.mid(2, size - 2));
+
+    // broadcast requests are processed by every unit and never answered
+    if(deviceId == 0)
+    {
+        for(int id = ModbusLimits::slaveRange().from(); id <= ModbusLimits::slaveRange().to(); id++)
+        {
+            if(!_unitMaps->isServed(id))
+                continue;
+
+            setServerAddress(id);
+            processRequest(req);
+        }
+        return;
+    }
+
+    // other devices share the line
+    if(!_unitMaps->isServed(deviceId))
+        return;
+
+    setServerAddress(deviceId);
+    const auto resp = processRequest(req);
+    if(value(QModbusServer::ListenOnlyMode).toBool())
+        return;
+
+    QByteArray adu;
+    adu.reserve(resp.size() + 3);
+    adu.append(char(deviceId));
+    adu.append(char(resp.isException() ? (resp.functionCode() | QModbusPdu::ExceptionByte) : resp.functionCode()));
+    adu.append(resp.data());
+
+    const auto respCrc = QModbusAduRtu::calculateCRC(adu.constData(), adu.size());
+    adu.append(char(respCrc >> 8));
+    adu.append(char(respCrc & 0xFF));
+
+    device()->write(adu);
+}
+
+///
+/// \brief ModbusRtuServer::readData
+/// \param newData
+/// \return
+///
+bool ModbusRtuServer::readData(QModbusDataUnit* newData) const
+{
+    const auto unitMap = _unitMaps->find(serverAddress());
+    return unitMap && unitMap->readData(newData);
+}
+
+///
+/// \brief ModbusRtuServer::writeData
+/// \param newData
+/// \return
+///
+bool ModbusRtuServer::writeData(const QModbusDataUnit& newData)
+{
+    const auto unitMap = _unitMaps->find(serverAddress());
+    if(!unitMap || !unitMap->writeData(newData))
+        return false;
+
+    emit dataWritten(newData.registerType(), newData.startAddress(), newData.valueCount());
+    return true;
+}
+
+bool ModbusMultiServer::_epollEnabled = false;
+int ModbusMultiServer::_updateRate = ModbusMultiServer::DefaultUpdateRate;
+QString ModbusMultiServer::_statisticsFile;
+
 ///
 /// \brief ModbusServer::ModbusServer
 /// \param parent
 ///
 ModbusMultiServer::ModbusMultiServer(QObject *parent)
     : QObject{parent}
-    ,_deviceId(1)
 {
+    _updateTimer.setSingleShot(true);
+    _updateTimer.setTimerType(Qt::PreciseTimer);
+    connect(&_updateTimer, &QTimer::timeout, this, &ModbusMultiServer::on_updateTimeout);
+
+    // every frame is logged once, traffic views filter the shared log
+    // the ingest filter drops unwanted frames before they are stored anywhere
+    connect(this, &ModbusMultiServer::request, &_trafficLog, [&](const QModbusRequest& req, ModbusMessage::ProtocolType protocol, quint8 deviceId, int transactionId, quint64 connectionId)
+    {
+        if(!_trafficFilter.accept(req, connectionId, deviceId, transactionId, true))
+            return;
+
+        _trafficLog.append(req, protocol, deviceId, transactionId, true);
+        _pcapWriter.append(req, protocol, deviceId, transactionId, true);
+        _trafficJournal.append(req, protocol, deviceId, transactionId, true, connectionId);
+    });
+    connect(this, &ModbusMultiServer::response, &_trafficLog, [&](const QModbusResponse& resp, ModbusMessage::ProtocolType protocol, quint8 deviceId, int transactionId, quint64 connectionId)
+    {
+        if(!_trafficFilter.accept(resp, connectionId, deviceId, transactionId, false))
+            return;
+
+        _trafficLog.append(resp, protocol, deviceId, transactionId, false);
+        _pcapWriter.append(resp, protocol, deviceId, transactionId, false);
+        _trafficJournal.append(resp, protocol, deviceId, transactionId, false, connectionId);
+    });
 }
 
 ///
@@ -18,45 +331,83 @@ ModbusMultiServer::~ModbusMultiServer()
 {
    for(auto&& s : _modbusServerList)
        s->disconnectDevice();
+
+   if(!_statisticsFile.isEmpty())
+       _statistics.dump(_statisticsFile);
 }
 
 ///
-/// \brief ModbusServer::deviceId
+/// \brief ModbusMultiServer::isEpollEnabled
 /// \return
 ///
-quint8 ModbusMultiServer::deviceId() const
+bool ModbusMultiServer::isEpollEnabled()
 {
-    return _deviceId;
+    return _epollEnabled;
 }
 
 ///
-/// \brief ModbusServer::setDeviceId
-/// \param deviceId
+/// \brief ModbusMultiServer::setEpollEnabled
+/// \param enabled - use epoll based listener for Modbus/TCP servers created afterwards
 ///
-void ModbusMultiServer::setDeviceId(quint8 deviceId)
+void ModbusMultiServer::setEpollEnabled(bool enabled)
 {
-    if(deviceId == _deviceId)
-        return;
+#ifdef Q_OS_LINUX
+    _epollEnabled = enabled;
+    if(enabled)
+        qWarning("Epoll listener does not support: %s", ModbusEpollServer::UnsupportedFunctions);
+#else
+    Q_UNUSED(enabled)
+#endif
+}
+
+///
+/// \brief ModbusMultiServer::updateRate
+/// \return
+///
+int ModbusMultiServer::updateRate()
+{
+    return _updateRate;
+}
 
-    _deviceId = deviceId;
+///
+/// \brief ModbusMultiServer::setUpdateRate
+/// \param rate - data change notifications per second, 0 notifies on every write
+///
+void ModbusMultiServer::setUpdateRate(int rate)
+{
+    _updateRate = qBound(0, rate, 1000);
+}
 
-    for(auto&& s : _modbusServerList)
-        s->setServerAddress(deviceId);
+///
+/// \brief ModbusMultiServer::statisticsFile
+/// \return
+///
+QString ModbusMultiServer::statisticsFile()
+{
+    return _statisticsFile;
+}
 
-    emit deviceIdChanged(deviceId);
+///
+/// \brief ModbusMultiServer::setStatisticsFile
+/// \param filename - request statistics are written there on exit, "-" is the standard output
+///
+void ModbusMultiServer::setStatisticsFile(const QString& filename)
+{
+    _statisticsFile = filename;
 }
 
 ///
 /// \brief ModbusMultiServer::addUnitMap
 /// \param id
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param length
 ///
-void ModbusMultiServer::addUnitMap(int id, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length)
+void ModbusMultiServer::addUnitMap(int id, quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length)
 {
-    _modbusDataUnitMap.addUnitMap(id, pointType, pointAddress, length);
-    reconfigureServers();
+    _unitMaps.removeUnitMap(id);
+    _unitMaps.unitMap(deviceId).addUnitMap(id, pointType, pointAddress, length);
 }
 
 ///
@@ -65,8 +416,30 @@ void ModbusMultiServer::addUnitMap(int id, QModbusDataUnit::RegisterType pointTy
 ///
 void ModbusMultiServer::removeUnitMap(int id)
 {
-    _modbusDataUnitMap.removeUnitMap(id);
-    reconfigureServers();
+    _unitMaps.removeUnitMap(id);
+}
+
+///
+/// \brief ModbusMultiServer::subscribe
+/// \param id
+/// \param deviceId
+/// \param pointType
+/// \param pointAddress
+/// \param length
+/// \param handler - receives the changed part of the range only
+///
+void ModbusMultiServer::subscribe(int id, quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length, ModbusDataDispatcher::Handler handler)
+{
+    _dataDispatcher.subscribe(id, deviceId, pointType, pointAddress, length, handler);
+}
+
+///
+/// \brief ModbusMultiServer::unsubscribe
+/// \param id
+///
+void ModbusMultiServer::unsubscribe(int id)
+{
+    _dataDispatcher.unsubscribe(id);
 }
 
 ///
@@ -118,25 +491,42 @@ QSharedPointer<QModbusServer> ModbusMultiServer::createModbusServer(const Connec
         {
             case ConnectionType::Tcp:
             {
-                modbusServer = QSharedPointer<QModbusServer>(new ModbusTcpServer(this));
+#ifdef Q_OS_LINUX
+                if(_epollEnabled)
+                {
+                    modbusServer = QSharedPointer<QModbusServer>(new ModbusEpollServer(&_unitMaps, &_statistics, this));
+                    connect((ModbusEpollServer*)modbusServer.get(), &ModbusEpollServer::request, this, [&](const QModbusRequest& req, quint8 deviceId, int transactionId, quint64 connectionId)
+                    {
+                        emit request(req, ModbusMessage::Tcp, deviceId, transactionId, connectionId);
+                    });
+                    connect((ModbusEpollServer*)modbusServer.get(), &ModbusEpollServer::response, this, [&](const QModbusResponse& resp, quint8 deviceId, int transactionId, quint64 connectionId)
+                    {
+                        emit response(resp, ModbusMessage::Tcp, deviceId, transactionId, connectionId);
+                    });
+                    connect((ModbusEpollServer*)modbusServer.get(), &ModbusEpollServer::unitDataWritten, this, &ModbusMultiServer::on_unitDataWritten);
+                }
+                else
+#endif
+                {
+                    modbusServer = QSharedPointer<QModbusServer>(new ModbusTcpServer(&_unitMaps, &_statistics, this));
+                    connect((ModbusTcpServer*)modbusServer.get(), &ModbusTcpServer::request, this, [&](const QModbusRequest& req, quint8 deviceId, int transactionId, quint64 connectionId)
+                    {
+                        emit request(req, ModbusMessage::Tcp, deviceId, transactionId, connectionId);
+                    });
+                    connect((ModbusTcpServer*)modbusServer.get(), &ModbusTcpServer::response, this, [&](const QModbusResponse& resp, quint8 deviceId, int transactionId, quint64 connectionId)
+                    {
+                        emit response(resp, ModbusMessage::Tcp, deviceId, transactionId, connectionId);
+                    });
+                }
                 modbusServer->setProperty("ConnectionDetails", QVariant::fromValue(cd));
                 modbusServer->setConnectionParameter(QModbusDevice::NetworkPortParameter, cd.TcpParams.ServicePort);
                 modbusServer->setConnectionParameter(QModbusDevice::NetworkAddressParameter, cd.TcpParams.IPAddress);
-
-                connect((ModbusTcpServer*)modbusServer.get(), &ModbusTcpServer::request, this, [&](const QModbusRequest& req, int transactionId)
-                {
-                    emit request(req, ModbusMessage::Tcp, transactionId);
-                });
-                connect((ModbusTcpServer*)modbusServer.get(), &ModbusTcpServer::response, this, [&](const QModbusResponse& resp, int transactionId)
-                {
-                    emit response(resp, ModbusMessage::Tcp, transactionId);
-                });
             }
             break;
 
             case ConnectionType::Serial:
             {
-                modbusServer = QSharedPointer<QModbusServer>(new ModbusRtuServer(this));
+                modbusServer = QSharedPointer<QModbusServer>(new ModbusRtuServer(&_unitMaps, &_statistics, this));
                 modbusServer->setProperty("ConnectionDetails", QVariant::fromValue(cd));
                 modbusServer->setProperty("DTRControl", cd.SerialParams.SetDTR);
                 modbusServer->setProperty("RTSControl", cd.SerialParams.SetRTS);
@@ -147,13 +537,15 @@ QSharedPointer<QModbusServer> ModbusMultiServer::createModbusServer(const Connec
                 modbusServer->setConnectionParameter(QModbusDevice::SerialStopBitsParameter, cd.SerialParams.StopBits);
                 qobject_cast<QSerialPort*>(modbusServer->device())->setFlowControl(cd.SerialParams.FlowControl);
 
-                connect((ModbusRtuServer*)modbusServer.get(), &ModbusRtuServer::request, this, [&](const QModbusRequest& req)
+                // one serial line is one connection
+                const auto connectionId = quint64(quintptr(modbusServer.get()));
+                connect((ModbusRtuServer*)modbusServer.get(), &ModbusRtuServer::request, this, [this, connectionId](const QModbusRequest& req, quint8 deviceId)
                 {
-                    emit request(req, ModbusMessage::Rtu, 0);
+                    emit request(req, ModbusMessage::Rtu, deviceId, 0, connectionId);
                 });
-                connect((ModbusRtuServer*)modbusServer.get(), &ModbusRtuServer::response, this, [&](const QModbusResponse& resp)
+                connect((ModbusRtuServer*)modbusServer.get(), &ModbusRtuServer::response, this, [this, connectionId](const QModbusResponse& resp, quint8 deviceId)
                 {
-                    emit response(resp, ModbusMessage::Rtu, 0);
+                    emit response(resp, ModbusMessage::Rtu, deviceId, 0, connectionId);
                 });
             }
             break;
@@ -183,15 +575,6 @@ void ModbusMultiServer::connectDevice(const ConnectionDetails& cd)
         addModbusServer(modbusServer);
     }
 
-    modbusServer->setServerAddress(_deviceId);
-    modbusServer->setMap(_modbusDataUnitMap);
-
-    for(auto data : _modbusDataUnitMap)
-    {
-        _modbusServerList.first()->data(&data);
-        modbusServer->setData(data);
-    }
-
     modbusServer->connectDevice();
 }
 
@@ -245,15 +628,6 @@ void ModbusMultiServer::removeModbusServer(QSharedPointer<QModbusServer> server)
         _modbusServerList.removeOne(server);
 }
 
-///
-/// \brief ModbusMultiServer::reconfigureServers
-///
-void ModbusMultiServer::reconfigureServers()
-{
-    for(auto&& s : _modbusServerList)
-        s->setMap(_modbusDataUnitMap);
-}
-
 ///
 /// \brief ModbusMultiServer::isConnected
 /// \return
@@ -292,28 +666,27 @@ QModbusDevice::State ModbusMultiServer::state(ConnectionType type, const QString
 
 ///
 /// \brief ModbusServer::data
-/// \param dd
+/// \param deviceId
+/// \param pointType
+/// \param pointAddress
+/// \param length
 /// \return
 ///
-QModbusDataUnit ModbusMultiServer::data(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length) const
+QModbusDataUnit ModbusMultiServer::data(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length) const
 {
-    return _modbusDataUnitMap.getData(pointType, pointAddress, length);
+    const auto unitMap = _unitMaps.find(deviceId);
+    return unitMap ? unitMap->getData(pointType, pointAddress, length) : QModbusDataUnit(pointType, pointAddress, length);
 }
 
 ///
 /// \brief ModbusMultiServer::setData
+/// \param deviceId
 /// \param data
 ///
-void ModbusMultiServer::setData(const QModbusDataUnit& data)
+void ModbusMultiServer::setData(quint8 deviceId, const QModbusDataUnit& data)
 {
-    _modbusDataUnitMap.setData(data);
-    for(auto&& s : _modbusServerList)
-    {
-        s->blockSignals(true);
-        s->setData(data);
-        s->blockSignals(false);
-    }
-    emit dataChanged(data);
+    _unitMaps.unitMap(deviceId).setData(data);
+    notifyDataChanged(deviceId, data.registerType(), data.startAddress(), data.valueCount());
 }
 
 ///
@@ -457,267 +830,334 @@ QModbusDataUnit createDoubleDataUnit(QModbusDataUnit::RegisterType type, int new
     return data;
 }
 
+///
+/// \brief createDataUnit
+/// \param pointType
+/// \param params
+/// \return
+///
+QModbusDataUnit createDataUnit(QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params)
+{
+    QModbusDataUnit data;
+    const auto addr = params.Address - (params.ZeroBasedAddress ? 0 : 1);
+    if(params.Value.userType() == qMetaTypeId<QVector<quint16>>())
+    {
+        switch (pointType)
+        {
+            case QModbusDataUnit::Coils:
+            case QModbusDataUnit::DiscreteInputs:
+                data = createDataUnit(pointType, addr, params.Value.value<QVector<quint16>>(), params.Order);
+            break;
+
+            case QModbusDataUnit::InputRegisters:
+            case QModbusDataUnit::HoldingRegisters:
+                data = createDataUnit(pointType, addr, params.Value.value<QVector<quint16>>(), params.Order);
+            break;
+
+            default:
+            break;
+        }
+    }
+    else
+    {
+        switch (pointType)
+        {
+            case QModbusDataUnit::Coils:
+            case QModbusDataUnit::DiscreteInputs:
+                data = createDataUnit(pointType, addr, params.Value.toBool(), params.Order);
+            break;
+
+            case QModbusDataUnit::InputRegisters:
+            case QModbusDataUnit::HoldingRegisters:
+                switch(params.DisplayMode)
+                {
+                    case DataDisplayMode::Binary:
+                    case DataDisplayMode::Decimal:
+                    case DataDisplayMode::Integer:
+                    case DataDisplayMode::Hex:
+                        data = createDataUnit(pointType, addr, params.Value.toUInt(), params.Order);
+                    break;
+                    case DataDisplayMode::FloatingPt:
+                        data = createFloatDataUnit(pointType, addr, params.Value.toFloat(), params.Order, false);
+                    break;
+                    case DataDisplayMode::SwappedFP:
+                        data = createFloatDataUnit(pointType, addr, params.Value.toFloat(), params.Order, true);
+                    break;
+                    case DataDisplayMode::DblFloat:
+                        data = createDoubleDataUnit(pointType, addr, params.Value.toDouble(), params.Order, false);
+                    break;
+                    case DataDisplayMode::SwappedDbl:
+                        data = createDoubleDataUnit(pointType, addr, params.Value.toDouble(), params.Order, true);
+                    break;
+                        
+                    case DataDisplayMode::Int32:
+                    case DataDisplayMode::UInt32:
+                        data = createInt32DataUnit(pointType, addr, params.Value.toInt(), params.Order, false);
+                    break;
+
+                    case DataDisplayMode::SwappedInt32:
+                    case DataDisplayMode::SwappedUInt32:
+                        data = createInt32DataUnit(pointType, addr, params.Value.toInt(), params.Order, true);
+                    break;
+
+                    case DataDisplayMode::Int64:
+                    case DataDisplayMode::UInt64:
+                        data = createInt64DataUnit(pointType, addr, params.Value.toLongLong(), params.Order, false);
+                        break;
+
+                    case DataDisplayMode::SwappedInt64:
+                    case DataDisplayMode::SwappedUInt64:
+                        data = createInt64DataUnit(pointType, addr, params.Value.toLongLong(), params.Order, true);
+                    break;
+                }
+            break;
+
+            default:
+            break;
+        }
+    }
+
+    return data;
+}
+
 ///
 /// \brief ModbusMultiServer::writeValue
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param value
 /// \param order
 ///
-void ModbusMultiServer::writeValue(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 value, ByteOrder order)
+void ModbusMultiServer::writeValue(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 value, ByteOrder order)
 {
     auto data = QModbusDataUnit(pointType, pointAddress, 1);
     data.setValue(0, toByteOrderValue(value, order));
-    setData(data);
+    setData(deviceId, data);
 }
 
 ///
 /// \brief ModbusMultiServer::readInt32
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param order
 /// \param swapped
 /// \return
 ///
-qint32 ModbusMultiServer::readInt32(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
+qint32 ModbusMultiServer::readInt32(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
 {
-    const auto data = this->data(pointType, pointAddress, 2);
+    const auto data = this->data(deviceId, pointType, pointAddress, 2);
     return swapped ?  makeInt32(data.value(1), data.value(0), order): makeInt32(data.value(0), data.value(1), order);
 }
 
 ///
 /// \brief ModbusMultiServer::writeInt32
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param value
 /// \param order
 /// \param swapped
 ///
-void ModbusMultiServer::writeInt32(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, qint32 value, ByteOrder order, bool swapped)
+void ModbusMultiServer::writeInt32(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, qint32 value, ByteOrder order, bool swapped)
 {
-    setData(createInt32DataUnit(pointType, pointAddress, value, order, swapped));
+    setData(deviceId, createInt32DataUnit(pointType, pointAddress, value, order, swapped));
 }
 
 ///
 /// \brief ModbusMultiServer::readUInt32
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param order
 /// \param swapped
 /// \return
 ///
-quint32 ModbusMultiServer::readUInt32(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
+quint32 ModbusMultiServer::readUInt32(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
 {
-    return (quint32)readInt32(pointType, pointAddress, order, swapped);
+    return (quint32)readInt32(deviceId, pointType, pointAddress, order, swapped);
 }
 
 ///
 /// \brief ModbusMultiServer::writeUInt32
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param value
 /// \param order
 /// \param swapped
 ///
-void ModbusMultiServer::writeUInt32(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint32 value, ByteOrder order, bool swapped)
+void ModbusMultiServer::writeUInt32(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint32 value, ByteOrder order, bool swapped)
 {
-    writeInt32(pointType, pointAddress, value, order, swapped);
+    writeInt32(deviceId, pointType, pointAddress, value, order, swapped);
 }
 
 ///
 /// \brief ModbusMultiServer::readInt64
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param order
 /// \param swapped
 /// \return
 ///
-qint64 ModbusMultiServer::readInt64(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
+qint64 ModbusMultiServer::readInt64(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
 {
-    const auto data = this->data(pointType, pointAddress, 4);
+    const auto data = this->data(deviceId, pointType, pointAddress, 4);
     return swapped ?  makeInt64(data.value(3), data.value(2), data.value(1), data.value(0), order):
                makeInt64(data.value(0), data.value(1), data.value(2), data.value(3), order);
 }
 
 ///
 /// \brief ModbusMultiServer::writeInt64
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param value
 /// \param order
 /// \param swapped
 ///
-void ModbusMultiServer::writeInt64(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, qint64 value, ByteOrder order, bool swapped)
+void ModbusMultiServer::writeInt64(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, qint64 value, ByteOrder order, bool swapped)
 {
-    setData(createInt64DataUnit(pointType, pointAddress, value, order, swapped));
+    setData(deviceId, createInt64DataUnit(pointType, pointAddress, value, order, swapped));
 }
 
 ///
 /// \brief ModbusMultiServer::readUInt64
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param order
 /// \param swapped
 /// \return
 ///
-quint64 ModbusMultiServer::readUInt64(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
+quint64 ModbusMultiServer::readUInt64(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
 {
-    return (quint64)readInt64(pointType, pointAddress, order, swapped);
+    return (quint64)readInt64(deviceId, pointType, pointAddress, order, swapped);
 }
 
 ///
 /// \brief ModbusMultiServer::writeUInt64
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param value
 /// \param order
 /// \param swapped
 ///
-void ModbusMultiServer::writeUInt64(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint64 value, ByteOrder order, bool swapped)
+void ModbusMultiServer::writeUInt64(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint64 value, ByteOrder order, bool swapped)
 {
-    writeInt64(pointType, pointAddress, value, order, swapped);
+    writeInt64(deviceId, pointType, pointAddress, value, order, swapped);
 }
 
 ///
 /// \brief ModbusMultiServer::readFloat
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param order
 /// \param swapped
 /// \return
 ///
-float ModbusMultiServer::readFloat(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
+float ModbusMultiServer::readFloat(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
 {
-    const auto data = this->data(pointType, pointAddress, 2);
+    const auto data = this->data(deviceId, pointType, pointAddress, 2);
     return swapped ?  makeFloat(data.value(1), data.value(0), order): makeFloat(data.value(0), data.value(1), order);
 }
 
 ///
 /// \brief ModbusMultiServer::writeFloat
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param value
 /// \param swapped
 ///
-void ModbusMultiServer::writeFloat(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, float value, ByteOrder order, bool swapped)
+void ModbusMultiServer::writeFloat(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, float value, ByteOrder order, bool swapped)
 {
-    setData(createFloatDataUnit(pointType, pointAddress, value, order, swapped));
+    setData(deviceId, createFloatDataUnit(pointType, pointAddress, value, order, swapped));
 }
 
 ///
 /// \brief ModbusMultiServer::readDouble
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param swapped
 /// \return
 ///
-double ModbusMultiServer::readDouble(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
+double ModbusMultiServer::readDouble(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped)
 {
-    const auto data = this->data(pointType, pointAddress, 4);
+    const auto data = this->data(deviceId, pointType, pointAddress, 4);
     return swapped ?  makeDouble(data.value(3), data.value(2), data.value(1), data.value(0), order):
                       makeDouble(data.value(0), data.value(1), data.value(2), data.value(3), order);
 }
 
 ///
 /// \brief ModbusMultiServer::writeDouble
+/// \param deviceId
 /// \param pointType
 /// \param pointAddress
 /// \param value
 /// \param swapped
 ///
-void ModbusMultiServer::writeDouble(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, double value, ByteOrder order, bool swapped)
+void ModbusMultiServer::writeDouble(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, double value, ByteOrder order, bool swapped)
 {
-    setData(createDoubleDataUnit(pointType, pointAddress, value, order, swapped));
+    setData(deviceId, createDoubleDataUnit(pointType, pointAddress, value, order, swapped));
 }
 
 ///
 /// \brief ModbusMultiServer::writeRegister
+/// \param deviceId
 /// \param pointType
 /// \param params
 ///
-void ModbusMultiServer::writeRegister(QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params)
+void ModbusMultiServer::writeRegister(quint8 deviceId, QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params)
 {
-    QModbusDataUnit data;
-    const auto addr = params.Address - (params.ZeroBasedAddress ? 0 : 1);
-    if(params.Value.userType() == qMetaTypeId<QVector<quint16>>())
-    {
-        switch (pointType)
-        {
-            case QModbusDataUnit::Coils:
-            case QModbusDataUnit::DiscreteInputs:
-                data = createDataUnit(pointType, addr, params.Value.value<QVector<quint16>>(), params.Order);
-            break;
+    const auto data = createDataUnit(pointType, params);
+    if(data.isValid())
+        setData(deviceId, data);
+}
 
-            case QModbusDataUnit::InputRegisters:
-            case QModbusDataUnit::HoldingRegisters:
-                data = createDataUnit(pointType, addr, params.Value.value<QVector<quint16>>(), params.Order);
-            break;
+///
+/// \brief ModbusMultiServer::writeRegisters
+/// \param deviceId
+/// \param pointType
+/// \param params - values in address order
+///
+void ModbusMultiServer::writeRegisters(quint8 deviceId, QModbusDataUnit::RegisterType pointType, const QVector<ModbusWriteParams>& params)
+{
+    int startAddress = 0;
+    QVector<quint16> values;
 
-            default:
-            break;
-        }
-    }
-    else
+    for(auto&& p : params)
     {
-        switch (pointType)
-        {
-            case QModbusDataUnit::Coils:
-            case QModbusDataUnit::DiscreteInputs:
-                data = createDataUnit(pointType, addr, params.Value.toBool(), params.Order);
-            break;
-
-            case QModbusDataUnit::InputRegisters:
-            case QModbusDataUnit::HoldingRegisters:
-                switch(params.DisplayMode)
-                {
-                    case DataDisplayMode::Binary:
-                    case DataDisplayMode::Decimal:
-                    case DataDisplayMode::Integer:
-                    case DataDisplayMode::Hex:
-                        data = createDataUnit(pointType, addr, params.Value.toUInt(), params.Order);
-                    break;
-                    case DataDisplayMode::FloatingPt:
-                        data = createFloatDataUnit(pointType, addr, params.Value.toFloat(), params.Order, false);
-                    break;
-                    case DataDisplayMode::SwappedFP:
-                        data = createFloatDataUnit(pointType, addr, params.Value.toFloat(), params.Order, true);
-                    break;
-                    case DataDisplayMode::DblFloat:
-                        data = createDoubleDataUnit(pointType, addr, params.Value.toDouble(), params.Order, false);
-                    break;
-                    case DataDisplayMode::SwappedDbl:
-                        data = createDoubleDataUnit(pointType, addr, params.Value.toDouble(), params.Order, true);
-                    break;
-                        
-                    case DataDisplayMode::Int32:
-                    case DataDisplayMode::UInt32:
-                        data = createInt32DataUnit(pointType, addr, params.Value.toInt(), params.Order, false);
-                    break;
+        const auto data = createDataUnit(pointType, p);
+        if(!data.isValid())
+            continue;
 
-                    case DataDisplayMode::SwappedInt32:
-                    case DataDisplayMode::SwappedUInt32:
-                        data = createInt32DataUnit(pointType, addr, params.Value.toInt(), params.Order, true);
-                    break;
+        // adjacent or overlapping values extend the current run, a gap commits it
+        const int offset = data.startAddress() - startAddress;
+        if(!values.isEmpty() && (offset < 0 || offset > values.size()))
+        {
+            setData(deviceId, QModbusDataUnit(pointType, startAddress, values));
+            values.clear();
+        }
 
-                    case DataDisplayMode::Int64:
-                    case DataDisplayMode::UInt64:
-                        data = createInt64DataUnit(pointType, addr, params.Value.toLongLong(), params.Order, false);
-                        break;
+        if(values.isEmpty())
+            startAddress = data.startAddress();
 
-                    case DataDisplayMode::SwappedInt64:
-                    case DataDisplayMode::SwappedUInt64:
-                        data = createInt64DataUnit(pointType, addr, params.Value.toLongLong(), params.Order, true);
-                    break;
-                }
-            break;
+        const int pos = data.startAddress() - startAddress;
+        const int count = int(data.valueCount());
+        if(values.size() < pos + count)
+            values.resize(pos + count);
 
-            default:
-            break;
-        }
+        for(int i = 0; i < count; i++)
+            values[pos + i] = data.value(i);
     }
 
-    if(data.isValid())
-        setData(data);
+    if(!values.isEmpty())
+        setData(deviceId, QModbusDataUnit(pointType, startAddress, values));
 }
 
 ///
@@ -783,19 +1223,81 @@ void ModbusMultiServer::on_dataWritten(QModbusDataUnit::RegisterType table, int
 {
     auto server = qobject_cast<QModbusServer*>(sender());
 
-    QModbusDataUnit data;
-    data.setRegisterType(table);
-    data.setStartAddress(address);
-    data.setValueCount(size);
-    server->data(&data);
+    // called while the request is processed, so the server address is the requested unit
+    on_unitDataWritten(server->serverAddress(), table, address, size);
+}
+
+///
+/// \brief ModbusMultiServer::on_unitDataWritten
+/// \param deviceId
+/// \param table
+/// \param address
+/// \param size
+///
+void ModbusMultiServer::on_unitDataWritten(quint8 deviceId, QModbusDataUnit::RegisterType table, int address, int size)
+{
+    notifyDataChanged(deviceId, table, address, size);
+}
 
-    if(table == QModbusDataUnit::Coils ||
-       table == QModbusDataUnit::DiscreteInputs)
+///
+/// \brief ModbusMultiServer::on_updateTimeout
+///
+void ModbusMultiServer::on_updateTimeout()
+{
+    QVector<ModbusDataCoalescer::DirtyRange> ranges;
     {
-        auto values = data.values();
-        for(auto& v : values) v = !!v; // force values to bit
-        data.setValues(values);
+        QMutexLocker locker(&_dirtyMutex);
+        ranges = _dataCoalescer.takeDirtyRanges();
+    }
+
+    for(auto&& range : ranges)
+    {
+        const auto unit = data(range.DeviceId, range.PointType, range.PointAddress, range.Length);
+
+        _dataDispatcher.dispatch(range.DeviceId, unit);
+        emit dataChanged(range.DeviceId, unit);
+    }
+}
+
+///
+/// \brief ModbusMultiServer::notifyDataChanged
+/// \param deviceId
+/// \param pointType
+/// \param pointAddress
+/// \param length
+///
+void ModbusMultiServer::notifyDataChanged(quint8 deviceId, QModbusDataUnit::RegisterType pointType, int pointAddress, int length)
+{
+    // register values are already visible to clients, only the notification is deferred
+    {
+        QMutexLocker locker(&_dirtyMutex);
+        _dataCoalescer.markDirty(deviceId, pointType, pointAddress, length);
     }
 
-    setData(data);
+    // writes from other threads hand the notification over to the owner thread once
+    if(QThread::currentThread() != thread())
+    {
+        if(!_updatePending.exchange(true))
+        {
+            QMetaObject::invokeMethod(this, [this]
+            {
+                _updatePending = false;
+                scheduleUpdate();
+            }, Qt::QueuedConnection);
+        }
+        return;
+    }
+
+    scheduleUpdate();
+}
+
+///
+/// \brief ModbusMultiServer::scheduleUpdate
+///
+void ModbusMultiServer::scheduleUpdate()
+{
+    if(_updateRate <= 0)
+        on_updateTimeout();
+    else if(!_updateTimer.isActive())
+        _updateTimer.start(qMax(1, 1000 / _updateRate));
 }
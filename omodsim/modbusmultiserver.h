@@ -1,14 +1,27 @@
 #ifndef MODBUSMULTISERVER_H
 #define MODBUSMULTISERVER_H
 
+#include <atomic>
+#include <QQueue>
+#include <QMutex>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QTcpSocket>
 #include <QModbusServer>
 #include <QModbusTcpServer>
 #include "modbusdataunitmap.h"
+#include "modbusdatadispatcher.h"
+#include "modbusdatacoalescer.h"
+#include "modbusstatistics.h"
+#include "modbustrafficlog.h"
+#include "modbuspcapwriter.h"
+#include "modbustrafficjournal.h"
+#include "modbustrafficfilter.h"
 #include "modbuswriteparams.h"
 #include "connectiondetails.h"
 #include "modbusmessage.h"
+#include "modbusepollserver.h"
 
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     #include <QModbusRtuSerialSlave>
@@ -25,64 +38,100 @@ class ModbusTcpServer : public QModbusTcpServer
     Q_OBJECT
 
 public:
-    explicit ModbusTcpServer(QObject *parent = nullptr)
-        : QModbusTcpServer(parent)
-    {
-    }
+    explicit ModbusTcpServer(ModbusDataUnitMapList* unitMaps, ModbusStatistics* statistics, QObject *parent = nullptr);
 
 signals:
-    void request(const QModbusRequest& req, int transactionId);
-    void response(const QModbusResponse& resp, int transactionId);
+    void request(const QModbusRequest& req, quint8 deviceId, int transactionId, quint64 connectionId);
+    void response(const QModbusResponse& resp, quint8 deviceId, int transactionId, quint64 connectionId);
 
 protected:
-    QModbusResponse processRequest(const QModbusPdu &req) override
-    {
-        emit request(req, 0);
-        auto resp = QModbusTcpServer::processRequest(req);
-        emit response(resp, 0);
-        return resp;
-    }
+    QModbusResponse processRequest(const QModbusPdu &req) override;
     QModbusResponse processPrivateRequest(const QModbusPdu &req) override
     {
-        emit request(req, 0);
+        emit request(req, _pendingRequest.DeviceId, _pendingRequest.TransactionId, _pendingRequest.ConnectionId);
         auto resp = QModbusTcpServer::processPrivateRequest(req);
-        emit response(resp, 0);
+        emit response(resp, _pendingRequest.DeviceId, _pendingRequest.TransactionId, _pendingRequest.ConnectionId);
         return resp;
     }
+
+    bool readData(QModbusDataUnit* newData) const override;
+    bool writeData(const QModbusDataUnit& newData) override;
+
+private:
+    void acceptConnection(QTcpSocket* socket);
+    void peekRequests(QTcpSocket* socket, QByteArray& buffer, quint64 connectionId);
+
+private:
+    class ConnectionObserver;
+
+    ///
+    /// \brief The PendingRequest struct
+    ///
+    struct PendingRequest
+    {
+        quint8 DeviceId = 0;
+        int TransactionId = 0;
+        quint64 ConnectionId = 0;
+    };
+
+    ModbusDataUnitMapList* _unitMaps;
+    ModbusStatistics* _statistics;
+    PendingRequest _pendingRequest;
+    QQueue<PendingRequest> _pendingRequests;
+    quint64 _connectionCounter = 0;
 };
 
 ///
 /// \brief The ModbusRtuServer class
 ///
+/// Frames are read from the serial port here instead of QModbusRtuSerialServer, so every
+/// unit ID with registers on the line is answered, not only the server address.
+///
 class ModbusRtuServer : public QModbusRtuSerialServer
 {
     Q_OBJECT
 
 public:
-    explicit ModbusRtuServer(QObject *parent = nullptr)
-        : QModbusRtuSerialServer(parent)
-    {
-    }
+    explicit ModbusRtuServer(ModbusDataUnitMapList* unitMaps, ModbusStatistics* statistics, QObject *parent = nullptr);
 
 signals:
-    void request(const QModbusRequest& req);
-    void response(const QModbusResponse& resp);
+    void request(const QModbusRequest& req, quint8 deviceId);
+    void response(const QModbusResponse& resp, quint8 deviceId);
 
 protected:
     QModbusResponse processRequest(const QModbusPdu &req) override
     {
-        emit request(req);
+        QElapsedTimer timer;
+        timer.start();
+
+        emit request(req, quint8(serverAddress()));
         auto resp = QModbusRtuSerialServer::processRequest(req);
-        emit response(resp);
+        emit response(resp, quint8(serverAddress()));
+
+        _statistics->addRequest(req, resp, timer.nsecsElapsed());
         return resp;
     }
     QModbusResponse processPrivateRequest(const QModbusPdu &req) override
     {
-        emit request(req);
+        emit request(req, quint8(serverAddress()));
         auto resp = QModbusRtuSerialServer::processPrivateRequest(req);
-        emit response(resp);
+        emit response(resp, quint8(serverAddress()));
         return resp;
     }
+
+    bool readData(QModbusDataUnit* newData) const override;
+    bool writeData(const QModbusDataUnit& newData) override;
+
+private:
+    void readFrames();
+    void processFrame(const QByteArray& frame);
+    qint64 frameDelay() const;
+
+private:
+    ModbusDataUnitMapList* _unitMaps;
+    ModbusStatistics* _statistics;
+    QByteArray _buffer;
+    QElapsedTimer _frameTimer;
 };
 
 ///
@@ -95,12 +144,30 @@ public:
     explicit ModbusMultiServer(QObject *parent = nullptr);
     ~ModbusMultiServer() override;
 
-    quint8 deviceId() const;
-    void setDeviceId(quint8 deviceId);
+    static bool isEpollEnabled();
+    static void setEpollEnabled(bool enabled);
+
+    static constexpr int DefaultUpdateRate = 30;
+    static int updateRate();
+    static void setUpdateRate(int rate);
+
+    static QString statisticsFile();
+    static void setStatisticsFile(const QString& filename);
+
+    ModbusStatistics& statistics() { return _statistics; }
+    const ModbusStatistics& statistics() const { return _statistics; }
 
-    void addUnitMap(int id, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length);
+    ModbusTrafficLog* trafficLog() { return &_trafficLog; }
+    ModbusPcapWriter* pcapWriter() { return &_pcapWriter; }
+    ModbusTrafficJournal* trafficJournal() { return &_trafficJournal; }
+    ModbusTrafficFilter* trafficFilter() { return &_trafficFilter; }
+
+    void addUnitMap(int id, quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length);
     void removeUnitMap(int id);
 
+    void subscribe(int id, quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length, ModbusDataDispatcher::Handler handler);
+    void unsubscribe(int id);
+
     void connectDevice(const ConnectionDetails& cd);
     void disconnectDevice(ConnectionType type, const QString& port);
 
@@ -110,56 +177,73 @@ public:
     bool isConnected(ConnectionType type, const QString& port) const;
     QModbusDevice::State state(ConnectionType type, const QString& port) const;
 
-    QModbusDataUnit data(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length) const;
-    void setData(const QModbusDataUnit& data);
+    QModbusDataUnit data(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 length) const;
+    void setData(quint8 deviceId, const QModbusDataUnit& data);
 
-    void writeValue(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 value, ByteOrder order);
-    void writeRegister(QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params);
+    void writeValue(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint16 value, ByteOrder order);
+    void writeRegister(quint8 deviceId, QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params);
+    void writeRegisters(quint8 deviceId, QModbusDataUnit::RegisterType pointType, const QVector<ModbusWriteParams>& params);
 
-    qint32 readInt32(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
-    void writeInt32(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, qint32 value, ByteOrder order, bool swapped);
+    qint32 readInt32(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
+    void writeInt32(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, qint32 value, ByteOrder order, bool swapped);
 
-    quint32 readUInt32(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
-    void writeUInt32(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint32 value, ByteOrder order, bool swapped);
+    quint32 readUInt32(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
+    void writeUInt32(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint32 value, ByteOrder order, bool swapped);
 
-    qint64 readInt64(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
-    void writeInt64(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, qint64 value, ByteOrder order, bool swapped);
+    qint64 readInt64(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
+    void writeInt64(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, qint64 value, ByteOrder order, bool swapped);
 
-    quint64 readUInt64(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
-    void writeUInt64(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint64 value, ByteOrder order, bool swapped);
+    quint64 readUInt64(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
+    void writeUInt64(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, quint64 value, ByteOrder order, bool swapped);
 
-    float readFloat(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
-    void writeFloat(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, float value, ByteOrder order, bool swapped);
+    float readFloat(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
+    void writeFloat(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, float value, ByteOrder order, bool swapped);
 
-    double readDouble(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
-    void writeDouble(QModbusDataUnit::RegisterType pointType, quint16 pointAddress, double value, ByteOrder order, bool swapped);
+    double readDouble(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, ByteOrder order, bool swapped);
+    void writeDouble(quint8 deviceId, QModbusDataUnit::RegisterType pointType, quint16 pointAddress, double value, ByteOrder order, bool swapped);
 
 signals:
     void connected(const ConnectionDetails& cd);
     void disconnected(const ConnectionDetails& cd);
-    void deviceIdChanged(quint8 deviceId);
-    void request(const QModbusRequest& req, ModbusMessage::ProtocolType protocol, int transactionId);
-    void response(const QModbusResponse& resp, ModbusMessage::ProtocolType protocol, int transactionId);
+    void request(const QModbusRequest& req, ModbusMessage::ProtocolType protocol, quint8 deviceId, int transactionId, quint64 connectionId);
+    void response(const QModbusResponse& resp, ModbusMessage::ProtocolType protocol, quint8 deviceId, int transactionId, quint64 connectionId);
     void connectionError(const QString& error);
-    void dataChanged(const QModbusDataUnit& data);
+    void dataChanged(quint8 deviceId, const QModbusDataUnit& data);
 
 private slots:
     void on_stateChanged(QModbusDevice::State state);
     void on_errorOccurred(QModbusDevice::Error error);
     void on_dataWritten(QModbusDataUnit::RegisterType table, int address, int size);
+    void on_unitDataWritten(quint8 deviceId, QModbusDataUnit::RegisterType table, int address, int size);
+    void on_updateTimeout();
 
 private:
     QSharedPointer<QModbusServer> findModbusServer(const ConnectionDetails& cd) const;
     QSharedPointer<QModbusServer> findModbusServer(ConnectionType type, const QString& port) const;
     QSharedPointer<QModbusServer> createModbusServer(const ConnectionDetails& cd);
 
-    void reconfigureServers();
     void addModbusServer(QSharedPointer<QModbusServer> server);
     void removeModbusServer(QSharedPointer<QModbusServer> server);
 
+    void notifyDataChanged(quint8 deviceId, QModbusDataUnit::RegisterType pointType, int pointAddress, int length);
+    void scheduleUpdate();
+
 private:
-    quint8 _deviceId;
-    ModbusDataUnitMap _modbusDataUnitMap;
+    static bool _epollEnabled;
+    static int _updateRate;
+    static QString _statisticsFile;
+
+    ModbusDataUnitMapList _unitMaps;
+    ModbusStatistics _statistics;
+    ModbusTrafficLog _trafficLog;
+    ModbusPcapWriter _pcapWriter;
+    ModbusTrafficJournal _trafficJournal;
+    ModbusTrafficFilter _trafficFilter;
+    ModbusDataDispatcher _dataDispatcher;
+    ModbusDataCoalescer _dataCoalescer;
+    QMutex _dirtyMutex;
+    std::atomic<bool> _updatePending{false};
+    QTimer _updateTimer;
     QList<QSharedPointer<QModbusServer>> _modbusServerList;
 };
 
@@ -0,0 +1,502 @@
+#include <chrono>
+#include <cstring>
+#include <QFileInfo>
+#include <QCoreApplication>
+#include <QtEndian>
+#include "qmodbusadurtu.h"
+#include "modbuspcapwriter.h"
+
+namespace {
+
+// pcapng block types and link types
+constexpr quint32 SectionHeaderBlock = 0x0A0D0D0A;
+constexpr quint32 InterfaceDescriptionBlock = 0x00000001;
+constexpr quint32 EnhancedPacketBlock = 0x00000006;
+constexpr quint16 LinkTypeEthernet = 1;
+constexpr quint16 LinkTypeUser0 = 147;
+
+// interfaces described in every file, in this order
+constexpr quint32 TcpInterface = 0;
+constexpr quint32 RtuInterface = 1;
+
+constexpr quint16 ModbusTcpPort = 502;
+constexpr quint16 ClientTcpPort = 49152;
+constexpr quint32 ServerAddress = 0x7F000001; // 127.0.0.1
+constexpr quint32 ClientAddress = 0x7F000002; // 127.0.0.2
+
+constexpr int EthernetHeaderSize = 14;
+constexpr int IpHeaderSize = 20;
+constexpr int TcpHeaderSize = 20;
+constexpr int MbapHeaderSize = 7;
+
+///
+/// \brief padded
+/// \param size
+/// \return size rounded up to 32 bits
+///
+inline int padded(int size)
+{
+    return (size + 3) & ~3;
+}
+
+///
+/// \brief put16 - appends little endian, the byte order of the written section
+///
+inline void put16(QByteArray& out, quint16 value)
+{
+    const auto v = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+///
+/// \brief put32 - appends little endian, the byte order of the written section
+///
+inline void put32(QByteArray& out, quint32 value)
+{
+    const auto v = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+///
+/// \brief putOption
+/// \param out
+/// \param code
+/// \param value
+///
+void putOption(QByteArray& out, quint16 code, const QByteArray& value)
+{
+    put16(out, code);
+    put16(out, quint16(value.size()));
+    out.append(value);
+    out.append(padded(value.size()) - value.size(), '\0');
+}
+
+///
+/// \brief checksum - internet checksum, continues from sum
+///
+quint32 checksum(const uchar* data, int size, quint32 sum = 0)
+{
+    for(int i = 0; i + 1 < size; i += 2)
+        sum += qFromBigEndian<quint16>(data + i);
+
+    if(size & 1)
+        sum += quint32(data[size - 1]) << 8;
+
+    return sum;
+}
+
+///
+/// \brief foldChecksum
+/// \param sum
+/// \return
+///
+quint16 foldChecksum(quint32 sum)
+{
+    while(sum >> 16)
+        sum = (sum & 0xFFFF) + (sum >> 16);
+
+    return quint16(~sum);
+}
+
+}
+
+///
+/// \brief ModbusPcapWriter::ModbusPcapWriter
+///
+ModbusPcapWriter::ModbusPcapWriter()
+    :_frames(new Frame[QueueSize])
+{
+    resetQueue();
+}
+
+///
+/// \brief ModbusPcapWriter::~ModbusPcapWriter
+///
+ModbusPcapWriter::~ModbusPcapWriter()
+{
+    stop();
+}
+
+///
+/// \brief ModbusPcapWriter::start
+/// \param params
+/// \param errorString
+/// \return
+///
+bool ModbusPcapWriter::start(const PcapCaptureParams& params, QString* errorString)
+{
+    stop();
+
+    _params = params;
+    _fileIndex = 0;
+    _startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+    _clock.start();
+
+    if(!openFile(0, errorString))
+        return false;
+
+    // frames left from the last capture, e.g. claimed while it was stopping, are discarded
+    resetQueue();
+    _dropped.store(0, std::memory_order_relaxed);
+
+    _quit = false;
+    _running.store(true, std::memory_order_release);
+
+    _thread.reset(QThread::create([this]{ run(); }));
+    _thread->start(QThread::LowPriority);
+
+    return true;
+}
+
+///
+/// \brief ModbusPcapWriter::stop - writes the queued frames and closes the file
+///
+void ModbusPcapWriter::stop()
+{
+    if(!_thread)
+        return;
+
+    _running.store(false, std::memory_order_release);
+
+    _mutex.lock();
+    _quit = true;
+    _wakeUp.wakeOne();
+    _mutex.unlock();
+
+    _thread->wait();
+    _thread.reset();
+
+    closeFile();
+}
+
+///
+/// \brief ModbusPcapWriter::isRunning
+/// \return
+///
+bool ModbusPcapWriter::isRunning() const
+{
+    return _running.load(std::memory_order_acquire);
+}
+
+///
+/// \brief ModbusPcapWriter::params
+/// \return
+///
+PcapCaptureParams ModbusPcapWriter::params() const
+{
+    return _params;
+}
+
+///
+/// \brief ModbusPcapWriter::droppedFrames
+/// \return frames lost because the queue was full
+///
+quint64 ModbusPcapWriter::droppedFrames() const
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+///
+/// \brief ModbusPcapWriter::append - queues a frame, may be called from any thread
+/// \param pdu
+/// \param protocol
+/// \param deviceId
+/// \param transactionId
+/// \param request
+///
+void ModbusPcapWriter::append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request)
+{
+    if(!isRunning())
+        return;
+
+    Frame* frame;
+    auto pos = _enqueuePos.load(std::memory_order_relaxed);
+    forever
+    {
+        frame = &_frames[pos % QueueSize];
+        const auto diff = qint32(frame->Sequence.load(std::memory_order_acquire) - pos);
+        if(diff == 0)
+        {
+            if(_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    const int size = qMin(1 + pdu.dataSize(), int(sizeof(frame->Pdu)));
+    frame->Timestamp = _clock.nsecsElapsed();
+    frame->Size = quint16(size);
+    frame->TransactionId = quint16(transactionId);
+    frame->DeviceId = quint8(deviceId);
+    frame->Protocol = quint8(protocol);
+    frame->Request = request;
+    frame->Pdu[0] = pdu.isException() ? (pdu.functionCode() | QModbusPdu::ExceptionByte) : pdu.functionCode();
+    std::memcpy(frame->Pdu + 1, pdu.data().constData(), size - 1);
+
+    frame->Sequence.store(pos + 1, std::memory_order_release);
+}
+
+///
+/// \brief ModbusPcapWriter::resetQueue - empties the queue, called while no writer thread runs
+///
+void ModbusPcapWriter::resetQueue()
+{
+    for(int i = 0; i < QueueSize; i++)
+        _frames[i].Sequence.store(quint32(i), std::memory_order_relaxed);
+
+    _enqueuePos.store(0, std::memory_order_relaxed);
+    _dequeuePos.store(0, std::memory_order_relaxed);
+}
+
+///
+/// \brief ModbusPcapWriter::run - writer thread, drains the queue until stopped
+///
+void ModbusPcapWriter::run()
+{
+    forever
+    {
+        _mutex.lock();
+        const bool quit = _quit;
+        _mutex.unlock();
+
+        forever
+        {
+            const auto pos = _dequeuePos.load(std::memory_order_relaxed);
+            auto& frame = _frames[pos % QueueSize];
+            if(qint32(frame.Sequence.load(std::memory_order_acquire) - (pos + 1)) < 0)
+                break;
+
+            writeFrame(frame);
+
+            frame.Sequence.store(pos + QueueSize, std::memory_order_release);
+            _dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        }
+        flush();
+
+        if(quit)
+            break;
+
+        // producers never lock, the queue is polled
+        QMutexLocker locker(&_mutex);
+        if(!_quit) _wakeUp.wait(&_mutex, 10);
+    }
+}
+
+///
+/// \brief ModbusPcapWriter::openFile - starts a new file with the section header and interfaces
+/// \param timestamp - nanoseconds since the capture was started
+/// \param errorString
+/// \return
+///
+bool ModbusPcapWriter::openFile(qint64 timestamp, QString* errorString)
+{
+    auto filename = _params.FileName;
+    if(_params.MaxFileSize > 0 || _params.MaxFileDuration > 0)
+    {
+        const QFileInfo fi(_params.FileName);
+        const auto suffix = fi.suffix().isEmpty() ? QString("pcapng") : fi.suffix();
+        filename = QString("%1/%2_%3.%4").arg(fi.path(), fi.completeBaseName(), QString::number(++_fileIndex).rightJustified(5, '0'), suffix);
+    }
+
+    _file.setFileName(filename);
+    if(!_file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        if(errorString) *errorString = _file.errorString();
+        return false;
+    }
+
+    QByteArray options;
+    const auto application = QString("%1 %2").arg(QCoreApplication::applicationName(), QCoreApplication::applicationVersion());
+    putOption(options, 4, application.toUtf8()); // shb_userappl
+    put32(options, 0);                           // opt_endofopt
+
+    const int shbSize = 28 + options.size();
+    put32(_buffer, SectionHeaderBlock);
+    put32(_buffer, quint32(shbSize));
+    put32(_buffer, 0x1A2B3C4D);         // byte order magic
+    put16(_buffer, 1);                  // version 1.0
+    put16(_buffer, 0);
+    put32(_buffer, 0xFFFFFFFF);         // section length is not known
+    put32(_buffer, 0xFFFFFFFF);
+    _buffer.append(options);
+    put32(_buffer, quint32(shbSize));
+
+    auto addInterface = [&](quint16 linkType, const QByteArray& name)
+    {
+        QByteArray options;
+        putOption(options, 2, name);                // if_name
+        putOption(options, 9, QByteArray(1, 9));    // if_tsresol, nanoseconds
+        put32(options, 0);
+
+        const int idbSize = 20 + options.size();
+        put32(_buffer, InterfaceDescriptionBlock);
+        put32(_buffer, quint32(idbSize));
+        put16(_buffer, linkType);
+        put16(_buffer, 0);
+        put32(_buffer, 0);                          // no snapshot length limit
+        _buffer.append(options);
+        put32(_buffer, quint32(idbSize));
+    };
+    addInterface(LinkTypeEthernet, "modbus-tcp");
+    addInterface(LinkTypeUser0, "modbus-rtu");
+
+    _fileSize = 0;
+    _fileStart = timestamp;
+    _fileFrames = 0;
+    flush();
+
+    return true;
+}
+
+///
+/// \brief ModbusPcapWriter::closeFile
+///
+void ModbusPcapWriter::closeFile()
+{
+    flush();
+    if(_file.isOpen())
+        _file.close();
+}
+
+///
+/// \brief ModbusPcapWriter::writeFrame - appends an enhanced packet block, rotates the file first if needed
+/// \param frame
+///
+void ModbusPcapWriter::writeFrame(const Frame& frame)
+{
+    if(!_file.isOpen())
+        return;
+
+    const auto packet = (frame.Protocol == ModbusMessage::Tcp) ? tcpPacket(frame) : rtuPacket(frame);
+    const int epbSize = 32 + padded(packet.size());
+
+    const bool sizeExceeded = _params.MaxFileSize > 0 && _fileFrames > 0 && _fileSize + _buffer.size() + epbSize > _params.MaxFileSize;
+    const bool timeExceeded = _params.MaxFileDuration > 0 && frame.Timestamp - _fileStart >= _params.MaxFileDuration * 1000000000LL;
+    if(sizeExceeded || timeExceeded)
+    {
+        closeFile();
+        if(!openFile(frame.Timestamp))
+            return;
+    }
+
+    const quint64 timestamp = quint64(_startTime + frame.Timestamp);
+    put32(_buffer, EnhancedPacketBlock);
+    put32(_buffer, quint32(epbSize));
+    put32(_buffer, frame.Protocol == ModbusMessage::Tcp ? TcpInterface : RtuInterface);
+    put32(_buffer, quint32(timestamp >> 32));
+    put32(_buffer, quint32(timestamp));
+    put32(_buffer, quint32(packet.size()));
+    put32(_buffer, quint32(packet.size()));
+    _buffer.append(packet);
+    _buffer.append(padded(packet.size()) - packet.size(), '\0');
+    put32(_buffer, quint32(epbSize));
+    _fileFrames++;
+}
+
+///
+/// \brief ModbusPcapWriter::flush
+///
+void ModbusPcapWriter::flush()
+{
+    if(_buffer.isEmpty())
+        return;
+
+    if(_file.isOpen())
+    {
+        _fileSize += _file.write(_buffer);
+        _file.flush();
+    }
+    _buffer.resize(0);
+}
+
+///
+/// \brief ModbusPcapWriter::tcpPacket
+/// \param frame
+/// \return Ethernet frame with the MBAP message, requests go from the client to port 502
+///
+QByteArray ModbusPcapWriter::tcpPacket(const Frame& frame)
+{
+    const int payloadSize = MbapHeaderSize + frame.Size;
+    const int tcpSize = TcpHeaderSize + payloadSize;
+    const int ipSize = IpHeaderSize + tcpSize;
+
+    QByteArray packet(EthernetHeaderSize + ipSize, '\0');
+    auto eth = reinterpret_cast<uchar*>(packet.data());
+    auto ip = eth + EthernetHeaderSize;
+    auto tcp = ip + IpHeaderSize;
+    auto mbap = tcp + TcpHeaderSize;
+
+    // locally administered MAC addresses, the last byte tells the side
+    eth[0] = eth[6] = 0x02;
+    eth[5] = frame.Request ? 1 : 2;
+    eth[11] = frame.Request ? 2 : 1;
+    qToBigEndian<quint16>(0x0800, eth + 12);
+
+    const auto srcAddr = frame.Request ? ClientAddress : ServerAddress;
+    const auto dstAddr = frame.Request ? ServerAddress : ClientAddress;
+
+    ip[0] = 0x45;
+    qToBigEndian<quint16>(quint16(ipSize), ip + 2);
+    qToBigEndian<quint16>(_ipId++, ip + 4);
+    qToBigEndian<quint16>(0x4000, ip + 6); // don't fragment
+    ip[8] = 64;
+    ip[9] = 6;
+    qToBigEndian<quint32>(srcAddr, ip + 12);
+    qToBigEndian<quint32>(dstAddr, ip + 16);
+    qToBigEndian<quint16>(foldChecksum(checksum(ip, IpHeaderSize)), ip + 10);
+
+    auto& seq = frame.Request ? _clientSeq : _serverSeq;
+    const auto ack = frame.Request ? _serverSeq : _clientSeq;
+
+    qToBigEndian<quint16>(frame.Request ? ClientTcpPort : ModbusTcpPort, tcp);
+    qToBigEndian<quint16>(frame.Request ? ModbusTcpPort : ClientTcpPort, tcp + 2);
+    qToBigEndian<quint32>(seq, tcp + 4);
+    qToBigEndian<quint32>(ack, tcp + 8);
+    tcp[12] = (TcpHeaderSize / 4) << 4;
+    tcp[13] = 0x18; // PSH, ACK
+    qToBigEndian<quint16>(0xFFFF, tcp + 14);
+    seq += quint32(payloadSize);
+
+    qToBigEndian<quint16>(frame.TransactionId, mbap);
+    qToBigEndian<quint16>(0, mbap + 2);
+    qToBigEndian<quint16>(quint16(frame.Size + 1), mbap + 4);
+    mbap[6] = frame.DeviceId;
+    std::memcpy(mbap + MbapHeaderSize, frame.Pdu, frame.Size);
+
+    uchar pseudo[12] = {};
+    qToBigEndian<quint32>(srcAddr, pseudo);
+    qToBigEndian<quint32>(dstAddr, pseudo + 4);
+    pseudo[9] = 6;
+    qToBigEndian<quint16>(quint16(tcpSize), pseudo + 10);
+    qToBigEndian<quint16>(foldChecksum(checksum(tcp, tcpSize, checksum(pseudo, sizeof(pseudo)))), tcp + 16);
+
+    return packet;
+}
+
+///
+/// \brief ModbusPcapWriter::rtuPacket
+/// \param frame
+/// \return serial line frame: device address, PDU and CRC
+///
+QByteArray ModbusPcapWriter::rtuPacket(const Frame& frame) const
+{
+    QByteArray packet;
+    packet.reserve(frame.Size + 3);
+    packet.append(char(frame.DeviceId));
+    packet.append(reinterpret_cast<const char*>(frame.Pdu), frame.Size);
+
+    const auto crc = QModbusAduRtu::calculateCRC(packet.constData(), packet.size());
+    packet.append(char(crc >> 8));
+    packet.append(char(crc & 0xFF));
+
+    return packet;
+}
@@ -0,0 +1,105 @@
+#ifndef MODBUSPCAPWRITER_H
+#define MODBUSPCAPWRITER_H
+
+#include <atomic>
+#include <memory>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include "modbusmessage.h"
+
+///
+/// \brief The PcapCaptureParams struct
+///
+struct PcapCaptureParams
+{
+    QString FileName;
+    qint64 MaxFileSize = 0;     // bytes, 0 - no size limit
+    int MaxFileDuration = 0;    // seconds, 0 - no time limit
+};
+
+///
+/// \brief The ModbusPcapWriter class - captures Modbus traffic to pcapng files
+///
+/// Frames are copied into a bounded lock-free queue and written by a background thread, so
+/// appending never waits for the disk. TCP frames are wrapped into MBAP and fake Ethernet/IPv4/TCP
+/// headers (port 502), RTU frames get the device address and CRC and use the USER0 link type.
+/// When a size or time limit is set the capture goes to numbered files, e.g. capture_00001.pcapng.
+/// Frames that do not fit in the queue are dropped and counted.
+///
+class ModbusPcapWriter
+{
+public:
+    explicit ModbusPcapWriter();
+    ~ModbusPcapWriter();
+
+    ModbusPcapWriter(const ModbusPcapWriter&) = delete;
+    ModbusPcapWriter& operator=(const ModbusPcapWriter&) = delete;
+
+    static constexpr int QueueSize = 16384;
+
+    bool start(const PcapCaptureParams& params, QString* errorString = nullptr);
+    void stop();
+
+    bool isRunning() const;
+    PcapCaptureParams params() const;
+    quint64 droppedFrames() const;
+
+    void append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request);
+
+private:
+    ///
+    /// \brief The Frame struct - one queued frame, Sequence tells whose turn it is to use the slot
+    ///
+    struct Frame
+    {
+        std::atomic<quint32> Sequence;
+        qint64 Timestamp;       // nanoseconds since the capture was started
+        quint16 Size;
+        quint16 TransactionId;
+        quint8 DeviceId;
+        quint8 Protocol;
+        bool Request;
+        uchar Pdu[256];         // function code and data
+    };
+
+    void resetQueue();
+    void run();
+    bool openFile(qint64 timestamp, QString* errorString = nullptr);
+    void closeFile();
+    void writeFrame(const Frame& frame);
+    void flush();
+
+    QByteArray tcpPacket(const Frame& frame);
+    QByteArray rtuPacket(const Frame& frame) const;
+
+private:
+    std::unique_ptr<Frame[]> _frames;
+    alignas(64) std::atomic<quint32> _enqueuePos{0};
+    alignas(64) std::atomic<quint32> _dequeuePos{0};
+    alignas(64) std::atomic<bool> _running{false};
+    std::atomic<quint64> _dropped{0};
+
+    PcapCaptureParams _params;
+    QScopedPointer<QThread> _thread;
+    QMutex _mutex;
+    QWaitCondition _wakeUp;
+    bool _quit = false;
+
+    QElapsedTimer _clock;
+    qint64 _startTime = 0;  // nanoseconds since epoch
+
+    QFile _file;
+    QByteArray _buffer;
+    qint64 _fileSize = 0;
+    qint64 _fileStart = 0;
+    qint64 _fileFrames = 0;
+    int _fileIndex = 0;
+    quint32 _clientSeq = 0;
+    quint32 _serverSeq = 0;
+    quint16 _ipId = 0;
+};
+
+#endif // MODBUSPCAPWRITER_H
@@ -2,6 +2,7 @@
 #define MODBUSSIMULATIONPARAMS_H
 
 #include <QDataStream>
+#include <QModbusDataUnit>
 #include "qrange.h"
 #include "enums.h"
 
@@ -110,6 +111,72 @@ inline QDataStream& operator >>(QDataStream& in, DecrementSimulationParams& para
     return in;
 }
 
+///
+/// \brief The WaveformSimulationParams class
+///
+struct WaveformSimulationParams
+{
+    double Amplitude = 1000.;
+    double Offset = 0.;
+    double Period = 10000.; // milliseconds
+    double Phase = 0.;      // degrees
+    double Noise = 0.;      // amplitude of the uniform noise added to the signal
+};
+Q_DECLARE_METATYPE(WaveformSimulationParams)
+
+///
+/// \brief operator <<
+/// \param out
+/// \param params
+/// \return
+///
+inline QDataStream& operator <<(QDataStream& out, const WaveformSimulationParams& params)
+{
+    out << params.Amplitude;
+    out << params.Offset;
+    out << params.Period;
+    out << params.Phase;
+    out << params.Noise;
+    return out;
+}
+
+///
+/// \brief operator >>
+/// \param in
+/// \param params
+/// \return
+///
+inline QDataStream& operator >>(QDataStream& in, WaveformSimulationParams& params)
+{
+    in >> params.Amplitude;
+    in >> params.Offset;
+    in >> params.Period;
+    in >> params.Phase;
+    in >> params.Noise;
+    return in;
+}
+
+///
+/// \brief isWaveformMode
+/// \param mode
+/// \return true if the simulation mode generates a waveform
+///
+inline bool isWaveformMode(SimulationMode mode)
+{
+    switch(mode)
+    {
+        case SimulationMode::Sine:
+        case SimulationMode::Square:
+        case SimulationMode::Triangle:
+        case SimulationMode::Sawtooth:
+        case SimulationMode::Exponential:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
 ///
 /// \brief The ModbusSimulationParams class
 ///
@@ -119,7 +186,8 @@ struct ModbusSimulationParams
     RandomSimulationParams RandomParams;
     IncrementSimulationParams IncrementParams;
     DecrementSimulationParams DecrementParams;
-    quint32 Interval = 1;
+    quint32 Interval = 1000; // milliseconds
+    WaveformSimulationParams WaveformParams;
 };
 Q_DECLARE_METATYPE(ModbusSimulationParams)
 
@@ -137,6 +205,10 @@ inline QDataStream& operator <<(QDataStream& out, const ModbusSimulationParams&
     out << params.DecrementParams;
     out << params.Interval;
 
+    // written only for the waveform modes, so older files read unchanged
+    if(isWaveformMode(params.Mode))
+        out << params.WaveformParams;
+
     return out;
 }
 
@@ -153,6 +225,57 @@ inline QDataStream& operator >>(QDataStream& in, ModbusSimulationParams& params)
     in >> params.IncrementParams;
     in >> params.DecrementParams;
     in >> params.Interval;
+
+    if(isWaveformMode(params.Mode))
+        in >> params.WaveformParams;
+
+    return in;
+}
+
+///
+/// \brief The ModbusSimulationRule class - one parameter set for a range of addresses
+///
+struct ModbusSimulationRule
+{
+    quint8 DeviceId = 1; // not streamed, rules are saved with the form of their unit
+    QModbusDataUnit::RegisterType Type = QModbusDataUnit::HoldingRegisters;
+    quint16 Address = 0;
+    quint16 Length = 1;
+    ModbusSimulationParams Params;
+    double PhaseOffset = 0.; // steps each point is ahead of the previous one
+};
+Q_DECLARE_METATYPE(ModbusSimulationRule)
+
+///
+/// \brief operator <<
+/// \param out
+/// \param rule
+/// \return
+///
+inline QDataStream& operator <<(QDataStream& out, const ModbusSimulationRule& rule)
+{
+    out << rule.Type;
+    out << rule.Address;
+    out << rule.Length;
+    out << rule.Params;
+    out << rule.PhaseOffset;
+
+    return out;
+}
+
+///
+/// \brief operator >>
+/// \param in
+/// \param rule
+/// \return
+///
+inline QDataStream& operator >>(QDataStream& in, ModbusSimulationRule& rule)
+{
+    in >> rule.Type;
+    in >> rule.Address;
+    in >> rule.Length;
+    in >> rule.Params;
+    in >> rule.PhaseOffset;
     return in;
 }
 
@@ -0,0 +1,213 @@
+#include <QFile>
+#include <QTextStream>
+#include "modbusfunction.h"
+#include "modbusstatistics.h"
+
+///
+/// \brief SubBucketBits - eight sub-buckets per power of two
+///
+static constexpr int SubBucketBits = 3;
+
+///
+/// \brief ModbusStatistics::ModbusStatistics
+///
+ModbusStatistics::ModbusStatistics()
+{
+    reset();
+}
+
+///
+/// \brief ModbusStatistics::addRequest
+/// \param req
+/// \param resp
+/// \param latency - nanoseconds
+///
+void ModbusStatistics::addRequest(const QModbusPdu& req, const QModbusPdu& resp, qint64 latency)
+{
+    auto& c = _counters[req.functionCode() & ~QModbusPdu::ExceptionByte];
+
+    c.Requests.fetch_add(1, std::memory_order_relaxed);
+    c.BytesIn.fetch_add(req.size(), std::memory_order_relaxed);
+    c.BytesOut.fetch_add(resp.size(), std::memory_order_relaxed);
+
+    if(resp.isException())
+        c.Exceptions.fetch_add(1, std::memory_order_relaxed);
+
+    c.Histogram[bucketIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+
+    auto maxLatency = c.MaxLatency.load(std::memory_order_relaxed);
+    while(latency > maxLatency && !c.MaxLatency.compare_exchange_weak(maxLatency, latency, std::memory_order_relaxed))
+        ;
+}
+
+///
+/// \brief ModbusStatistics::reset
+///
+void ModbusStatistics::reset()
+{
+    for(auto&& c : _counters)
+    {
+        c.Requests.store(0, std::memory_order_relaxed);
+        c.Exceptions.store(0, std::memory_order_relaxed);
+        c.BytesIn.store(0, std::memory_order_relaxed);
+        c.BytesOut.store(0, std::memory_order_relaxed);
+        c.MaxLatency.store(0, std::memory_order_relaxed);
+
+        for(auto&& bucket : c.Histogram)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+///
+/// \brief ModbusStatistics::totalRequests
+/// \return
+///
+quint64 ModbusStatistics::totalRequests() const
+{
+    quint64 total = 0;
+    for(auto&& c : _counters)
+        total += c.Requests.load(std::memory_order_relaxed);
+
+    return total;
+}
+
+///
+/// \brief ModbusStatistics::latencyPercentile
+/// \param percentile
+/// \return latency in nanoseconds over all function codes
+///
+qint64 ModbusStatistics::latencyPercentile(double percentile) const
+{
+    quint64 count = 0;
+    quint64 histogram[HistogramSize] = {};
+    for(auto&& c : _counters)
+    {
+        for(int i = 0; i < HistogramSize; i++)
+        {
+            const auto n = c.Histogram[i].load(std::memory_order_relaxed);
+            histogram[i] += n;
+            count += n;
+        }
+    }
+
+    return ModbusStatistics::percentile(histogram, count, percentile);
+}
+
+///
+/// \brief ModbusStatistics::report
+/// \return text table, one row per function code seen
+///
+QString ModbusStatistics::report() const
+{
+    QString text;
+    QTextStream out(&text);
+
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10\n").arg("FC", -4).arg("NAME", -22).arg("REQUESTS", 10).arg("EXCEPTIONS", 10)
+                                                      .arg("BYTES IN", 12).arg("BYTES OUT", 12).arg("P50 US", 10).arg("P99 US", 10)
+                                                      .arg("P99.9 US", 10).arg("MAX US", 10);
+
+    for(int fc = 0; fc < FunctionCount; fc++)
+    {
+        const auto& c = _counters[fc];
+        const auto requests = c.Requests.load(std::memory_order_relaxed);
+        if(requests == 0)
+            continue;
+
+        quint64 count = 0;
+        quint64 histogram[HistogramSize];
+        for(int i = 0; i < HistogramSize; i++)
+        {
+            histogram[i] = c.Histogram[i].load(std::memory_order_relaxed);
+            count += histogram[i];
+        }
+
+        const QString name = ModbusFunction(QModbusPdu::FunctionCode(fc));
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10\n").arg(QString("0x%1").arg(fc, 2, 16, QLatin1Char('0')), -4)
+                                                          .arg(name.isEmpty() ? "-" : name, -22)
+                                                          .arg(requests, 10)
+                                                          .arg(c.Exceptions.load(std::memory_order_relaxed), 10)
+                                                          .arg(c.BytesIn.load(std::memory_order_relaxed), 12)
+                                                          .arg(c.BytesOut.load(std::memory_order_relaxed), 12)
+                                                          .arg(percentile(histogram, count, 50.0) / 1000.0, 10, 'f', 1)
+                                                          .arg(percentile(histogram, count, 99.0) / 1000.0, 10, 'f', 1)
+                                                          .arg(percentile(histogram, count, 99.9) / 1000.0, 10, 'f', 1)
+                                                          .arg(c.MaxLatency.load(std::memory_order_relaxed) / 1000.0, 10, 'f', 1);
+    }
+
+    return text;
+}
+
+///
+/// \brief ModbusStatistics::dump
+/// \param filename - "-" writes to the standard output
+/// \return
+///
+bool ModbusStatistics::dump(const QString& filename) const
+{
+    QFile file(filename);
+    const bool opened = (filename == "-") ? file.open(stdout, QFile::WriteOnly | QFile::Text)
+                                          : file.open(QFile::WriteOnly | QFile::Text);
+    if(!opened)
+        return false;
+
+    QTextStream out(&file);
+    out << report();
+    return true;
+}
+
+///
+/// \brief ModbusStatistics::bucketIndex
+/// \param latency
+/// \return
+///
+int ModbusStatistics::bucketIndex(qint64 latency)
+{
+    const auto value = quint64(qMax<qint64>(0, latency));
+    if(value < (2 << SubBucketBits))
+        return int(value);
+
+    // highest set bit selects the power of two, the next bits the sub-bucket
+    const int shift = 63 - qCountLeadingZeroBits(value) - SubBucketBits;
+    const int index = (shift << SubBucketBits) + int(value >> shift);
+    return qMin(index, HistogramSize - 1);
+}
+
+///
+/// \brief ModbusStatistics::bucketValue
+/// \param index
+/// \return highest latency that falls into the bucket
+///
+qint64 ModbusStatistics::bucketValue(int index)
+{
+    if(index < (2 << SubBucketBits))
+        return index;
+
+    const int shift = (index >> SubBucketBits) - 1;
+    const qint64 mantissa = (index & ((1 << SubBucketBits) - 1)) | (1 << SubBucketBits);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+///
+/// \brief ModbusStatistics::percentile
+/// \param histogram
+/// \param count
+/// \param percentile
+/// \return
+///
+qint64 ModbusStatistics::percentile(const quint64* histogram, quint64 count, double percentile)
+{
+    if(count == 0)
+        return 0;
+
+    const auto rank = qMax<quint64>(1, quint64(count * percentile / 100.0 + 0.5));
+
+    quint64 total = 0;
+    for(int i = 0; i < HistogramSize; i++)
+    {
+        total += histogram[i];
+        if(total >= rank)
+            return bucketValue(i);
+    }
+
+    return bucketValue(HistogramSize - 1);
+}
@@ -0,0 +1,56 @@
+#ifndef MODBUSSTATISTICS_H
+#define MODBUSSTATISTICS_H
+
+#include <atomic>
+#include <QString>
+#include <QModbusPdu>
+
+///
+/// \brief The ModbusStatistics class counts processed requests per function code
+///
+/// Counters are updated with relaxed atomics, so requests may be recorded from any thread.
+/// Latencies are kept in log-linear histograms with eight sub-buckets per power of two.
+///
+class ModbusStatistics
+{
+public:
+    explicit ModbusStatistics();
+
+    ModbusStatistics(const ModbusStatistics&) = delete;
+    ModbusStatistics& operator=(const ModbusStatistics&) = delete;
+
+    static constexpr int FunctionCount = 0x80;
+    static constexpr int HistogramSize = 288;
+
+    void addRequest(const QModbusPdu& req, const QModbusPdu& resp, qint64 latency);
+    void reset();
+
+    quint64 totalRequests() const;
+    qint64 latencyPercentile(double percentile) const;
+
+    QString report() const;
+    bool dump(const QString& filename) const;
+
+private:
+    ///
+    /// \brief The FunctionCounters struct
+    ///
+    struct FunctionCounters
+    {
+        std::atomic<quint64> Requests;
+        std::atomic<quint64> Exceptions;
+        std::atomic<quint64> BytesIn;
+        std::atomic<quint64> BytesOut;
+        std::atomic<qint64> MaxLatency;
+        std::atomic<quint32> Histogram[HistogramSize];
+    };
+
+    static int bucketIndex(qint64 latency);
+    static qint64 bucketValue(int index);
+    static qint64 percentile(const quint64* histogram, quint64 count, double percentile);
+
+private:
+    FunctionCounters _counters[FunctionCount];
+};
+
+#endif // MODBUSSTATISTICS_H
@@ -0,0 +1,182 @@
+#include "trafficutils.h"
+#include "modbustrafficfilter.h"
+
+///
+/// \brief ModbusTrafficFilter::compile
+/// \param expression - e.g. fc=16;unit=1;addr=4000-4100, empty expression logs every frame
+/// \param errorString
+/// \return false if the expression is invalid, the filter is left unchanged then
+///
+bool ModbusTrafficFilter::compile(const QString& expression, QString* errorString)
+{
+    ModbusTrafficFilter filter;
+
+    for(auto&& term : expression.split(';', Qt::SkipEmptyParts))
+    {
+        const auto name = term.section('=', 0, 0).trimmed().toLower();
+        const auto value = term.section('=', 1).trimmed();
+
+        bool ok = true;
+        if(name == "fc")
+        {
+            filter._functionFilter = true;
+            for(auto&& fc : parseNumbers(value, &ok))
+            {
+                if(fc < 0 || fc >= int(filter._functionCodes.size())) ok = false;
+                else filter._functionCodes.set(fc);
+            }
+            ok = ok && filter._functionCodes.any();
+        }
+        else if(name == "unit")
+        {
+            filter._deviceFilter = true;
+            for(auto&& id : parseNumbers(value, &ok))
+            {
+                if(id < 0 || id >= int(filter._deviceIds.size())) ok = false;
+                else filter._deviceIds.set(id);
+            }
+            ok = ok && filter._deviceIds.any();
+        }
+        else if(name == "addr")
+        {
+            ok = parseRange(value, &filter._fromAddress, &filter._toAddress) &&
+                 filter._fromAddress >= 0 && filter._toAddress <= 0xFFFF;
+        }
+        else if(name == "exceptions")
+        {
+            filter._exceptionsOnly = true;
+        }
+        else if(name == "sample")
+        {
+            filter._sampleRate = value.toInt(&ok);
+            ok = ok && filter._sampleRate > 0;
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if(!ok)
+        {
+            if(errorString) *errorString = QString("Invalid filter term '%1'").arg(term.trimmed());
+            return false;
+        }
+    }
+
+    // exception responses carry no address and are not paired with a sampled request
+    if(filter._exceptionsOnly && (filter._fromAddress >= 0 || filter._sampleRate > 1))
+    {
+        if(errorString) *errorString = QString("Filter term 'exceptions' can not be combined with '%1'").arg(filter._fromAddress >= 0 ? "addr" : "sample");
+        return false;
+    }
+
+    filter._expression = expression.trimmed();
+    *this = filter;
+    return true;
+}
+
+///
+/// \brief ModbusTrafficFilter::clear - every frame is logged
+///
+void ModbusTrafficFilter::clear()
+{
+    *this = ModbusTrafficFilter();
+}
+
+///
+/// \brief ModbusTrafficFilter::accept
+/// \param pdu
+/// \param connectionId - transaction IDs are only unique within a connection
+/// \param deviceId
+/// \param transactionId
+/// \param request
+/// \return true if the frame is logged
+///
+bool ModbusTrafficFilter::accept(const QModbusPdu& pdu, quint64 connectionId, int deviceId, int transactionId, bool request)
+{
+    if(isEmpty())
+    {
+        _accepted++;
+        return true;
+    }
+
+    bool accepted = false;
+    const RequestKey key = { connectionId, (quint32(quint8(deviceId)) << 16) | quint16(transactionId) };
+
+    if(_exceptionsOnly)
+    {
+        // the request is gone by the time its response turns out to be an exception
+        accepted = !request && pdu.isException() && matchesRequest(pdu, deviceId);
+    }
+    else if(request)
+    {
+        accepted = matchesRequest(pdu, deviceId) && (_sampleCounter++ % _sampleRate) == 0;
+
+        _requestCounter++;
+        if(accepted)
+        {
+            _pendingRequests.insert(key, _requestCounter);
+            _pendingOrder.enqueue({ key, _requestCounter });
+        }
+        else
+        {
+            _pendingRequests.remove(key);
+        }
+
+        expirePendingRequests();
+    }
+    else
+    {
+        accepted = _pendingRequests.remove(key) > 0;
+    }
+
+    if(accepted) _accepted++;
+    else _dropped++;
+
+    return accepted;
+}
+
+///
+/// \brief ModbusTrafficFilter::expirePendingRequests - the oldest requests are forgotten first
+///
+void ModbusTrafficFilter::expirePendingRequests()
+{
+    while(!_pendingOrder.isEmpty())
+    {
+        const auto& oldest = _pendingOrder.head();
+        const auto it = _pendingRequests.constFind(oldest.first);
+        const bool pending = it != _pendingRequests.constEnd() && it.value() == oldest.second;
+
+        if(pending && _pendingRequests.size() <= MaxPendingRequests && _requestCounter - oldest.second < MaxPendingAge)
+            break;
+
+        if(pending) _pendingRequests.erase(it);
+        _pendingOrder.dequeue();
+    }
+}
+
+///
+/// \brief ModbusTrafficFilter::matchesRequest
+/// \param pdu
+/// \param deviceId
+/// \return true if function code, unit ID and start address match, exception responses have no address
+///
+bool ModbusTrafficFilter::matchesRequest(const QModbusPdu& pdu, int deviceId) const
+{
+    if(_functionFilter && !_functionCodes.test(pdu.functionCode() & 0x7F))
+        return false;
+
+    if(_deviceFilter && !_deviceIds.test(quint8(deviceId)))
+        return false;
+
+    if(_fromAddress >= 0 && !pdu.isException())
+    {
+        const auto data = pdu.data();
+        const uchar head[3] = { uchar(pdu.functionCode()), uchar(data.size() > 0 ? data.at(0) : 0), uchar(data.size() > 1 ? data.at(1) : 0) };
+        const auto address = startAddress(head, qMin(1 + data.size(), 3));
+        if(address < _fromAddress || address > _toAddress)
+            return false;
+    }
+
+    return true;
+}
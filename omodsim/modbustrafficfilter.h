@@ -0,0 +1,67 @@
+#ifndef MODBUSTRAFFICFILTER_H
+#define MODBUSTRAFFICFILTER_H
+
+#include <bitset>
+#include <QHash>
+#include <QQueue>
+#include <QString>
+#include <QModbusPdu>
+
+///
+/// \brief The ModbusTrafficFilter class - decides which frames are logged, before they are stored or decoded
+///
+/// The expression is a list of terms separated by semicolons, all of them must match:
+/// fc=15,16 (function codes), unit=1-3 (unit IDs), addr=4000-4100 (zero based start address),
+/// exceptions (exception responses only) and sample=10 (one matching request in ten).
+/// The terms are compiled into bitmaps and ranges that are checked against the raw PDU bytes.
+/// A response is logged when its request on the same connection was, exception responses are
+/// checked on their own, so exceptions can not be combined with addr or sample.
+///
+class ModbusTrafficFilter
+{
+public:
+    explicit ModbusTrafficFilter() = default;
+
+    bool compile(const QString& expression, QString* errorString = nullptr);
+    void clear();
+
+    QString expression() const { return _expression; }
+    bool isEmpty() const { return _expression.isEmpty(); }
+
+    bool accept(const QModbusPdu& pdu, quint64 connectionId, int deviceId, int transactionId, bool request);
+
+    quint64 acceptedFrames() const { return _accepted; }
+    quint64 droppedFrames() const { return _dropped; }
+
+private:
+    bool matchesRequest(const QModbusPdu& pdu, int deviceId) const;
+    void expirePendingRequests();
+
+private:
+    // connection, unit and transaction of a request
+    typedef QPair<quint64, quint32> RequestKey;
+
+    static constexpr int MaxPendingRequests = 4096;
+    static constexpr quint64 MaxPendingAge = 65536; // requests, responses that never came are forgotten
+
+    QString _expression;
+    bool _functionFilter = false;
+    std::bitset<128> _functionCodes;
+    bool _deviceFilter = false;
+    std::bitset<256> _deviceIds;
+    int _fromAddress = -1;
+    int _toAddress = -1;
+    bool _exceptionsOnly = false;
+    int _sampleRate = 1;
+    quint64 _sampleCounter = 0;
+
+    // logged requests waiting for their responses, with the request count they were logged at
+    QHash<RequestKey, quint64> _pendingRequests;
+    QQueue<QPair<RequestKey, quint64>> _pendingOrder;
+    quint64 _requestCounter = 0;
+
+    quint64 _accepted = 0;
+    quint64 _dropped = 0;
+};
+
+#endif // MODBUSTRAFFICFILTER_H
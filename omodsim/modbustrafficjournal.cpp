@@ -0,0 +1,687 @@
+#include <chrono>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include <QDir>
+#include <QtEndian>
+#include "modbustrafficjournal.h"
+#include "trafficutils.h"
+
+namespace {
+
+const QByteArray SegmentMagic("OMTJ");
+const QByteArray IndexMagic("OMTI");
+constexpr quint16 JournalVersion = 1;
+
+constexpr int ReadChunkSize = 1024 * 1024;
+
+// record flags
+constexpr quint8 RequestFlag = 0x01;
+constexpr quint8 AddressFlag = 0x02;
+constexpr int ProtocolShift = 4;
+
+///
+/// \brief fileHeader
+/// \param magic
+/// \param timestamp
+/// \return 16 bytes: magic, version, reserved and a timestamp
+///
+QByteArray fileHeader(const QByteArray& magic, qint64 timestamp)
+{
+    QByteArray header(16, '\0');
+    auto data = reinterpret_cast<uchar*>(header.data());
+    std::memcpy(data, magic.constData(), 4);
+    qToLittleEndian<quint16>(JournalVersion, data + 4);
+    qToLittleEndian<qint64>(timestamp, data + 8);
+    return header;
+}
+
+///
+/// \brief checkHeader
+/// \param header
+/// \param magic
+/// \return
+///
+bool checkHeader(const QByteArray& header, const QByteArray& magic)
+{
+    return header.size() == 16 && header.startsWith(magic) &&
+           qFromLittleEndian<quint16>(header.constData() + 4) == JournalVersion;
+}
+
+///
+/// \brief setBit
+/// \param bits
+/// \param n
+///
+inline void setBit(quint32* bits, int n)
+{
+    bits[n >> 5] |= 1u << (n & 31);
+}
+
+///
+/// \brief testBit
+/// \param bits
+/// \param n
+/// \return
+///
+inline bool testBit(const quint32* bits, int n)
+{
+    return bits[n >> 5] & (1u << (n & 31));
+}
+
+///
+/// \brief intersects
+/// \param a
+/// \param b
+/// \param size - number of words
+/// \return
+///
+inline bool intersects(const quint32* a, const quint32* b, int size)
+{
+    for(int i = 0; i < size; i++)
+        if(a[i] & b[i]) return true;
+
+    return false;
+}
+
+}
+
+///
+/// \brief ModbusTrafficJournal::ModbusTrafficJournal
+///
+ModbusTrafficJournal::ModbusTrafficJournal()
+{
+}
+
+///
+/// \brief ModbusTrafficJournal::~ModbusTrafficJournal
+///
+ModbusTrafficJournal::~ModbusTrafficJournal()
+{
+    close();
+}
+
+///
+/// \brief ModbusTrafficJournal::open - starts a new segment after the existing ones
+/// \param params
+/// \param errorString
+/// \return
+///
+bool ModbusTrafficJournal::open(const TrafficJournalParams& params, QString* errorString)
+{
+    close();
+
+    if(!QDir().mkpath(params.Directory))
+    {
+        if(errorString) *errorString = QString("Can not create directory %1").arg(params.Directory);
+        return false;
+    }
+
+    _params = params;
+
+    const auto numbers = segmentNumbers(params.Directory);
+    _segmentNumber = numbers.isEmpty() ? 0 : numbers.last();
+
+    // the first segment is created here, so a directory that can not be written is reported at once
+    if(!openFiles(_segmentNumber + 1, errorString))
+        return false;
+
+    _startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+    _clock.start();
+    _flushTimer.start();
+    _pendingAddresses.clear();
+    _pendingOrder.clear();
+    _requestCounter = 0;
+
+    _quit = false;
+    _jobs.clear();
+    _queuedBytes = 0;
+    _thread.reset(QThread::create([this]{ run(); }));
+    _thread->start(QThread::LowPriority);
+
+    _open = true;
+    startSegment();
+
+    return true;
+}
+
+///
+/// \brief ModbusTrafficJournal::close - writes the buffered frames and stops the writer thread
+///
+void ModbusTrafficJournal::close()
+{
+    if(!isOpen())
+        return;
+
+    finishBlock();
+    queueWrite();
+    _open = false;
+
+    _mutex.lock();
+    _quit = true;
+    _wakeUp.wakeOne();
+    _mutex.unlock();
+
+    _thread->wait();
+    _thread.reset();
+
+    closeFiles();
+}
+
+///
+/// \brief ModbusTrafficJournal::isOpen
+/// \return
+///
+bool ModbusTrafficJournal::isOpen() const
+{
+    return _open;
+}
+
+///
+/// \brief ModbusTrafficJournal::params
+/// \return
+///
+TrafficJournalParams ModbusTrafficJournal::params() const
+{
+    return _params;
+}
+
+///
+/// \brief ModbusTrafficJournal::append
+/// \param pdu
+/// \param protocol
+/// \param deviceId
+/// \param transactionId
+/// \param request
+/// \param connectionId - transaction IDs are only unique within a connection
+///
+void ModbusTrafficJournal::append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request, quint64 connectionId)
+{
+    if(!isOpen())
+        return;
+
+    const int size = 1 + pdu.dataSize();
+    const auto data = pdu.data();
+    const quint8 functionCode = pdu.isException() ? (pdu.functionCode() | QModbusPdu::ExceptionByte) : pdu.functionCode();
+
+    int address = -1;
+    const RequestKey key = { connectionId, (quint32(quint8(deviceId)) << 16) | quint16(transactionId) };
+    if(request)
+    {
+        const uchar head[3] = { functionCode, uchar(data.size() > 0 ? data.at(0) : 0), uchar(data.size() > 1 ? data.at(1) : 0) };
+        address = startAddress(head, qMin(size, 3));
+
+        _requestCounter++;
+        if(address >= 0)
+        {
+            _pendingAddresses.insert(key, { quint16(address), _requestCounter });
+            _pendingOrder.enqueue({ key, _requestCounter });
+        }
+        else
+        {
+            _pendingAddresses.remove(key);
+        }
+
+        expirePendingAddresses();
+    }
+    else
+    {
+        const auto it = _pendingAddresses.find(key);
+        if(it != _pendingAddresses.end())
+        {
+            address = it->Address;
+            _pendingAddresses.erase(it);
+        }
+    }
+
+    const int recordSize = RecordHeaderSize + size;
+    if(_params.MaxSegmentSize > 0 && _segmentSize + _buffer.size() > SegmentHeaderSize &&
+       _segmentSize + _buffer.size() + recordSize > _params.MaxSegmentSize)
+    {
+        finishBlock();
+        queueWrite();
+        startSegment();
+    }
+
+    const qint64 timestamp = _startTime + _clock.nsecsElapsed();
+    const quint64 offset = quint64(_segmentSize + _buffer.size());
+
+    quint8 flags = quint8(protocol << ProtocolShift);
+    if(request) flags |= RequestFlag;
+    if(address >= 0) flags |= AddressFlag;
+
+    uchar header[RecordHeaderSize];
+    qToLittleEndian<qint64>(timestamp, header);
+    qToLittleEndian<quint16>(quint16(transactionId), header + 8);
+    qToLittleEndian<quint16>(quint16(qMax(address, 0)), header + 10);
+    header[12] = quint8(deviceId);
+    header[13] = flags;
+    qToLittleEndian<quint16>(quint16(size), header + 14);
+
+    _buffer.append(reinterpret_cast<const char*>(header), RecordHeaderSize);
+    _buffer.append(char(functionCode));
+    _buffer.append(data);
+
+    if(_block.Count == 0)
+    {
+        _block.Offset = offset;
+        _block.FirstTimestamp = timestamp;
+    }
+    _block.LastTimestamp = timestamp;
+    _block.Size += quint32(recordSize);
+    _block.Count++;
+    setBit(_block.FunctionCodes, functionCode & ~QModbusPdu::ExceptionByte);
+    setBit(_block.DeviceIds, quint8(deviceId));
+    if(address >= 0)
+    {
+        _block.MinAddress = qMin(_block.MinAddress, quint16(address));
+        _block.MaxAddress = qMax(_block.MaxAddress, quint16(address));
+    }
+
+    if(_block.Count == IndexInterval)
+    {
+        finishBlock();
+        queueWrite();
+    }
+    else if(_flushTimer.elapsed() >= 1000)
+    {
+        queueWrite();
+    }
+}
+
+///
+/// \brief ModbusTrafficJournal::flush - waits until the buffered frames and finished index entries are on disk
+///
+void ModbusTrafficJournal::flush()
+{
+    if(!isOpen())
+        return;
+
+    queueWrite();
+
+    QMutexLocker locker(&_mutex);
+    while(!_jobs.isEmpty() || _writing)
+        _written.wait(&_mutex);
+}
+
+///
+/// \brief ModbusTrafficJournal::queueWrite - hands the buffered bytes to the writer thread
+///
+void ModbusTrafficJournal::queueWrite()
+{
+    _flushTimer.restart();
+    if(_buffer.isEmpty() && _indexBuffer.isEmpty())
+        return;
+
+    WriteJob job;
+    job.Segment = _segmentNumber;
+    job.Data.swap(_buffer);
+    job.Index.swap(_indexBuffer);
+    _segmentSize += job.Data.size();
+
+    const qint64 size = job.Data.size() + job.Index.size();
+
+    QMutexLocker locker(&_mutex);
+
+    // a disk that can not keep up slows appending down instead of filling the memory
+    while(_queuedBytes > 0 && _queuedBytes + size > MaxQueuedBytes)
+        _written.wait(&_mutex);
+
+    _jobs.enqueue(job);
+    _queuedBytes += size;
+    _wakeUp.wakeOne();
+}
+
+///
+/// \brief ModbusTrafficJournal::expirePendingAddresses - the oldest requests are forgotten first
+///
+void ModbusTrafficJournal::expirePendingAddresses()
+{
+    while(!_pendingOrder.isEmpty())
+    {
+        const auto& oldest = _pendingOrder.head();
+        const auto it = _pendingAddresses.constFind(oldest.first);
+        const bool pending = it != _pendingAddresses.constEnd() && it->Stamp == oldest.second;
+
+        if(pending && _pendingAddresses.size() <= MaxPendingAddresses && _requestCounter - oldest.second < MaxPendingAge)
+            break;
+
+        if(pending) _pendingAddresses.erase(it);
+        _pendingOrder.dequeue();
+    }
+}
+
+///
+/// \brief ModbusTrafficJournal::run - writer thread, writes the queued jobs until the journal is closed
+///
+void ModbusTrafficJournal::run()
+{
+    QMutexLocker locker(&_mutex);
+    forever
+    {
+        if(_jobs.isEmpty())
+        {
+            if(_quit) break;
+            _wakeUp.wait(&_mutex);
+            continue;
+        }
+
+        const auto job = _jobs.dequeue();
+        _writing = true;
+        locker.unlock();
+
+        if(job.Segment != _fileNumber)
+        {
+            closeFiles();
+
+            QString error;
+            if(!openFiles(job.Segment, &error))
+                qWarning("Traffic journal: %s", qPrintable(error));
+        }
+
+        if(_segment.isOpen())
+        {
+            _segment.write(job.Data);
+            _segment.flush();
+            _index.write(job.Index);
+            _index.flush();
+        }
+
+        locker.relock();
+        _writing = false;
+        _queuedBytes -= job.Data.size() + job.Index.size();
+        _written.wakeAll();
+    }
+}
+
+///
+/// \brief ModbusTrafficJournal::query
+/// \param directory
+/// \param query
+/// \param handler - called for every matching frame in time order
+/// \param errorString
+/// \return number of frames passed to the handler, -1 if the journal can not be read
+///
+int ModbusTrafficJournal::query(const QString& directory, const TrafficJournalQuery& query, Handler handler, QString* errorString)
+{
+    if(!QDir(directory).exists())
+    {
+        if(errorString) *errorString = QString("Directory %1 does not exist").arg(directory);
+        return -1;
+    }
+
+    const qint64 from = query.From.isValid() ? query.From.toMSecsSinceEpoch() * 1000000 : std::numeric_limits<qint64>::min();
+    const qint64 to = query.To.isValid() ? (query.To.toMSecsSinceEpoch() + 1) * 1000000 - 1 : std::numeric_limits<qint64>::max();
+
+    quint32 functionCodes[4] = {};
+    for(auto&& fc : query.FunctionCodes)
+        if(fc >= 0 && fc < 128) setBit(functionCodes, fc);
+
+    quint32 deviceIds[8] = {};
+    for(auto&& id : query.DeviceIds)
+        if(id >= 0 && id < 256) setBit(deviceIds, id);
+
+    const bool addressFilter = query.FromAddress >= 0 || query.ToAddress >= 0;
+    const int fromAddress = qMax(0, query.FromAddress);
+    const int toAddress = query.ToAddress < 0 ? 0xFFFF : query.ToAddress;
+
+    auto blockMatches = [&](const IndexEntry& entry)
+    {
+        if(entry.LastTimestamp < from || entry.FirstTimestamp > to)
+            return false;
+        if(!query.FunctionCodes.isEmpty() && !intersects(entry.FunctionCodes, functionCodes, 4))
+            return false;
+        if(!query.DeviceIds.isEmpty() && !intersects(entry.DeviceIds, deviceIds, 8))
+            return false;
+        if(addressFilter && (!entry.hasAddress() || entry.MaxAddress < fromAddress || entry.MinAddress > toAddress))
+            return false;
+        return true;
+    };
+
+    int count = 0;
+    bool stopped = false;
+
+    // passes complete records to the handler, returns the number of bytes consumed
+    auto scan = [&](const QByteArray& bytes)
+    {
+        int pos = 0;
+        while(!stopped && pos + RecordHeaderSize <= bytes.size())
+        {
+            const auto header = reinterpret_cast<const uchar*>(bytes.constData()) + pos;
+            const int size = qFromLittleEndian<quint16>(header + 14);
+            if(size < 1 || pos + RecordHeaderSize + size > bytes.size())
+                break;
+
+            const auto timestamp = qFromLittleEndian<qint64>(header);
+            const auto deviceId = header[12];
+            const auto flags = header[13];
+            const auto functionCode = header[RecordHeaderSize] & ~QModbusPdu::ExceptionByte;
+            const int address = (flags & AddressFlag) ? qFromLittleEndian<quint16>(header + 10) : -1;
+            pos += RecordHeaderSize + size;
+
+            if(timestamp < from || timestamp > to)
+                continue;
+            if(!query.FunctionCodes.isEmpty() && !testBit(functionCodes, functionCode))
+                continue;
+            if(!query.DeviceIds.isEmpty() && !testBit(deviceIds, deviceId))
+                continue;
+            if(addressFilter && (address < fromAddress || address > toAddress))
+                continue;
+
+            TrafficJournalFrame frame;
+            frame.Timestamp = timestamp;
+            frame.Protocol = ModbusMessage::ProtocolType(flags >> ProtocolShift);
+            frame.DeviceId = deviceId;
+            frame.TransactionId = qFromLittleEndian<quint16>(header + 8);
+            frame.Address = address;
+            frame.Request = flags & RequestFlag;
+            frame.Pdu = QByteArray(reinterpret_cast<const char*>(header + RecordHeaderSize), size);
+
+            count++;
+            if(!handler(frame) || (query.Limit > 0 && count >= query.Limit))
+                stopped = true;
+        }
+        return pos;
+    };
+
+    const QDir dir(directory);
+    for(auto&& number : segmentNumbers(directory))
+    {
+        QFile segment(dir.filePath(segmentName(number)));
+        if(!segment.open(QFile::ReadOnly) || !checkHeader(segment.read(SegmentHeaderSize), SegmentMagic))
+            continue;
+
+        // segments are written one after another, so later ones start later too
+        segment.seek(8);
+        if(qFromLittleEndian<qint64>(segment.read(8).constData()) > to)
+            break;
+
+        qint64 tail = SegmentHeaderSize;
+        for(auto&& entry : readIndex(dir.filePath(indexName(number))))
+        {
+            if(qint64(entry.Offset + entry.Size) > segment.size())
+                break;
+
+            tail = qint64(entry.Offset + entry.Size);
+            if(!blockMatches(entry))
+                continue;
+
+            segment.seek(qint64(entry.Offset));
+            scan(segment.read(entry.Size));
+            if(stopped) return count;
+        }
+
+        // frames after the last index entry: the open block or a segment that was not closed
+        segment.seek(tail);
+        QByteArray bytes;
+        while(!stopped && !segment.atEnd())
+        {
+            bytes.append(segment.read(ReadChunkSize));
+            bytes.remove(0, scan(bytes));
+        }
+        if(stopped) return count;
+    }
+
+    return count;
+}
+
+///
+/// \brief ModbusTrafficJournal::segmentName
+/// \param number
+/// \return
+///
+QString ModbusTrafficJournal::segmentName(int number)
+{
+    return QString("%1.omtj").arg(number, 8, 10, QChar('0'));
+}
+
+///
+/// \brief ModbusTrafficJournal::indexName
+/// \param number
+/// \return
+///
+QString ModbusTrafficJournal::indexName(int number)
+{
+    return QString("%1.omti").arg(number, 8, 10, QChar('0'));
+}
+
+///
+/// \brief ModbusTrafficJournal::segmentNumbers
+/// \param directory
+/// \return numbers of the segments in the directory, in ascending order
+///
+QList<int> ModbusTrafficJournal::segmentNumbers(const QString& directory)
+{
+    QList<int> numbers;
+    for(auto&& fi : QDir(directory).entryInfoList(QStringList() << "*.omtj", QDir::Files))
+    {
+        bool ok;
+        const int number = fi.completeBaseName().toInt(&ok);
+        if(ok) numbers.push_back(number);
+    }
+
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+///
+/// \brief ModbusTrafficJournal::readIndex
+/// \param filename
+/// \return complete entries of the index file
+///
+QVector<ModbusTrafficJournal::IndexEntry> ModbusTrafficJournal::readIndex(const QString& filename)
+{
+    QVector<IndexEntry> entries;
+
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly) || !checkHeader(file.read(IndexHeaderSize), IndexMagic))
+        return entries;
+
+    const auto bytes = file.readAll();
+    const auto data = reinterpret_cast<const uchar*>(bytes.constData());
+
+    entries.reserve(bytes.size() / IndexEntrySize);
+    for(int pos = 0; pos + IndexEntrySize <= bytes.size(); pos += IndexEntrySize)
+    {
+        const auto p = data + pos;
+
+        IndexEntry entry;
+        entry.FirstTimestamp = qFromLittleEndian<qint64>(p);
+        entry.LastTimestamp = qFromLittleEndian<qint64>(p + 8);
+        entry.Offset = qFromLittleEndian<quint64>(p + 16);
+        entry.Size = qFromLittleEndian<quint32>(p + 24);
+        entry.Count = qFromLittleEndian<quint32>(p + 28);
+        entry.MinAddress = qFromLittleEndian<quint16>(p + 32);
+        entry.MaxAddress = qFromLittleEndian<quint16>(p + 34);
+        for(int i = 0; i < 4; i++)
+            entry.FunctionCodes[i] = qFromLittleEndian<quint32>(p + 36 + 4 * i);
+        for(int i = 0; i < 8; i++)
+            entry.DeviceIds[i] = qFromLittleEndian<quint32>(p + 52 + 4 * i);
+
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+///
+/// \brief ModbusTrafficJournal::writeIndexEntry
+/// \param out
+/// \param entry
+///
+void ModbusTrafficJournal::writeIndexEntry(QByteArray& out, const IndexEntry& entry)
+{
+    uchar p[IndexEntrySize];
+    qToLittleEndian<qint64>(entry.FirstTimestamp, p);
+    qToLittleEndian<qint64>(entry.LastTimestamp, p + 8);
+    qToLittleEndian<quint64>(entry.Offset, p + 16);
+    qToLittleEndian<quint32>(entry.Size, p + 24);
+    qToLittleEndian<quint32>(entry.Count, p + 28);
+    qToLittleEndian<quint16>(entry.MinAddress, p + 32);
+    qToLittleEndian<quint16>(entry.MaxAddress, p + 34);
+    for(int i = 0; i < 4; i++)
+        qToLittleEndian<quint32>(entry.FunctionCodes[i], p + 36 + 4 * i);
+    for(int i = 0; i < 8; i++)
+        qToLittleEndian<quint32>(entry.DeviceIds[i], p + 52 + 4 * i);
+
+    out.append(reinterpret_cast<const char*>(p), IndexEntrySize);
+}
+
+///
+/// \brief ModbusTrafficJournal::startSegment - the file headers are written by the writer thread with the first frames
+///
+void ModbusTrafficJournal::startSegment()
+{
+    _segmentNumber++;
+
+    const qint64 timestamp = _startTime + _clock.nsecsElapsed();
+    _buffer.append(fileHeader(SegmentMagic, timestamp));
+    _indexBuffer.append(fileHeader(IndexMagic, timestamp));
+    _segmentSize = 0;
+    _block = IndexEntry();
+}
+
+///
+/// \brief ModbusTrafficJournal::openFiles - called on the writer thread, or before it is started
+/// \param number - segment number
+/// \param errorString
+/// \return
+///
+bool ModbusTrafficJournal::openFiles(int number, QString* errorString)
+{
+    const QDir dir(_params.Directory);
+    _fileNumber = number;
+
+    _segment.setFileName(dir.filePath(segmentName(number)));
+    _index.setFileName(dir.filePath(indexName(number)));
+    if(!_segment.open(QFile::WriteOnly | QFile::Truncate) || !_index.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        if(errorString) *errorString = _segment.isOpen() ? _index.errorString() : _segment.errorString();
+        _segment.close();
+        return false;
+    }
+
+    return true;
+}
+
+///
+/// \brief ModbusTrafficJournal::closeFiles
+///
+void ModbusTrafficJournal::closeFiles()
+{
+    _segment.close();
+    _index.close();
+}
+
+///
+/// \brief ModbusTrafficJournal::finishBlock - adds the index entry of the current block
+///
+void ModbusTrafficJournal::finishBlock()
+{
+    if(_block.Count == 0)
+        return;
+
+    writeIndexEntry(_indexBuffer, _block);
+    _block = IndexEntry();
+}
@@ -0,0 +1,188 @@
+#ifndef MODBUSTRAFFICJOURNAL_H
+#define MODBUSTRAFFICJOURNAL_H
+
+#include <functional>
+#include <QHash>
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QWaitCondition>
+#include "modbusmessage.h"
+
+///
+/// \brief The TrafficJournalParams struct
+///
+struct TrafficJournalParams
+{
+    QString Directory;
+    qint64 MaxSegmentSize = 64 * 1024 * 1024;   // bytes, a new segment is started when exceeded
+};
+
+///
+/// \brief The TrafficJournalFrame struct - one frame read back from the journal
+///
+struct TrafficJournalFrame
+{
+    qint64 Timestamp = 0;   // nanoseconds since epoch
+    ModbusMessage::ProtocolType Protocol = ModbusMessage::Tcp;
+    quint8 DeviceId = 0;
+    quint16 TransactionId = 0;
+    int Address = -1;       // start address of the request, -1 if the function has none
+    bool Request = false;
+    QByteArray Pdu;         // function code and data
+
+    QDateTime dateTime() const {
+        return QDateTime::fromMSecsSinceEpoch(Timestamp / 1000000);
+    }
+};
+
+///
+/// \brief The TrafficJournalQuery struct - empty lists and negative addresses match any frame
+///
+struct TrafficJournalQuery
+{
+    QDateTime From;
+    QDateTime To;
+    QVector<int> FunctionCodes;
+    QVector<int> DeviceIds;
+    int FromAddress = -1;
+    int ToAddress = -1;
+    int Limit = 0;          // 0 - no limit
+};
+
+///
+/// \brief The ModbusTrafficJournal class - append-only traffic history on disk
+///
+/// Frames go to numbered segment files (00000001.omtj ...) in the journal directory. Every
+/// IndexInterval frames a sparse index entry is appended to the segment index (.omti) with the
+/// time span of the block, bitmaps of its function codes and unit IDs and the range of its start
+/// addresses. Queries read only the blocks whose entry can match, plus the unindexed tail of a
+/// segment. Responses are indexed with the start address of their request on the same connection.
+/// Records are built in memory and written by a background thread, so appending does not wait
+/// for the disk unless more than MaxQueuedBytes are waiting to be written.
+///
+class ModbusTrafficJournal
+{
+public:
+    explicit ModbusTrafficJournal();
+    ~ModbusTrafficJournal();
+
+    ModbusTrafficJournal(const ModbusTrafficJournal&) = delete;
+    ModbusTrafficJournal& operator=(const ModbusTrafficJournal&) = delete;
+
+    static constexpr int IndexInterval = 256;
+    static constexpr int MaxQueuedBytes = 64 * 1024 * 1024;
+
+    bool open(const TrafficJournalParams& params, QString* errorString = nullptr);
+    void close();
+
+    bool isOpen() const;
+    TrafficJournalParams params() const;
+
+    void append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request, quint64 connectionId);
+    void flush();
+
+    typedef std::function<bool(const TrafficJournalFrame& frame)> Handler; // returns false to stop
+    static int query(const QString& directory, const TrafficJournalQuery& query, Handler handler, QString* errorString = nullptr);
+
+private:
+    ///
+    /// \brief The IndexEntry struct - summary of one block of frames
+    ///
+    struct IndexEntry
+    {
+        qint64 FirstTimestamp = 0;
+        qint64 LastTimestamp = 0;
+        quint64 Offset = 0;
+        quint32 Size = 0;
+        quint32 Count = 0;
+        quint16 MinAddress = 0xFFFF;
+        quint16 MaxAddress = 0;
+        quint32 FunctionCodes[4] = {};
+        quint32 DeviceIds[8] = {};
+
+        bool hasAddress() const { return MinAddress <= MaxAddress; }
+    };
+
+    static constexpr int SegmentHeaderSize = 16;
+    static constexpr int IndexHeaderSize = 16;
+    static constexpr int IndexEntrySize = 84;
+    static constexpr int RecordHeaderSize = 16;
+
+    ///
+    /// \brief The WriteJob struct - bytes of one segment and its index, written by the writer thread
+    ///
+    struct WriteJob
+    {
+        int Segment = 0;
+        QByteArray Data;
+        QByteArray Index;
+    };
+
+    ///
+    /// \brief The PendingAddress struct - start address of a request waiting for its response
+    ///
+    struct PendingAddress
+    {
+        quint16 Address;
+        quint64 Stamp;      // request count when the request was journaled
+    };
+
+    // connection, unit and transaction of a request
+    typedef QPair<quint64, quint32> RequestKey;
+
+    static QString segmentName(int number);
+    static QString indexName(int number);
+    static QList<int> segmentNumbers(const QString& directory);
+    static QVector<IndexEntry> readIndex(const QString& filename);
+    static void writeIndexEntry(QByteArray& out, const IndexEntry& entry);
+
+    void startSegment();
+    void finishBlock();
+    void queueWrite();
+    void expirePendingAddresses();
+
+    void run();
+    bool openFiles(int number, QString* errorString = nullptr);
+    void closeFiles();
+
+private:
+    static constexpr int MaxPendingAddresses = 4096;
+    static constexpr quint64 MaxPendingAge = 65536; // requests, responses that never came are forgotten
+
+    TrafficJournalParams _params;
+    bool _open = false;
+    int _segmentNumber = 0;
+    qint64 _segmentSize = 0;    // including the bytes queued for the writer
+    QByteArray _buffer;
+    QByteArray _indexBuffer;
+    IndexEntry _block;
+
+    QElapsedTimer _clock;
+    QElapsedTimer _flushTimer;
+    qint64 _startTime = 0;  // nanoseconds since epoch
+
+    // start addresses of requests waiting for their responses, oldest first in _pendingOrder
+    QHash<RequestKey, PendingAddress> _pendingAddresses;
+    QQueue<QPair<RequestKey, quint64>> _pendingOrder;
+    quint64 _requestCounter = 0;
+
+    // the writer thread owns the files while it runs, _mutex guards the jobs
+    QScopedPointer<QThread> _thread;
+    QMutex _mutex;
+    QWaitCondition _wakeUp;
+    QWaitCondition _written;
+    QQueue<WriteJob> _jobs;
+    qint64 _queuedBytes = 0;
+    bool _writing = false;
+    bool _quit = false;
+
+    QFile _segment;
+    QFile _index;
+    int _fileNumber = 0;
+};
+
+#endif // MODBUSTRAFFICJOURNAL_H
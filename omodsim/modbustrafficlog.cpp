@@ -0,0 +1,208 @@
+#include "modbustrafficlog.h"
+
+///
+/// \brief ModbusTrafficLog::ModbusTrafficLog
+/// \param capacity - number of frames kept while no view is registered
+/// \param parent
+///
+ModbusTrafficLog::ModbusTrafficLog(int capacity, QObject* parent)
+    : QObject(parent)
+    ,_buffer(capacity)
+    ,_defaultCapacity(_buffer.capacity())
+{
+}
+
+///
+/// \brief ModbusTrafficLog::capacity
+/// \return
+///
+int ModbusTrafficLog::capacity() const
+{
+    return _buffer.capacity();
+}
+
+///
+/// \brief ModbusTrafficLog::setViewLimit
+/// \param view - removed from the log when it is destroyed
+/// \param rows - number of frames the view shows
+///
+void ModbusTrafficLog::setViewLimit(const QObject* view, int rows)
+{
+    if(!_views.contains(view))
+    {
+        connect(view, &QObject::destroyed, this, [this, view] { removeView(view); });
+        _views[view].Retained = endSequence();
+    }
+
+    _views[view].Rows = rows;
+    updateCapacity();
+}
+
+///
+/// \brief ModbusTrafficLog::setViewRetention
+/// \param view
+/// \param sequence - oldest frame the view shows, the end sequence if it shows none
+///
+void ModbusTrafficLog::setViewRetention(const QObject* view, quint64 sequence)
+{
+    const auto it = _views.find(view);
+    if(it != _views.end())
+        it->Retained = sequence;
+}
+
+///
+/// \brief ModbusTrafficLog::removeView
+/// \param view
+///
+void ModbusTrafficLog::removeView(const QObject* view)
+{
+    if(!_views.remove(view))
+        return;
+
+    disconnect(view, &QObject::destroyed, this, nullptr);
+    updateCapacity();
+}
+
+///
+/// \brief ModbusTrafficLog::baseCapacity
+/// \return sum of the views' row limits, the recent traffic a new view starts with
+///
+int ModbusTrafficLog::baseCapacity() const
+{
+    if(_views.isEmpty())
+        return _defaultCapacity;
+
+    qint64 capacity = 0;
+    for(auto&& v : _views)
+        capacity += v.Rows;
+
+    return int(qBound<qint64>(1, capacity, MaxRetainedCapacity));
+}
+
+///
+/// \brief ModbusTrafficLog::retainedSequence
+/// \return oldest frame any view still shows
+///
+quint64 ModbusTrafficLog::retainedSequence() const
+{
+    auto sequence = endSequence();
+    for(auto&& v : _views)
+        sequence = qMin(sequence, v.Retained);
+
+    return sequence;
+}
+
+///
+/// \brief ModbusTrafficLog::makeRoom
+/// \param frameSize - bytes of the frame about to be appended
+///
+void ModbusTrafficLog::makeRoom(int frameSize)
+{
+    // a quiet unit's rows are not pushed out by the traffic of busy units, the log grows instead
+    const auto retained = retainedSequence();
+    while(_buffer.capacity() < MaxRetainedCapacity)
+    {
+        const auto count = _buffer.overflow(frameSize);
+        if(count == 0 || _firstSequence + count <= retained)
+            return;
+
+        resize(qMin(_buffer.capacity() * 2, MaxRetainedCapacity));
+    }
+}
+
+///
+/// \brief ModbusTrafficLog::retainedCount
+/// \return number of frames from the oldest one a view shows to the newest one
+///
+int ModbusTrafficLog::retainedCount() const
+{
+    return int(endSequence() - qMax(_firstSequence, retainedSequence()));
+}
+
+///
+/// \brief ModbusTrafficLog::updateCapacity - fits the log to the views' row limits and the frames they show
+///
+void ModbusTrafficLog::updateCapacity()
+{
+    resize(qMin(qMax(baseCapacity(), retainedCount()), MaxRetainedCapacity));
+}
+
+///
+/// \brief ModbusTrafficLog::releaseCapacity - shrinks a grown log once most of it is no longer shown
+///
+void ModbusTrafficLog::releaseCapacity()
+{
+    const auto retained = retainedCount();
+    if(_buffer.capacity() > baseCapacity() && retained * 4 <= _buffer.capacity())
+        resize(qMax(baseCapacity(), retained * 2));
+}
+
+///
+/// \brief ModbusTrafficLog::resize
+/// \param capacity - number of frames, the newest frames stay
+///
+void ModbusTrafficLog::resize(int capacity)
+{
+    if(capacity == _buffer.capacity())
+        return;
+
+    const auto size = _buffer.size();
+    _buffer.resize(capacity);
+    _firstSequence += size - _buffer.size();
+
+    emit capacityChanged(_buffer.capacity());
+}
+
+///
+/// \brief ModbusTrafficLog::createMessage
+/// \param sequence
+/// \return decoded frame, owned by the caller
+///
+const ModbusMessage* ModbusTrafficLog::createMessage(quint64 sequence) const
+{
+    if(!contains(sequence))
+        return nullptr;
+
+    return _buffer.createMessage(int(sequence - _firstSequence));
+}
+
+///
+/// \brief ModbusTrafficLog::append
+/// \param pdu
+/// \param protocol
+/// \param deviceId
+/// \param transactionId
+/// \param request
+///
+void ModbusTrafficLog::append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request)
+{
+    makeRoom(1 + pdu.dataSize());
+
+    const auto size = _buffer.size();
+    _buffer.append(pdu, protocol, deviceId, transactionId, request);
+    _firstSequence += size + 1 - _buffer.size();
+
+    emit appended(endSequence() - 1);
+    releaseCapacity();
+}
+
+///
+/// \brief ModbusTrafficLog::append
+/// \param pdu
+/// \param protocol
+/// \param deviceId
+/// \param transactionId
+/// \param request
+/// \param timestamp - wall clock time of a frame that was logged earlier
+///
+void ModbusTrafficLog::append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request, const QDateTime& timestamp)
+{
+    makeRoom(1 + pdu.dataSize());
+
+    const auto size = _buffer.size();
+    _buffer.append(pdu, protocol, deviceId, transactionId, request, timestamp);
+    _firstSequence += size + 1 - _buffer.size();
+
+    emit appended(endSequence() - 1);
+    releaseCapacity();
+}
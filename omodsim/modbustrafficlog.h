@@ -0,0 +1,77 @@
+#ifndef MODBUSTRAFFICLOG_H
+#define MODBUSTRAFFICLOG_H
+
+#include <QHash>
+#include <QObject>
+#include "modbuslogbuffer.h"
+
+///
+/// \brief The ModbusTrafficLog class - traffic of all connections, shared by every traffic view
+///
+/// Frames are stored once and addressed by sequence numbers that keep growing as old
+/// frames are dropped, so views only remember the sequence numbers of the frames they show.
+/// The log holds at least as many frames as the row limits of all views together, and keeps
+/// a frame for as long as any view still shows it, up to MaxRetainedCapacity frames.
+///
+class ModbusTrafficLog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ModbusTrafficLog(int capacity = DefaultCapacity, QObject* parent = nullptr);
+
+    static constexpr int DefaultCapacity = 10000;
+    static constexpr int MaxRetainedCapacity = 1000000;
+
+    int capacity() const;
+
+    void setViewLimit(const QObject* view, int rows);
+    void setViewRetention(const QObject* view, quint64 sequence);
+    void removeView(const QObject* view);
+
+    quint64 firstSequence() const { return _firstSequence; }
+    quint64 endSequence() const { return _firstSequence + _buffer.size(); }
+
+    bool contains(quint64 sequence) const {
+        return sequence >= firstSequence() && sequence < endSequence();
+    }
+
+    const ModbusLogRecord& record(quint64 sequence) const {
+        return _buffer.at(int(sequence - _firstSequence));
+    }
+
+    const ModbusMessage* createMessage(quint64 sequence) const;
+
+    void append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request);
+    void append(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, bool request, const QDateTime& timestamp);
+
+signals:
+    void appended(quint64 sequence);
+    void capacityChanged(int capacity);
+
+private:
+    ///
+    /// \brief The ViewState struct
+    ///
+    struct ViewState
+    {
+        int Rows = 0;
+        quint64 Retained = 0;   // oldest frame the view shows, frames before it may be dropped
+    };
+
+    int baseCapacity() const;
+    quint64 retainedSequence() const;
+    int retainedCount() const;
+
+    void makeRoom(int frameSize);
+    void updateCapacity();
+    void releaseCapacity();
+    void resize(int capacity);
+
+private:
+    ModbusLogBuffer _buffer;
+    quint64 _firstSequence = 0;
+    int _defaultCapacity;
+    QHash<const QObject*, ViewState> _views;
+};
+
+#endif // MODBUSTRAFFICLOG_H
@@ -57,14 +57,17 @@ SOURCES += \
     dialogs/dialogforcemultipleregisters.cpp \
     dialogs/dialogmsgparser.cpp \
     dialogs/dialogprintsettings.cpp \
+    dialogs/dialograngesimulation.cpp \
     dialogs/dialogscriptsettings.cpp \
     dialogs/dialogselectserviceport.cpp \
     dialogs/dialogsetuppresetdata.cpp \
     dialogs/dialogsetupserialport.cpp \
+    dialogs/dialogtraffichistory.cpp \
     dialogs/dialogwindowsmanager.cpp \
     dialogs/dialogwritecoilregister.cpp \
     dialogs/dialogwriteholdingregister.cpp \
     dialogs/dialogwriteholdingregisterbits.cpp \
+    headlessserver.cpp \
     htmldelegate.cpp \
     jscompleter.cpp \
     jsobjects/console.cpp \
@@ -76,14 +79,25 @@ SOURCES += \
     main.cpp \
     mainwindow.cpp \
     menuconnect.cpp \
+    modbusdatacoalescer.cpp \
+    modbusdatadispatcher.cpp \
     modbusdataunitmap.cpp \
+    modbusepollserver.cpp \
+    modbuslogbuffer.cpp \
     modbusmessages/modbusmessage.cpp \
     modbusmultiserver.cpp \
+    modbuspcapwriter.cpp \
+    modbusstatistics.cpp \
+    modbustrafficfilter.cpp \
+    modbustrafficjournal.cpp \
+    modbustrafficlog.cpp \
     qfixedsizedialog.cpp \
     qhexvalidator.cpp \
     qint64validator.cpp \
     quintvalidator.cpp \
     recentfileactionlist.cpp \
+    replayfile.cpp \
+    simulationclock.cpp \
     windowactionlist.cpp
 
 HEADERS += \
@@ -121,15 +135,19 @@ HEADERS += \
     dialogs/dialogforcemultipleregisters.h \
     dialogs/dialogmsgparser.h \
     dialogs/dialogprintsettings.h \
+    dialogs/dialograngesimulation.h \
     dialogs/dialogscriptsettings.h \
     dialogs/dialogselectserviceport.h \
     dialogs/dialogsetuppresetdata.h \
     dialogs/dialogsetupserialport.h \
+    dialogs/dialogtraffichistory.h \
     dialogs/dialogwindowsmanager.h \
     dialogs/dialogwritecoilregister.h \
     dialogs/dialogwriteholdingregister.h \
     dialogs/dialogwriteholdingregisterbits.h \
+    fastrandomgenerator.h \
     formatutils.h \
+    headlessserver.h \
     htmldelegate.h \
     jscompleter.h \
     jsobjects/console.h \
@@ -138,11 +156,16 @@ HEADERS += \
     displaydefinition.h \
     enums.h \
     formmodsim.h \
+    formmodsimdata.h \
     jshighlighter.h \
     jsobjects/storage.h \
     mainwindow.h \
     menuconnect.h \
+    modbusdatacoalescer.h \
+    modbusdatadispatcher.h \
     modbusdataunitmap.h \
+    modbusepollserver.h \
+    modbuslogbuffer.h \
     modbuslimits.h \
     modbusmessages/diagnostics.h \
     modbusmessages/getcommeventcounter.h \
@@ -165,6 +188,11 @@ HEADERS += \
     modbusmessages/writesinglecoil.h \
     modbusmessages/writesingleregister.h \
     modbusmultiserver.h \
+    modbuspcapwriter.h \
+    modbusstatistics.h \
+    modbustrafficfilter.h \
+    modbustrafficjournal.h \
+    modbustrafficlog.h \
     modbussimulationparams.h \
     modbuswriteparams.h \
     numericutils.h \
@@ -177,8 +205,13 @@ HEADERS += \
     qrange.h \
     quintvalidator.h \
     recentfileactionlist.h \
+    replayfile.h \
     scriptsettings.h \
     serialportutils.h \
+    simulationclock.h \
+    simulationvalue.h \
+    trafficutils.h \
+    waveformutils.h \
     windowactionlist.h
 
 FORMS += \
@@ -192,10 +225,12 @@ FORMS += \
     dialogs/dialogforcemultipleregisters.ui \
     dialogs/dialogmsgparser.ui \
     dialogs/dialogprintsettings.ui \
+    dialogs/dialograngesimulation.ui \
     dialogs/dialogscriptsettings.ui \
     dialogs/dialogselectserviceport.ui \
     dialogs/dialogsetuppresetdata.ui \
     dialogs/dialogsetupserialport.ui \
+    dialogs/dialogtraffichistory.ui \
     dialogs/dialogwindowsmanager.ui \
     dialogs/dialogwritecoilregister.ui \
     dialogs/dialogwriteholdingregister.ui \
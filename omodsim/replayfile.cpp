@@ -0,0 +1,552 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <QtEndian>
+#include <QDateTime>
+#include <QFileInfo>
+#include "replayfile.h"
+
+///
+/// \brief parseRegisterType
+/// \param name
+/// \return register type or QModbusDataUnit::Invalid
+///
+static QModbusDataUnit::RegisterType parseRegisterType(const QByteArray& name)
+{
+    const auto s = name.trimmed().toLower();
+    if(s == "c" || s == "coils")
+        return QModbusDataUnit::Coils;
+    if(s == "di" || s == "discreteinputs")
+        return QModbusDataUnit::DiscreteInputs;
+    if(s == "ir" || s == "inputregisters")
+        return QModbusDataUnit::InputRegisters;
+    if(s == "hr" || s == "holdingregisters")
+        return QModbusDataUnit::HoldingRegisters;
+
+    return QModbusDataUnit::Invalid;
+}
+
+///
+/// \brief parseDisplayMode
+/// \param name
+/// \param mode
+/// \return false if the name is not a display mode
+///
+static bool parseDisplayMode(const QByteArray& name, DataDisplayMode& mode)
+{
+    static const QPair<const char*, DataDisplayMode> modes[] = {
+        { "binary", DataDisplayMode::Binary },
+        { "decimal", DataDisplayMode::Decimal },
+        { "integer", DataDisplayMode::Integer },
+        { "hex", DataDisplayMode::Hex },
+        { "floatingpt", DataDisplayMode::FloatingPt },
+        { "swappedfp", DataDisplayMode::SwappedFP },
+        { "dblfloat", DataDisplayMode::DblFloat },
+        { "swappeddbl", DataDisplayMode::SwappedDbl },
+        { "int32", DataDisplayMode::Int32 },
+        { "swappedint32", DataDisplayMode::SwappedInt32 },
+        { "uint32", DataDisplayMode::UInt32 },
+        { "swappeduint32", DataDisplayMode::SwappedUInt32 },
+        { "int64", DataDisplayMode::Int64 },
+        { "swappedint64", DataDisplayMode::SwappedInt64 },
+        { "uint64", DataDisplayMode::UInt64 },
+        { "swappeduint64", DataDisplayMode::SwappedUInt64 }
+    };
+
+    const auto s = name.trimmed().toLower();
+    for(auto&& m : modes)
+    {
+        if(s == m.first)
+        {
+            mode = m.second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+///
+/// \brief parseColumn
+/// \param spec - [device/]table:address[:mode]
+/// \param column
+/// \return false if the column can not be parsed
+///
+static bool parseColumn(const QByteArray& spec, ReplayColumn& column)
+{
+    auto s = spec.trimmed();
+
+    const auto slash = s.indexOf('/');
+    if(slash >= 0)
+    {
+        bool ok;
+        const auto deviceId = s.left(slash).toUInt(&ok);
+        if(!ok || deviceId > 255)
+            return false;
+
+        column.DeviceId = quint8(deviceId);
+        s = s.mid(slash + 1);
+    }
+
+    const auto parts = s.split(':');
+    if(parts.size() < 2 || parts.size() > 3)
+        return false;
+
+    column.Type = parseRegisterType(parts[0]);
+    if(column.Type == QModbusDataUnit::Invalid)
+        return false;
+
+    bool ok;
+    column.Address = parts[1].trimmed().toUShort(&ok, 0);
+    if(!ok)
+        return false;
+
+    if(parts.size() == 3)
+        return parseDisplayMode(parts[2], column.Mode);
+
+    return true;
+}
+
+///
+/// \brief parseTime
+/// \param text - milliseconds or a number with ms, s, m or h suffix
+/// \param msecs
+/// \return false if the text is not a time
+///
+static bool parseTime(const QByteArray& text, qint64& msecs)
+{
+    static const QPair<const char*, double> units[] = {
+        { "ms", 1. },
+        { "s", 1000. },
+        { "m", 60000. },
+        { "h", 3600000. }
+    };
+
+    auto number = text;
+    double scale = 1.;
+    for(auto&& u : units)
+    {
+        if(number.endsWith(u.first))
+        {
+            number.chop(qstrlen(u.first));
+            scale = u.second;
+            break;
+        }
+    }
+
+    bool ok;
+    const auto value = number.toDouble(&ok) * scale;
+    if(!ok || value < 0)
+        return false;
+
+    msecs = qint64(std::llround(value));
+    return true;
+}
+
+///
+/// \brief ReplayFile::open
+/// \param fileName
+/// \param errorString
+/// \return replay file or nullptr if the file can not be read
+///
+ReplayFile* ReplayFile::open(const QString& fileName, QString* errorString)
+{
+    const auto suffix = QFileInfo(fileName).suffix();
+    if(suffix.compare("csv", Qt::CaseInsensitive) == 0)
+    {
+        auto file = new CsvReplayFile;
+        if(file->open(fileName, errorString))
+            return file;
+
+        delete file;
+    }
+    else if(suffix.compare("scn", Qt::CaseInsensitive) == 0)
+    {
+        auto file = new ScenarioFile;
+        if(file->open(fileName, errorString))
+            return file;
+
+        delete file;
+    }
+    else
+    {
+        auto file = new BinaryReplayFile;
+        if(file->open(fileName, errorString))
+            return file;
+
+        delete file;
+    }
+
+    return nullptr;
+}
+
+///
+/// \brief CsvReplayFile::open
+/// \param fileName
+/// \param errorString
+/// \return
+///
+bool CsvReplayFile::open(const QString& fileName, QString* errorString)
+{
+    _file.setFileName(fileName);
+    if(!_file.open(QFile::ReadOnly))
+    {
+        if(errorString) *errorString = _file.errorString();
+        return false;
+    }
+
+    const auto header = _file.readLine().trimmed();
+    _separator = (header.count(';') > header.count(',')) ? ';' : ',';
+
+    const auto names = header.split(_separator);
+    for(int i = 1; i < names.size(); i++)
+    {
+        ReplayColumn column;
+        if(!parseColumn(names[i], column))
+        {
+            if(errorString) *errorString = QString("Invalid column '%1'").arg(QString::fromUtf8(names[i]));
+            return false;
+        }
+        _columns.push_back(column);
+    }
+
+    if(_columns.isEmpty())
+    {
+        if(errorString) *errorString = QString("No columns to replay");
+        return false;
+    }
+
+    _dataOffset = _file.pos();
+    return true;
+}
+
+///
+/// \brief CsvReplayFile::readFrame
+/// \param frame
+/// \return false at the end of file
+///
+bool CsvReplayFile::readFrame(ReplayFrame& frame)
+{
+    while(!_file.atEnd())
+    {
+        const auto line = _file.readLine().trimmed();
+        if(line.isEmpty())
+            continue;
+
+        const auto cells = line.split(_separator);
+
+        bool ok;
+        const auto time = cells[0].toDouble(&ok);
+        if(ok)
+        {
+            frame.Timestamp = qint64(std::llround(time));
+        }
+        else
+        {
+            const auto dt = QDateTime::fromString(QString::fromLatin1(cells[0].trimmed()), Qt::ISODateWithMs);
+            if(!dt.isValid())
+                continue;
+
+            frame.Timestamp = dt.toMSecsSinceEpoch();
+        }
+
+        frame.Values.fill(std::numeric_limits<double>::quiet_NaN(), _columns.size());
+        for(int i = 1; i < cells.size() && i <= _columns.size(); i++)
+        {
+            const auto value = cells[i].toDouble(&ok);
+            if(ok) frame.Values[i - 1] = value;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+///
+/// \brief CsvReplayFile::rewind
+///
+void CsvReplayFile::rewind()
+{
+    _file.seek(_dataOffset);
+}
+
+///
+/// \brief BinaryReplayFile::~BinaryReplayFile
+///
+BinaryReplayFile::~BinaryReplayFile()
+{
+    if(_window)
+        _file.unmap(_window);
+}
+
+///
+/// \brief BinaryReplayFile::open
+/// \param fileName
+/// \param errorString
+/// \return
+///
+bool BinaryReplayFile::open(const QString& fileName, QString* errorString)
+{
+    _file.setFileName(fileName);
+    if(!_file.open(QFile::ReadOnly))
+    {
+        if(errorString) *errorString = _file.errorString();
+        return false;
+    }
+
+    uchar header[8];
+    if(_file.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header) ||
+       qFromLittleEndian<quint32>(header) != Magic ||
+       qFromLittleEndian<quint16>(header + 4) != Version)
+    {
+        if(errorString) *errorString = QString("Not a replay file");
+        return false;
+    }
+
+    const int count = qFromLittleEndian<quint16>(header + 6);
+    const auto columns = _file.read(8 * count);
+    if(count == 0 || columns.size() != 8 * count)
+    {
+        if(errorString) *errorString = QString("No columns to replay");
+        return false;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        const auto data = reinterpret_cast<const uchar*>(columns.constData()) + 8 * i;
+
+        ReplayColumn column;
+        column.DeviceId = data[0];
+        column.Type = QModbusDataUnit::RegisterType(data[1]);
+        column.Address = qFromLittleEndian<quint16>(data + 2);
+        column.Mode = DataDisplayMode(data[4]);
+
+        if(column.Type < QModbusDataUnit::DiscreteInputs || column.Type > QModbusDataUnit::HoldingRegisters ||
+           column.Mode > DataDisplayMode::SwappedUInt64)
+        {
+            if(errorString) *errorString = QString("Invalid column %1").arg(i + 1);
+            return false;
+        }
+
+        _columns.push_back(column);
+    }
+
+    _dataOffset = _file.pos();
+    _recordSize = sizeof(qint64) + sizeof(double) * count;
+    _pos = _dataOffset;
+
+    return true;
+}
+
+///
+/// \brief BinaryReplayFile::mapWindow
+/// \param pos
+/// \return false if the record at the position can not be mapped
+///
+bool BinaryReplayFile::mapWindow(qint64 pos)
+{
+    // a few thousand records at a time keep the address space small for any file size
+    const qint64 windowSize = qMax<qint64>(_recordSize, (64 << 20) / _recordSize * _recordSize);
+
+    if(_window)
+    {
+        _file.unmap(_window);
+        _window = nullptr;
+    }
+
+    _windowPos = pos;
+    _windowSize = qMin(windowSize, _file.size() - pos);
+    if(_windowSize < _recordSize)
+        return false;
+
+    _window = _file.map(_windowPos, _windowSize);
+    return _window != nullptr;
+}
+
+///
+/// \brief BinaryReplayFile::readFrame
+/// \param frame
+/// \return false at the end of file
+///
+bool BinaryReplayFile::readFrame(ReplayFrame& frame)
+{
+    if(!_window || _pos < _windowPos || _pos + _recordSize > _windowPos + _windowSize)
+    {
+        if(!mapWindow(_pos))
+            return false;
+    }
+
+    const auto data = _window + (_pos - _windowPos);
+    frame.Timestamp = qFromLittleEndian<qint64>(data);
+
+    frame.Values.resize(_columns.size());
+    for(int i = 0; i < _columns.size(); i++)
+    {
+        const auto bits = qFromLittleEndian<quint64>(data + sizeof(qint64) + sizeof(double) * i);
+        std::memcpy(&frame.Values[i], &bits, sizeof(double));
+    }
+
+    _pos += _recordSize;
+    return true;
+}
+
+///
+/// \brief BinaryReplayFile::rewind
+///
+void BinaryReplayFile::rewind()
+{
+    _pos = _dataOffset;
+}
+
+///
+/// \brief ScenarioFile::open
+/// \param fileName
+/// \param errorString
+/// \return
+///
+bool ScenarioFile::open(const QString& fileName, QString* errorString)
+{
+    QFile file(fileName);
+    if(!file.open(QFile::ReadOnly))
+    {
+        if(errorString) *errorString = file.errorString();
+        return false;
+    }
+
+    // the scenario time starts at zero, whenever its first event is
+    _timeline.push_back({ 0, -1, 0. });
+
+    qint64 time = 0;
+    for(int lineNumber = 1; !file.atEnd(); lineNumber++)
+    {
+        auto line = file.readLine();
+        const auto comment = line.indexOf('#');
+        if(comment >= 0) line.truncate(comment);
+
+        line = line.simplified();
+        if(line.isEmpty())
+            continue;
+
+        const auto error = [&](const QString& text) {
+            if(errorString) *errorString = QString("Line %1: %2").arg(lineNumber).arg(text);
+            return false;
+        };
+
+        const auto tokens = line.split(' ');
+        if(tokens.size() < 4)
+            return error("Event expected");
+
+        qint64 eventTime;
+        const bool relative = tokens[0].startsWith('+');
+        if(!parseTime(relative ? tokens[0].mid(1) : tokens[0], eventTime))
+            return error(QString("Invalid time '%1'").arg(QString::fromUtf8(tokens[0])));
+
+        time = relative ? time + eventTime : eventTime;
+
+        ReplayColumn column;
+        if(!parseColumn(tokens[2], column))
+            return error(QString("Invalid register '%1'").arg(QString::fromUtf8(tokens[2])));
+
+        const auto action = tokens[1].toLower();
+        if(action == "set" && tokens.size() == 4)
+        {
+            bool ok;
+            const auto value = tokens[3].toDouble(&ok);
+            if(!ok)
+                return error(QString("Invalid value '%1'").arg(QString::fromUtf8(tokens[3])));
+
+            if(_timeline.size() >= MaxEvents)
+                return error(QString("Scenario exceeds %1 events").arg(MaxEvents));
+
+            _timeline.push_back({ time, columnIndex(column), value });
+        }
+        else if(action == "ramp" && (tokens.size() == 6 || tokens.size() == 7))
+        {
+            bool ok1, ok2;
+            const auto from = tokens[3].toDouble(&ok1);
+            const auto to = tokens[4].toDouble(&ok2);
+            if(!ok1 || !ok2)
+                return error("Invalid ramp limits");
+
+            qint64 duration, step = 100;
+            if(!parseTime(tokens[5], duration) || (tokens.size() == 7 && (!parseTime(tokens[6], step) || step == 0)))
+                return error("Invalid ramp duration");
+
+            if(duration / step >= MaxEvents - _timeline.size())
+                return error(QString("Ramp exceeds %1 events, use a longer step").arg(MaxEvents));
+
+            const auto idx = columnIndex(column);
+            for(qint64 t = 0; t < duration; t += step)
+                _timeline.push_back({ time + t, idx, from + (to - from) * t / duration });
+
+            _timeline.push_back({ time + duration, idx, to });
+        }
+        else
+        {
+            return error(QString("Invalid event '%1'").arg(QString::fromUtf8(tokens[1])));
+        }
+    }
+
+    if(_columns.isEmpty())
+    {
+        if(errorString) *errorString = QString("No events to run");
+        return false;
+    }
+
+    // later lines win where events of one register fall on the same time
+    std::stable_sort(_timeline.begin(), _timeline.end(), [](const ScenarioEvent& a, const ScenarioEvent& b) {
+        return a.Time < b.Time;
+    });
+
+    return true;
+}
+
+///
+/// \brief ScenarioFile::columnIndex
+/// \param column
+/// \return index of the column, added if the register is new
+///
+int ScenarioFile::columnIndex(const ReplayColumn& column)
+{
+    for(int i = 0; i < _columns.size(); i++)
+    {
+        const auto& c = _columns[i];
+        if(c.DeviceId == column.DeviceId && c.Type == column.Type && c.Address == column.Address && c.Mode == column.Mode)
+            return i;
+    }
+
+    _columns.push_back(column);
+    return _columns.size() - 1;
+}
+
+///
+/// \brief ScenarioFile::readFrame
+/// \param frame
+/// \return false at the end of the timeline
+///
+bool ScenarioFile::readFrame(ReplayFrame& frame)
+{
+    if(_pos >= _timeline.size())
+        return false;
+
+    frame.Timestamp = _timeline[_pos].Time;
+    frame.Values.fill(std::numeric_limits<double>::quiet_NaN(), _columns.size());
+
+    for(; _pos < _timeline.size() && _timeline[_pos].Time == frame.Timestamp; _pos++)
+    {
+        const auto& e = _timeline[_pos];
+        if(e.Column >= 0) frame.Values[e.Column] = e.Value;
+    }
+
+    return true;
+}
+
+///
+/// \brief ScenarioFile::rewind
+///
+void ScenarioFile::rewind()
+{
+    _pos = 0;
+}
@@ -0,0 +1,190 @@
+#ifndef REPLAYFILE_H
+#define REPLAYFILE_H
+
+#include <QFile>
+#include <QVector>
+#include <QDataStream>
+#include <QModbusDataUnit>
+#include "enums.h"
+
+///
+/// \brief The ReplayColumn struct - register a recorded column is replayed into
+///
+struct ReplayColumn
+{
+    quint8 DeviceId = 1;
+    QModbusDataUnit::RegisterType Type = QModbusDataUnit::HoldingRegisters;
+    quint16 Address = 0;
+    DataDisplayMode Mode = DataDisplayMode::Decimal;
+};
+
+///
+/// \brief The ReplayFrame struct - values recorded at one timestamp
+///
+struct ReplayFrame
+{
+    qint64 Timestamp = 0;   // milliseconds
+    QVector<double> Values; // NaN where the column has no value in the frame
+};
+
+///
+/// \brief The ReplayParams struct
+///
+struct ReplayParams
+{
+    QString FileName;
+    double Rate = 1.;   // playback speed, 2 replays twice as fast as recorded
+    bool Loop = false;
+    ByteOrder Order = ByteOrder::LittleEndian;
+};
+Q_DECLARE_METATYPE(ReplayParams)
+
+///
+/// \brief operator <<
+/// \param out
+/// \param params
+/// \return
+///
+inline QDataStream& operator <<(QDataStream& out, const ReplayParams& params)
+{
+    out << params.FileName;
+    out << params.Rate;
+    out << params.Loop;
+    out << params.Order;
+    return out;
+}
+
+///
+/// \brief operator >>
+/// \param in
+/// \param params
+/// \return
+///
+inline QDataStream& operator >>(QDataStream& in, ReplayParams& params)
+{
+    in >> params.FileName;
+    in >> params.Rate;
+    in >> params.Loop;
+    in >> params.Order;
+    return in;
+}
+
+///
+/// \brief The ReplayFile class - recorded time series read frame by frame
+///
+/// Two formats are supported, chosen by the file extension:
+///
+/// .csv - the first line names the columns, the first column is the timestamp
+/// in milliseconds or ISO 8601 date and time, every other column is
+/// [device/]table:address[:mode], e.g. hr:100:FloatingPt or 2/coils:0.
+/// Empty cells leave the register unchanged.
+///
+/// binary - "OMSR", quint16 version, quint16 column count, 8 bytes per column
+/// (quint8 device, quint8 register type, quint16 address, quint8 display mode, 3 reserved),
+/// then fixed size records of qint64 timestamp and one double per column, all little-endian.
+/// NaN leaves the register unchanged.
+///
+/// .scn - scenario, one event per line, see ScenarioFile.
+///
+class ReplayFile
+{
+public:
+    virtual ~ReplayFile() = default;
+
+    static ReplayFile* open(const QString& fileName, QString* errorString = nullptr);
+
+    const QVector<ReplayColumn>& columns() const { return _columns; }
+
+    virtual bool readFrame(ReplayFrame& frame) = 0;
+    virtual void rewind() = 0;
+
+protected:
+    QVector<ReplayColumn> _columns;
+};
+
+///
+/// \brief The CsvReplayFile class - streamed line by line
+///
+class CsvReplayFile : public ReplayFile
+{
+public:
+    bool open(const QString& fileName, QString* errorString);
+
+    bool readFrame(ReplayFrame& frame) override;
+    void rewind() override;
+
+private:
+    QFile _file;
+    char _separator = ',';
+    qint64 _dataOffset = 0;
+};
+
+///
+/// \brief The BinaryReplayFile class - memory-mapped through a sliding window
+///
+class BinaryReplayFile : public ReplayFile
+{
+public:
+    ~BinaryReplayFile() override;
+
+    bool open(const QString& fileName, QString* errorString);
+
+    bool readFrame(ReplayFrame& frame) override;
+    void rewind() override;
+
+    static constexpr quint32 Magic = 0x52534D4F; // "OMSR"
+    static constexpr quint16 Version = 1;
+
+private:
+    bool mapWindow(qint64 pos);
+
+private:
+    QFile _file;
+    qint64 _dataOffset = 0;
+    qint64 _recordSize = 0;
+    qint64 _pos = 0;
+
+    uchar* _window = nullptr;
+    qint64 _windowPos = 0;
+    qint64 _windowSize = 0;
+};
+
+///
+/// \brief The ScenarioFile class - scripted events precompiled into a sorted timeline
+///
+/// Every line is an event, # starts a comment:
+///
+/// <time> set <register> <value>
+/// <time> ramp <register> <from> <to> <duration> [<step>]
+///
+/// Time and duration are milliseconds or a number with ms, s, m or h suffix, a leading +
+/// counts from the time of the previous event. Registers are written as the CSV columns,
+/// e.g. 5s set hr:100 42 or +1s ramp hr:101:FloatingPt 0 100 10s 500ms. Ramps are expanded
+/// into one value per step (100 ms by default). Events of the same time make one frame.
+///
+class ScenarioFile : public ReplayFile
+{
+public:
+    bool open(const QString& fileName, QString* errorString);
+
+    bool readFrame(ReplayFrame& frame) override;
+    void rewind() override;
+
+    // the timeline is expanded in memory, ramps of tiny steps must not exhaust it
+    static constexpr int MaxEvents = 1000000;
+
+private:
+    int columnIndex(const ReplayColumn& column);
+
+private:
+    struct ScenarioEvent
+    {
+        qint64 Time;
+        int Column;     // -1 for the start of the timeline
+        double Value;
+    };
+    QVector<ScenarioEvent> _timeline;
+    int _pos = 0;
+};
+
+#endif // REPLAYFILE_H
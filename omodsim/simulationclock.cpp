@@ -0,0 +1,231 @@
+#include <cmath>
+#include <limits>
+#include "simulationclock.h"
+
+///
+/// \brief SimulationClock::instance
+/// \return the clock shared by the whole application
+///
+SimulationClock* SimulationClock::instance()
+{
+    static SimulationClock clock;
+    return &clock;
+}
+
+///
+/// \brief SimulationClock::SimulationClock
+/// \param parent
+///
+SimulationClock::SimulationClock(QObject* parent)
+    : QObject(parent)
+    ,_startTime(QDateTime::currentDateTime())
+{
+    _wallClock.start();
+}
+
+///
+/// \brief SimulationClock::elapsed
+/// \return milliseconds of clock time since the application start
+///
+qint64 SimulationClock::elapsed() const
+{
+    QMutexLocker locker(&_mutex);
+    return _base + qint64((_wallClock.elapsed() - _wallBase) * _rate);
+}
+
+///
+/// \brief SimulationClock::currentDateTime
+/// \return date and time as seen by simulations and scripts
+///
+QDateTime SimulationClock::currentDateTime() const
+{
+    return _startTime.addMSecs(elapsed());
+}
+
+///
+/// \brief SimulationClock::currentMSecsSinceEpoch
+/// \return
+///
+double SimulationClock::currentMSecsSinceEpoch() const
+{
+    return double(_startTime.toMSecsSinceEpoch() + elapsed());
+}
+
+///
+/// \brief SimulationClock::rate
+/// \return
+///
+double SimulationClock::rate() const
+{
+    QMutexLocker locker(&_mutex);
+    return _rate;
+}
+
+///
+/// \brief SimulationClock::setRate
+/// \param rate - speed relative to the wall clock, 0 stops the clock
+///
+void SimulationClock::setRate(double rate)
+{
+    {
+        QMutexLocker locker(&_mutex);
+
+        const auto wall = _wallClock.elapsed();
+        _base += qint64((wall - _wallBase) * _rate);
+        _wallBase = wall;
+        _rate = qMax(0., rate);
+    }
+
+    emit changed();
+}
+
+///
+/// \brief SimulationClock::isRealTime
+/// \return true if the clock has never been sped up, stopped or stepped
+///
+bool SimulationClock::isRealTime() const
+{
+    QMutexLocker locker(&_mutex);
+    return _rate == 1. && _base == _wallBase;
+}
+
+///
+/// \brief SimulationClock::step
+/// \param msecs - clock time to skip
+///
+void SimulationClock::step(qint64 msecs)
+{
+    if(msecs <= 0)
+        return;
+
+    {
+        QMutexLocker locker(&_mutex);
+        _base += msecs;
+    }
+
+    emit changed();
+}
+
+///
+/// \brief SimulationClock::remainingTime
+/// \param due - clock time
+/// \return wall clock milliseconds until the clock reaches due, -1 if the clock is stopped
+///
+qint64 SimulationClock::remainingTime(qint64 due) const
+{
+    QMutexLocker locker(&_mutex);
+
+    const auto wall = _wallClock.elapsed();
+    const auto now = _base + qint64((wall - _wallBase) * _rate);
+    if(due <= now)
+        return 0;
+
+    if(_rate <= 0.)
+        return -1;
+
+    return qint64(std::ceil((due - now) / _rate));
+}
+
+///
+/// \brief SimulationTimer::SimulationTimer
+/// \param parent
+///
+SimulationTimer::SimulationTimer(QObject* parent)
+    : QObject(parent)
+{
+    _wallTimer.setSingleShot(true);
+    _wallTimer.setTimerType(Qt::PreciseTimer);
+    connect(&_wallTimer, &QTimer::timeout, this, &SimulationTimer::on_wallTimeout);
+    connect(SimulationClock::instance(), &SimulationClock::changed, this, &SimulationTimer::on_clockChanged);
+}
+
+///
+/// \brief SimulationTimer::isActive
+/// \return
+///
+bool SimulationTimer::isActive() const
+{
+    return _active;
+}
+
+///
+/// \brief SimulationTimer::isSingleShot
+/// \return
+///
+bool SimulationTimer::isSingleShot() const
+{
+    return _singleShot;
+}
+
+///
+/// \brief SimulationTimer::setSingleShot
+/// \param singleShot
+///
+void SimulationTimer::setSingleShot(bool singleShot)
+{
+    _singleShot = singleShot;
+}
+
+///
+/// \brief SimulationTimer::start
+/// \param msec - clock time interval
+///
+void SimulationTimer::start(int msec)
+{
+    _interval = qMax(0, msec);
+    _due = SimulationClock::instance()->elapsed() + _interval;
+    _active = true;
+
+    on_clockChanged();
+}
+
+///
+/// \brief SimulationTimer::stop
+///
+void SimulationTimer::stop()
+{
+    _active = false;
+    _wallTimer.stop();
+}
+
+///
+/// \brief SimulationTimer::on_clockChanged
+///
+void SimulationTimer::on_clockChanged()
+{
+    if(!_active)
+        return;
+
+    const auto remaining = SimulationClock::instance()->remainingTime(_due);
+    if(remaining < 0)
+        _wallTimer.stop();
+    else
+        _wallTimer.start(int(qMin<qint64>(remaining, std::numeric_limits<int>::max())));
+}
+
+///
+/// \brief SimulationTimer::on_wallTimeout
+///
+void SimulationTimer::on_wallTimeout()
+{
+    if(!_active)
+        return;
+
+    const auto due = _due;
+    if(SimulationClock::instance()->elapsed() >= due)
+    {
+        // every period gets its timeout, periods the clock skipped over follow one per event loop pass
+        if(_singleShot)
+            _active = false;
+        else
+            _due += qMax(1, _interval);
+
+        emit timeout();
+
+        // restarted or stopped by a receiver
+        if(!_active || _due != due + qMax(1, _interval))
+            return;
+    }
+
+    on_clockChanged();
+}
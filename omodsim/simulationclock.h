@@ -0,0 +1,79 @@
+#ifndef SIMULATIONCLOCK_H
+#define SIMULATIONCLOCK_H
+
+#include <QMutex>
+#include <QTimer>
+#include <QDateTime>
+#include <QElapsedTimer>
+
+///
+/// \brief The SimulationClock class - time base of all simulations and scripts
+///
+/// The clock runs at rate times the wall clock speed. Rate 0 stops it, then it only moves
+/// when stepped by hand. Safe to read from any thread.
+///
+class SimulationClock : public QObject
+{
+    Q_OBJECT
+public:
+    static SimulationClock* instance();
+
+    qint64 elapsed() const;
+    QDateTime currentDateTime() const;
+    Q_INVOKABLE double currentMSecsSinceEpoch() const;
+
+    double rate() const;
+    void setRate(double rate);
+    bool isRealTime() const;
+
+    void step(qint64 msecs);
+
+    qint64 remainingTime(qint64 due) const;
+
+signals:
+    void changed();
+
+private:
+    explicit SimulationClock(QObject* parent = nullptr);
+
+private:
+    mutable QMutex _mutex;
+    QElapsedTimer _wallClock;
+    QDateTime _startTime;
+    qint64 _base = 0;       // clock time at _wallBase
+    qint64 _wallBase = 0;
+    double _rate = 1.;
+};
+
+///
+/// \brief The SimulationTimer class - QTimer counterpart that follows the simulation clock
+///
+class SimulationTimer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SimulationTimer(QObject* parent = nullptr);
+
+    bool isActive() const;
+    bool isSingleShot() const;
+    void setSingleShot(bool singleShot);
+
+    void start(int msec);
+    void stop();
+
+signals:
+    void timeout();
+
+private slots:
+    void on_clockChanged();
+    void on_wallTimeout();
+
+private:
+    QTimer _wallTimer;
+    qint64 _due = 0;
+    int _interval = 0;
+    bool _active = false;
+    bool _singleShot = false;
+};
+
+#endif // SIMULATIONCLOCK_H
@@ -0,0 +1,192 @@
+#ifndef SIMULATIONVALUE_H
+#define SIMULATIONVALUE_H
+
+#include <QModbusDataUnit>
+#include "numericutils.h"
+#include "enums.h"
+
+///
+/// \brief The SimulationValue union - simulation state in the native type of its display mode
+///
+union SimulationValue
+{
+    quint16 UInt16;
+    qint16 Int16;
+    quint32 UInt32;
+    qint32 Int32;
+    quint64 UInt64;
+    qint64 Int64;
+    float Float;
+    double Double;
+};
+Q_DECLARE_TYPEINFO(SimulationValue, Q_PRIMITIVE_TYPE);
+
+///
+/// \brief valueSlot
+/// \param value
+/// \return the member of the union that holds values of type T
+///
+template<typename T> T& valueSlot(SimulationValue& value);
+template<> inline quint16& valueSlot<quint16>(SimulationValue& value) { return value.UInt16; }
+template<> inline qint16& valueSlot<qint16>(SimulationValue& value) { return value.Int16; }
+template<> inline quint32& valueSlot<quint32>(SimulationValue& value) { return value.UInt32; }
+template<> inline qint32& valueSlot<qint32>(SimulationValue& value) { return value.Int32; }
+template<> inline quint64& valueSlot<quint64>(SimulationValue& value) { return value.UInt64; }
+template<> inline qint64& valueSlot<qint64>(SimulationValue& value) { return value.Int64; }
+template<> inline float& valueSlot<float>(SimulationValue& value) { return value.Float; }
+template<> inline double& valueSlot<double>(SimulationValue& value) { return value.Double; }
+
+///
+/// \brief visitValueType - calls func with a default value of the type simulated for the display mode
+/// \param type
+/// \param mode
+/// \param func
+///
+template<typename Func>
+inline void visitValueType(QModbusDataUnit::RegisterType type, DataDisplayMode mode, Func&& func)
+{
+    if(type == QModbusDataUnit::Coils || type == QModbusDataUnit::DiscreteInputs)
+    {
+        func(quint16());
+        return;
+    }
+
+    switch(mode)
+    {
+        case DataDisplayMode::Binary:
+        case DataDisplayMode::Decimal:
+        case DataDisplayMode::Hex:
+            func(quint16());
+        break;
+
+        case DataDisplayMode::Integer:
+            func(qint16());
+        break;
+
+        case DataDisplayMode::Int32:
+        case DataDisplayMode::SwappedInt32:
+            func(qint32());
+        break;
+
+        case DataDisplayMode::UInt32:
+        case DataDisplayMode::SwappedUInt32:
+            func(quint32());
+        break;
+
+        case DataDisplayMode::FloatingPt:
+        case DataDisplayMode::SwappedFP:
+            func(float());
+        break;
+
+        case DataDisplayMode::DblFloat:
+        case DataDisplayMode::SwappedDbl:
+            func(double());
+        break;
+
+        case DataDisplayMode::Int64:
+        case DataDisplayMode::SwappedInt64:
+            func(qint64());
+        break;
+
+        case DataDisplayMode::UInt64:
+        case DataDisplayMode::SwappedUInt64:
+            func(quint64());
+        break;
+    }
+}
+
+///
+/// \brief simulationRegisterCount
+/// \param type
+/// \param mode
+/// \return number of registers one simulated value occupies
+///
+inline int simulationRegisterCount(QModbusDataUnit::RegisterType type, DataDisplayMode mode)
+{
+    int count = 1;
+    visitValueType(type, mode, [&count](auto v) { count = qMax<int>(1, sizeof(v) / sizeof(quint16)); });
+    return count;
+}
+
+///
+/// \brief encodeSimulationValue
+/// \param type
+/// \param mode
+/// \param value
+/// \param order
+/// \param words - room for four registers
+/// \return number of registers written
+///
+inline int encodeSimulationValue(QModbusDataUnit::RegisterType type, DataDisplayMode mode, const SimulationValue& value, ByteOrder order, quint16* words)
+{
+    if(type == QModbusDataUnit::Coils || type == QModbusDataUnit::DiscreteInputs)
+    {
+        words[0] = value.UInt16 ? 1 : 0;
+        return 1;
+    }
+
+    switch(mode)
+    {
+        case DataDisplayMode::Binary:
+        case DataDisplayMode::Decimal:
+        case DataDisplayMode::Hex:
+            words[0] = toByteOrderValue(value.UInt16, order);
+        return 1;
+
+        case DataDisplayMode::Integer:
+            words[0] = toByteOrderValue(quint16(value.Int16), order);
+        return 1;
+
+        case DataDisplayMode::Int32:
+            breakInt32(value.Int32, words[0], words[1], order);
+        return 2;
+
+        case DataDisplayMode::SwappedInt32:
+            breakInt32(value.Int32, words[1], words[0], order);
+        return 2;
+
+        case DataDisplayMode::UInt32:
+            breakUInt32(value.UInt32, words[0], words[1], order);
+        return 2;
+
+        case DataDisplayMode::SwappedUInt32:
+            breakUInt32(value.UInt32, words[1], words[0], order);
+        return 2;
+
+        case DataDisplayMode::FloatingPt:
+            breakFloat(value.Float, words[0], words[1], order);
+        return 2;
+
+        case DataDisplayMode::SwappedFP:
+            breakFloat(value.Float, words[1], words[0], order);
+        return 2;
+
+        case DataDisplayMode::DblFloat:
+            breakDouble(value.Double, words[0], words[1], words[2], words[3], order);
+        return 4;
+
+        case DataDisplayMode::SwappedDbl:
+            breakDouble(value.Double, words[3], words[2], words[1], words[0], order);
+        return 4;
+
+        case DataDisplayMode::Int64:
+            breakInt64(value.Int64, words[0], words[1], words[2], words[3], order);
+        return 4;
+
+        case DataDisplayMode::SwappedInt64:
+            breakInt64(value.Int64, words[3], words[2], words[1], words[0], order);
+        return 4;
+
+        case DataDisplayMode::UInt64:
+            breakUInt64(value.UInt64, words[0], words[1], words[2], words[3], order);
+        return 4;
+
+        case DataDisplayMode::SwappedUInt64:
+            breakUInt64(value.UInt64, words[3], words[2], words[1], words[0], order);
+        return 4;
+    }
+
+    return 0;
+}
+
+#endif // SIMULATIONVALUE_H
@@ -0,0 +1,97 @@
+#ifndef TRAFFICUTILS_H
+#define TRAFFICUTILS_H
+
+#include <QVector>
+#include <QString>
+#include <QtEndian>
+#include <QModbusPdu>
+
+///
+/// \brief startAddress
+/// \param pdu - request function code and data
+/// \param size
+/// \return first address the request refers to, -1 if the function has none
+///
+inline int startAddress(const uchar* pdu, int size)
+{
+    if(size < 3)
+        return -1;
+
+    switch(pdu[0])
+    {
+        case QModbusPdu::ReadCoils:
+        case QModbusPdu::ReadDiscreteInputs:
+        case QModbusPdu::ReadHoldingRegisters:
+        case QModbusPdu::ReadInputRegisters:
+        case QModbusPdu::WriteSingleCoil:
+        case QModbusPdu::WriteSingleRegister:
+        case QModbusPdu::WriteMultipleCoils:
+        case QModbusPdu::WriteMultipleRegisters:
+        case QModbusPdu::MaskWriteRegister:
+        case QModbusPdu::ReadWriteMultipleRegisters:
+        case QModbusPdu::ReadFifoQueue:
+            return qFromBigEndian<quint16>(pdu + 1);
+
+        default:
+            return -1;
+    }
+}
+
+///
+/// \brief parseNumbers
+/// \param text - comma separated numbers and ranges, e.g. 5,6,15-16 or 0x10
+/// \param ok
+/// \return
+///
+inline QVector<int> parseNumbers(const QString& text, bool* ok = nullptr)
+{
+    QVector<int> numbers;
+    if(ok) *ok = true;
+
+    for(auto&& part : text.split(',', Qt::SkipEmptyParts))
+    {
+        const auto range = part.trimmed().split('-');
+
+        bool okFirst = false, okLast = false;
+        const int first = range.first().trimmed().toInt(&okFirst, 0);
+        const int last = (range.size() == 2) ? range.last().trimmed().toInt(&okLast, 0) : first;
+        if(range.size() == 1) okLast = okFirst;
+
+        if(!okFirst || !okLast || range.size() > 2 || first > last || last - first > 0xFFFF)
+        {
+            if(ok) *ok = false;
+            return QVector<int>();
+        }
+
+        for(int n = first; n <= last; n++)
+            numbers.push_back(n);
+    }
+
+    return numbers;
+}
+
+///
+/// \brief parseRange
+/// \param text - a number or a range, e.g. 4000-4100, empty text is no range
+/// \param first - -1 if the text is empty
+/// \param last - -1 if the text is empty
+/// \return
+///
+inline bool parseRange(const QString& text, int* first, int* last)
+{
+    *first = *last = -1;
+    if(text.trimmed().isEmpty())
+        return true;
+
+    const auto range = text.split('-');
+    if(range.size() > 2)
+        return false;
+
+    bool okFirst, okLast;
+    *first = range.first().trimmed().toInt(&okFirst, 0);
+    *last = range.last().trimmed().toInt(&okLast, 0);
+
+    return okFirst && okLast && *first >= 0 && *first <= *last;
+}
+
+#endif // TRAFFICUTILS_H
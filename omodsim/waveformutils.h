@@ -0,0 +1,150 @@
+#ifndef WAVEFORMUTILS_H
+#define WAVEFORMUTILS_H
+
+#include <cmath>
+#include <algorithm>
+#include "modbussimulationparams.h"
+#include "fastrandomgenerator.h"
+
+// the kernels below work on plain arrays without branches in the loop bodies,
+// so the compiler can vectorize them for thousands of points per tick
+
+///
+/// \brief waveformPhases
+/// \param phases - output, fraction of the period for every point in [0, 1)
+/// \param count
+/// \param time - time of the first point in milliseconds
+/// \param timeStep - time each point is ahead of the previous one in milliseconds
+/// \param params
+///
+inline void waveformPhases(double* phases, int count, double time, double timeStep, const WaveformSimulationParams& params)
+{
+    const double period = (params.Period > 0.) ? params.Period : 1.;
+    const double start = time / period + params.Phase / 360.;
+    const double step = timeStep / period;
+
+    for(int i = 0; i < count; i++)
+    {
+        const double p = start + i * step;
+        phases[i] = p - std::floor(p);
+    }
+}
+
+///
+/// \brief sineWave
+/// \param samples
+/// \param phases
+/// \param count
+///
+inline void sineWave(double* samples, const double* phases, int count)
+{
+    constexpr double twoPi = 6.283185307179586;
+    for(int i = 0; i < count; i++)
+        samples[i] = std::sin(twoPi * phases[i]);
+}
+
+///
+/// \brief squareWave
+/// \param samples
+/// \param phases
+/// \param count
+///
+inline void squareWave(double* samples, const double* phases, int count)
+{
+    for(int i = 0; i < count; i++)
+        samples[i] = (phases[i] < 0.5) ? 1. : -1.;
+}
+
+///
+/// \brief triangleWave - starts at zero and rises, like the sine
+/// \param samples
+/// \param phases
+/// \param count
+///
+inline void triangleWave(double* samples, const double* phases, int count)
+{
+    for(int i = 0; i < count; i++)
+    {
+        const double q = phases[i] + 0.25;
+        samples[i] = 1. - 4. * std::abs(q - std::floor(q) - 0.5);
+    }
+}
+
+///
+/// \brief sawtoothWave - starts at zero, rises to the top and falls to the bottom at half period
+/// \param samples
+/// \param phases
+/// \param count
+///
+inline void sawtoothWave(double* samples, const double* phases, int count)
+{
+    for(int i = 0; i < count; i++)
+    {
+        const double q = phases[i] + 0.5;
+        samples[i] = 2. * (q - std::floor(q)) - 1.;
+    }
+}
+
+///
+/// \brief exponentialWave - decays from one with a time constant of a fifth of the period and restarts every period
+/// \param samples
+/// \param phases
+/// \param count
+///
+inline void exponentialWave(double* samples, const double* phases, int count)
+{
+    for(int i = 0; i < count; i++)
+        samples[i] = std::exp(-5. * phases[i]);
+}
+
+///
+/// \brief generateWaveform
+/// \param mode
+/// \param params
+/// \param generator - noise source
+/// \param samples - output, must not alias phases
+/// \param phases
+/// \param count
+///
+inline void generateWaveform(SimulationMode mode, const WaveformSimulationParams& params, FastRandomGenerator& generator, double* samples, const double* phases, int count)
+{
+    switch(mode)
+    {
+        case SimulationMode::Sine:
+            sineWave(samples, phases, count);
+        break;
+
+        case SimulationMode::Square:
+            squareWave(samples, phases, count);
+        break;
+
+        case SimulationMode::Triangle:
+            triangleWave(samples, phases, count);
+        break;
+
+        case SimulationMode::Sawtooth:
+            sawtoothWave(samples, phases, count);
+        break;
+
+        case SimulationMode::Exponential:
+            exponentialWave(samples, phases, count);
+        break;
+
+        default:
+            std::fill(samples, samples + count, 0.);
+        break;
+    }
+
+    const double amplitude = params.Amplitude;
+    const double offset = params.Offset;
+    for(int i = 0; i < count; i++)
+        samples[i] = offset + amplitude * samples[i];
+
+    if(params.Noise > 0.)
+    {
+        for(int i = 0; i < count; i++)
+            samples[i] += params.Noise * (2. * generator.generateDouble() - 1.);
+    }
+}
+
+#endif // WAVEFORMUTILS_H